@@ -24,6 +24,7 @@
 #include "Color.h"
 #include "uiListPalette.h"
 #include "ColorList.h"
+#include "TextColors.h"
 #include "dynv/Map.h"
 #include <gtk/gtk.h>
 #include <sstream>
@@ -61,20 +62,11 @@ static void setData(GtkClipboard *, GtkSelectionData *selectionData, Target targ
 	case Target::string: {
 		std::stringstream text;
 		std::string textLine;
-		ConverterSerializePosition position(args->colors.size());
-		if (position.count() > 0) {
-			for (auto *color: args->colors) {
-				if (position.index() + 1 == position.count())
-					position.last(true);
-				textLine = args->converter->serialize(*color, position);
-				if (position.first()) {
-					text << textLine;
-					position.first(false);
-				} else {
-					text << "\n" << textLine;
-				}
-				position.incrementIndex();
-			}
+		auto lines = args->converter->serialize(std::vector<const ColorObject *>(args->colors.begin(), args->colors.end()));
+		for (size_t i = 0; i < lines.size(); i++) {
+			if (i != 0)
+				text << "\n";
+			text << lines[i];
 		}
 		textLine = text.str();
 		if (textLine.length() > 0)
@@ -325,11 +317,11 @@ bool colorObjectAvailable() {
 		switch (target) {
 		case Target::string: {
 			auto data = gtk_selection_data_get_data(selectionData);
-			auto text = std::string(reinterpret_cast<const char *>(data), reinterpret_cast<const char *>(data) + gtk_selection_data_get_length(selectionData));
-			ColorObject colorObject;
-			//TODO: multiple colors should be extracted from string, but converters do not support this right now
-			if (gs.converters().deserialize(text.c_str(), colorObject)) {
-				colorList->add(colorObject);
+			gint length = gtk_selection_data_get_length(selectionData);
+			auto colorObjects = extractColors(std::string_view(reinterpret_cast<const char *>(data), length > 0 ? length : 0), gs.converters());
+			if (!colorObjects.empty()) {
+				for (const auto &colorObject: colorObjects)
+					colorList->add(colorObject);
 				success = true;
 				return VisitResult::stop;
 			}
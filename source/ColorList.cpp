@@ -26,7 +26,9 @@ struct NullPalette: public IPalette {
 	}
 	virtual void add(ColorList &colorList, ColorObject *colorObject) override {
 	}
-	virtual void remove(ColorList &colorList, ColorObject *colorObject) override {
+	virtual void add(ColorList &colorList, const std::vector<ColorObject *> &colorObjects) override {
+	}
+	virtual void remove(ColorList &colorList, const std::vector<ColorObject *> &colorObjects) override {
 	}
 	virtual void removeSelected(ColorList &colorList) override {
 	}
@@ -77,6 +79,16 @@ void ColorList::add(ColorObject *colorObject, size_t position, bool updatePalett
 		m_palette.add(*this, colorObject);
 	m_changed = true;
 }
+void ColorList::add(const std::vector<ColorObject *> &colorObjects, size_t position, bool updatePalette) {
+	if (colorObjects.empty())
+		return;
+	m_colors.insert(m_colors.begin() + position, colorObjects.begin(), colorObjects.end());
+	for (auto *colorObject: colorObjects)
+		colorObject->reference();
+	if (updatePalette)
+		m_palette.add(*this, colorObjects);
+	m_changed = true;
+}
 void ColorList::add(const ColorObject &colorObject) {
 	auto *copy = colorObject.copy().unwrap();
 	m_colors.push_back(copy);
@@ -85,11 +97,8 @@ void ColorList::add(const ColorObject &colorObject) {
 }
 void ColorList::add(ColorList &colorList) {
 	auto guard = changeGuard();
-	for (auto *colorObject: colorList) {
-		m_colors.push_back(colorObject->reference());
-		m_palette.add(*this, colorObject);
-		m_changed = true;
-	}
+	std::vector<ColorObject *> colorObjects(colorList.begin(), colorList.end());
+	add(colorObjects, m_colors.size(), true);
 }
 bool ColorList::startChanges() {
 	if (m_blocked)
@@ -166,6 +175,6 @@ void ColorList::releaseItem(ColorObject *colorObject) {
 void ColorList::paletteRemoveSelected() {
 	m_palette.removeSelected(*this);
 }
-void ColorList::paletteRemove(ColorObject *colorObject) {
-	m_palette.remove(*this, colorObject);
+void ColorList::paletteRemove(const std::vector<ColorObject *> &colorObjects) {
+	m_palette.remove(*this, colorObjects);
 }
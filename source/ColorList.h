@@ -38,22 +38,27 @@ struct ColorList: public common::Ref<ColorList>::Counter {
 	void add(const ColorObject &colorObject);
 	void add(ColorObject *colorObject);
 	void add(ColorObject *colorObject, size_t position, bool updatePalette = false);
+	void add(const std::vector<ColorObject *> &colorObjects, size_t position, bool updatePalette = false);
 	void add(ColorList &colorList);
 	template<typename Callback>
 	void remove(Callback &&callback, bool selected, bool updatePalette) {
-		auto i = m_colors.begin();
-		while (i != m_colors.end()) {
-			if (callback(*i)) {
-				if (updatePalette && !selected) {
-					paletteRemove(*i);
-				}
-				releaseItem(*i);
-				i = m_colors.erase(i);
-			} else
-				++i;
+		std::vector<ColorObject *> removed;
+		auto output = m_colors.begin();
+		for (auto i = m_colors.begin(); i != m_colors.end(); ++i) {
+			if (callback(*i))
+				removed.push_back(*i);
+			else
+				*output++ = *i;
 		}
-		if (updatePalette && selected)
-			paletteRemoveSelected();
+		m_colors.erase(output, m_colors.end());
+		if (updatePalette) {
+			if (selected)
+				paletteRemoveSelected();
+			else if (!removed.empty())
+				paletteRemove(removed);
+		}
+		for (auto *colorObject: removed)
+			releaseItem(colorObject);
 		m_changed = true;
 	}
 	void removeAll();
@@ -82,5 +87,5 @@ private:
 	static void onEndChanges(ColorList *colorList);
 	void releaseItem(ColorObject *colorObject);
 	void paletteRemoveSelected();
-	void paletteRemove(ColorObject *colorObject);
+	void paletteRemove(const std::vector<ColorObject *> &colorObjects);
 };
@@ -42,8 +42,11 @@
 #include "color_names/ColorNames.h"
 #include "ScreenReader.h"
 #include "Sampler.h"
+#include "PickerThread.h"
+#include "PickerScheduler.h"
 #include "EventBus.h"
 #include "common/Guard.h"
+#include "common/Format.h"
 #include <gdk/gdkkeysyms.h>
 #include <sstream>
 #include <iostream>
@@ -79,7 +82,18 @@ struct ColorPickerArgs: public IColorPicker, public IEventHandler {
 	GtkWidget *pickButton;
 	GtkWidget *colorWidget;
 	GtkWidget *colorInput;
-	guint timeoutSourceId;
+	GtkWidget *statisticsLabel;
+	std::unique_ptr<PickerScheduler> scheduler;
+	gint64 statisticsUpdateTime;
+	bool zoomedEnabled;
+	int refreshRate, maxStaleness;
+	GdkScreen *monitorsScreen;
+	gulong monitorsChangedHandler;
+	std::vector<math::Rectangle<int>> monitors;
+	Color mainColor;
+	bool mainColorValid;
+	std::unique_ptr<PickerThread> pickerThread;
+	bool pickerThreadStarted;
 	FloatingPicker floatingPicker;
 	dynv::Ref options, mainOptions;
 	GlobalState &gs;
@@ -94,13 +108,23 @@ struct ColorPickerArgs: public IColorPicker, public IEventHandler {
 		statusBar = gs.getStatusBar();
 		floatingPicker = nullptr;
 		ignoreCallback = false;
-		timeoutSourceId = 0;
+		statisticsUpdateTime = 0;
+		zoomedEnabled = options->getBool("zoomed_enabled", true);
+		monitorsScreen = nullptr;
+		monitorsChangedHandler = 0;
+		mainColorValid = false;
+		pickerThreadStarted = false;
+		loadSettings();
 		gs.eventBus().subscribe(EventType::optionsUpdate, *this);
 		gs.eventBus().subscribe(EventType::convertersUpdate, *this);
 		gs.eventBus().subscribe(EventType::displayFiltersUpdate, *this);
 		gs.eventBus().subscribe(EventType::colorDictionaryUpdate, *this);
 	}
 	virtual ~ColorPickerArgs() {
+		scheduler.reset();
+		pickerThread.reset();
+		if (monitorsScreen)
+			g_signal_handler_disconnect(monitorsScreen, monitorsChangedHandler);
 		options->set("swatch.active_color", gtk_swatch_get_active_index(GTK_SWATCH(swatch_display)));
 		Color c;
 		char tmp[32];
@@ -111,6 +135,7 @@ struct ColorPickerArgs: public IColorPicker, public IEventHandler {
 		}
 		options->set("sampler.oversample", sampler_get_oversample(gs.getSampler()));
 		options->set("sampler.falloff", static_cast<int>(sampler_get_falloff(gs.getSampler())));
+		options->set("sampler.linear_light", sampler_get_linear_light(gs.getSampler()));
 		options->set<int32_t>("zoom", static_cast<int32_t>(gtk_zoomed_get_zoom(GTK_ZOOMED(zoomed_display))));
 		options->set("zoom_size", gtk_zoomed_get_size(GTK_ZOOMED(zoomed_display)));
 		options->set<bool>("expander.settings", gtk_expander_get_expanded(GTK_EXPANDER(expanderSettings)));
@@ -132,79 +157,178 @@ struct ColorPickerArgs: public IColorPicker, public IEventHandler {
 		return "color_picker";
 	}
 	virtual void activate() override {
-		if (timeoutSourceId > 0) {
-			g_source_remove(timeoutSourceId);
-			timeoutSourceId = 0;
+		if (zoomedEnabled)
+			startUpdates();
+		gtk_statusbar_push(GTK_STATUSBAR(statusBar), gtk_statusbar_get_context_id(GTK_STATUSBAR(statusBar), "focus_swatch"), _("Click on swatch area to begin adding colors to palette"));
+	}
+	void startUpdates() {
+		if (!scheduler)
+			scheduler = std::make_unique<PickerScheduler>(zoomed_display, [this]() {
+				return scheduledUpdate();
+			});
+		screen_reader_set_max_staleness(gs.getScreenReader(), maxStaleness);
+		scheduler->start(refreshRate);
+		mainColorValid = false;
+		if (!pickerThreadStarted) {
+			// Thread and its display connection are kept until picker is destroyed, inactive thread only waits for requests.
+			pickerThread = PickerThread::start(gdk_screen_get_default(), pickerThreadSettings());
+			pickerThreadStarted = true;
+		}
+		if (pickerThread)
+			pickerThread->request(true);
+	}
+	void loadSettings() {
+		refreshRate = mainOptions->getInt32("refresh_rate", 30);
+		maxStaleness = mainOptions->getInt32("max_staleness", 500);
+	}
+	void stopUpdates() {
+		if (scheduler)
+			scheduler->stop();
+	}
+	bool scheduledUpdate() {
+		bool changed;
+		if (pickerThread && !pickerThread->failed()) {
+			changed = pickerThread->consume();
+			if (changed)
+				updateMainColor(pickerThread->frame());
+			pickerThread->request();
+		} else {
+			changed = updateMainColor(true);
 		}
-		if (options->getBool("zoomed_enabled", true)){
-			auto refresh_rate = mainOptions->getInt32("refresh_rate", 30);
-			timeoutSourceId = g_timeout_add_full(G_PRIORITY_DEFAULT_IDLE, static_cast<int>(1000 / refresh_rate), (GSourceFunc)updateMainColorTimer, this, (GDestroyNotify)nullptr);
+		gint64 now = g_get_monotonic_time();
+		if (now - statisticsUpdateTime >= 1000000) {
+			statisticsUpdateTime = now;
+			updateStatistics();
 		}
-		gtk_statusbar_push(GTK_STATUSBAR(statusBar), gtk_statusbar_get_context_id(GTK_STATUSBAR(statusBar), "focus_swatch"), _("Click on swatch area to begin adding colors to palette"));
+		return changed;
 	}
-	static gboolean updateMainColorTimer(ColorPickerArgs *args) {
-		args->updateMainColor();
-		return true;
+	void updateStatistics() {
+		const auto &statistics = scheduler->statistics();
+		auto toString = [](float value, int precision) {
+			std::stringstream ss;
+			ss << std::fixed << std::setprecision(precision) << value;
+			return ss.str();
+		};
+		auto text = common::format(_("{} FPS, capture {} ms, sampling {} ms, display {} ms"), toString(statistics.framesPerSecond, 1), toString(statistics.captureTime, 2), toString(statistics.sampleTime, 2), toString(statistics.displayTime, 2));
+		gtk_label_set_text(GTK_LABEL(statisticsLabel), text.c_str());
+	}
+	PickerThread::Settings pickerThreadSettings() {
+		PickerThread::Settings settings;
+		settings.oversample = sampler_get_oversample(gs.getSampler());
+		settings.falloff = sampler_get_falloff(gs.getSampler());
+		settings.linearLight = sampler_get_linear_light(gs.getSampler());
+		settings.zoomedAreaSize = gtk_zoomed_get_area_size(GTK_ZOOMED(zoomed_display));
+		settings.maxStaleness = maxStaleness;
+		return settings;
+	}
+	void configurePickerThread() {
+		if (pickerThread)
+			pickerThread->configure(pickerThreadSettings());
 	}
 	static void onZoomedActivate(GtkWidget *widget, ColorPickerArgs *args) {
-		if (args->options->getBool("zoomed_enabled", true)){
+		if (args->zoomedEnabled){
 			gtk_zoomed_set_fade(GTK_ZOOMED(args->zoomed_display), true);
+			args->zoomedEnabled = false;
 			args->options->set("zoomed_enabled", false);
-			if (args->timeoutSourceId > 0){
-				g_source_remove(args->timeoutSourceId);
-				args->timeoutSourceId = 0;
-			}
+			args->stopUpdates();
 		}else{
 			gtk_zoomed_set_fade(GTK_ZOOMED(args->zoomed_display), false);
+			args->zoomedEnabled = true;
 			args->options->set("zoomed_enabled", true);
-			if (args->timeoutSourceId > 0){
-				g_source_remove(args->timeoutSourceId);
-				args->timeoutSourceId = 0;
-			}
-			auto refresh_rate = args->mainOptions->getInt32("refresh_rate", 30);
-			args->timeoutSourceId = g_timeout_add_full(G_PRIORITY_DEFAULT_IDLE, static_cast<int>(1000 / refresh_rate), (GSourceFunc)updateMainColorTimer, args, (GDestroyNotify)nullptr);
+			args->startUpdates();
 		}
 		return;
 	}
-	void updateMainColor() {
+	bool updateMainColor(bool onlyIfChanged = false) {
+		gint64 startTime = g_get_monotonic_time();
 		GdkScreen *screen;
 		GdkModifierType state;
 		int x, y;
 		gdk_display_get_pointer(gdk_display_get_default(), &screen, &x, &y, &state);
-		int monitor = gdk_screen_get_monitor_at_point(screen, x, y);
-		GdkRectangle monitor_geometry;
-		gdk_screen_get_monitor_geometry(screen, monitor, &monitor_geometry);
 		math::Vector2i pointer(x,y);
-		math::Rectangle<int> screen_rect(monitor_geometry.x, monitor_geometry.y, monitor_geometry.x + monitor_geometry.width, monitor_geometry.y + monitor_geometry.height);
+		math::Rectangle<int> screen_rect = monitorAt(screen, x, y);
 		auto screen_reader = gs.getScreenReader();
 		screen_reader_reset_rect(screen_reader);
 		math::Rectangle<int> sampler_rect, zoomed_rect, final_rect;
 		sampler_get_screen_rect(gs.getSampler(), pointer, screen_rect, &sampler_rect);
 		screen_reader_add_rect(screen_reader, screen, sampler_rect);
-		bool zoomed_enabled = options->getBool("zoomed_enabled", true);
-		if (zoomed_enabled){
+		if (zoomedEnabled){
 			gtk_zoomed_get_screen_rect(GTK_ZOOMED(zoomed_display), pointer, screen_rect, &zoomed_rect);
 			screen_reader_add_rect(screen_reader, screen, zoomed_rect);
 		}
-		screen_reader_update_surface(screen_reader, &final_rect);
+		if (!onlyIfChanged)
+			screen_reader_invalidate(screen_reader);
+		if (!screen_reader_update_surface(screen_reader, pointer, &final_rect) && onlyIfChanged)
+			return false;
+		gint64 captureTime = g_get_monotonic_time();
 		math::Vector2i offset;
 		offset = sampler_rect.position() - final_rect.position();
 		Color c;
 		sampler_get_color_sample(gs.getSampler(), pointer, screen_rect, offset, &c);
-		std::string text = gs.converters().serialize(c, Converters::Type::display);
-		gtk_color_set_color(GTK_COLOR(colorCode), &c, text.c_str());
-		gtk_swatch_set_main_color(GTK_SWATCH(swatch_display), &c);
-		if (zoomed_enabled){
+		gint64 sampleTime = g_get_monotonic_time();
+		setMainColor(c);
+		if (zoomedEnabled){
 			offset = final_rect.position() - zoomed_rect.position();
 			gtk_zoomed_update(GTK_ZOOMED(zoomed_display), pointer, screen_rect, offset, screen_reader_get_surface(screen_reader));
 		}
+		if (scheduler)
+			scheduler->addStageTimes(captureTime - startTime, sampleTime - captureTime, g_get_monotonic_time() - sampleTime);
+		return true;
+	}
+	void updateMainColor(const PickerFrame &frame) {
+		gint64 startTime = g_get_monotonic_time();
+		setMainColor(frame.color);
+		if (!frame.zoomedRect.isEmpty()) {
+			math::Vector2i pointer = frame.pointer;
+			math::Rectangle<int> screen_rect = frame.screenRect;
+			math::Vector2i offset = frame.captureRect.position() - frame.zoomedRect.position();
+			cairo_surface_t *surface = frame.createSurface();
+			gtk_zoomed_update(GTK_ZOOMED(zoomed_display), pointer, screen_rect, offset, surface);
+			cairo_surface_destroy(surface);
+		}
+		if (scheduler)
+			scheduler->addStageTimes(frame.captureTime, frame.sampleTime, g_get_monotonic_time() - startTime);
+	}
+	/**
+	 * Set main color, skipping conversion and widget updates when color did not change since last call.
+	 */
+	void setMainColor(const Color &color) {
+		if (mainColorValid && mainColor == color)
+			return;
+		mainColor = color;
+		mainColorValid = true;
+		std::string text = gs.converters().serialize(mainColor, Converters::Type::display);
+		gtk_color_set_color(GTK_COLOR(colorCode), &mainColor, text.c_str());
+		gtk_swatch_set_main_color(GTK_SWATCH(swatch_display), &mainColor);
+	}
+	const math::Rectangle<int> &monitorAt(GdkScreen *screen, int x, int y) {
+		if (screen != monitorsScreen) {
+			if (monitorsScreen)
+				g_signal_handler_disconnect(monitorsScreen, monitorsChangedHandler);
+			monitorsScreen = screen;
+			monitorsChangedHandler = g_signal_connect(G_OBJECT(screen), "monitors-changed", G_CALLBACK(onMonitorsChanged), this);
+			monitors.clear();
+		}
+		if (monitors.empty()) {
+			int count = gdk_screen_get_n_monitors(screen);
+			for (int i = 0; i < count; i++) {
+				GdkRectangle geometry;
+				gdk_screen_get_monitor_geometry(screen, i, &geometry);
+				monitors.emplace_back(geometry.x, geometry.y, geometry.x + geometry.width, geometry.y + geometry.height);
+			}
+		}
+		for (const auto &monitor: monitors) {
+			if (monitor.isInside(x, y))
+				return monitor;
+		}
+		return monitors[gdk_screen_get_monitor_at_point(screen, x, y)];
+	}
+	static void onMonitorsChanged(GdkScreen *screen, ColorPickerArgs *args) {
+		args->monitors.clear();
 	}
 	virtual void deactivate() override {
 		gtk_statusbar_pop(GTK_STATUSBAR(statusBar), gtk_statusbar_get_context_id(GTK_STATUSBAR(statusBar), "focus_swatch"));
-		if (timeoutSourceId > 0) {
-			g_source_remove(timeoutSourceId);
-			timeoutSourceId = 0;
-		}
+		stopUpdates();
 	}
 	virtual GtkWidget *getWidget() override {
 		return main;
@@ -247,6 +371,7 @@ struct ColorPickerArgs: public IColorPicker, public IEventHandler {
 		updateComponentText(GTK_COLOR_COMPONENT(lchControl));
 
 		gtk_zoomed_set_size(GTK_ZOOMED(zoomed_display), options->getInt32("zoom_size", 150));
+		configurePickerThread();
 	}
 	void updateColorWidget() {
 		ColorObject colorObject;
@@ -262,7 +387,17 @@ struct ColorPickerArgs: public IColorPicker, public IEventHandler {
 	virtual void onEvent(EventType eventType) override {
 		switch (eventType) {
 		case EventType::optionsUpdate:
+			mainColorValid = false;
+			loadSettings();
+			if (scheduler && scheduler->running()) {
+				screen_reader_set_max_staleness(gs.getScreenReader(), maxStaleness);
+				scheduler->start(refreshRate);
+			}
+			setOptions();
+			updateColorWidget();
+			break;
 		case EventType::convertersUpdate:
+			mainColorValid = false;
 			setOptions();
 			updateColorWidget();
 			break;
@@ -364,12 +499,10 @@ struct ColorPickerArgs: public IColorPicker, public IEventHandler {
 		updateDisplays(nullptr);
 	}
 	void updateMainColorNow() {
-		if (!options->getBool("zoomed_enabled", true)){
+		if (!zoomedEnabled){
 			Color c;
 			gtk_swatch_get_active_color(GTK_SWATCH(swatch_display), &c);
-			std::string text = gs.converters().serialize(c, Converters::Type::display);
-			gtk_color_set_color(GTK_COLOR(colorCode), &c, text.c_str());
-			gtk_swatch_set_main_color(GTK_SWATCH(swatch_display), &c);
+			setMainColor(c);
 		}
 	}
 	void updateComponentText(GtkColorComponent *colorComponent) {
@@ -685,11 +818,14 @@ static gboolean onSwatchKeyPress(GtkWidget *widget, GdkEventKey *event, ColorPic
 static void on_oversample_value_changed(GtkRange *slider, gpointer data){
 	ColorPickerArgs* args=(ColorPickerArgs*)data;
 	sampler_set_oversample(args->gs.getSampler(), (int)gtk_range_get_value(GTK_RANGE(slider)));
+	args->configurePickerThread();
 }
 
 static void on_zoom_value_changed(GtkRange *slider, gpointer data){
 	ColorPickerArgs* args=(ColorPickerArgs*)data;
 	gtk_zoomed_set_zoom(GTK_ZOOMED(args->zoomed_display), static_cast<float>(gtk_range_get_value(GTK_RANGE(slider))));
+	screen_reader_invalidate(args->gs.getScreenReader());
+	args->configurePickerThread();
 }
 
 static void color_component_change_value(GtkWidget *widget, Color* c, ColorPickerArgs* args){
@@ -816,10 +952,19 @@ static void on_oversample_falloff_changed(GtkWidget *widget, gpointer data) {
 
 		ColorPickerArgs* args = (ColorPickerArgs*)data;
 		sampler_set_falloff(args->gs.getSampler(), (SamplerFalloff) falloff_id);
+		screen_reader_invalidate(args->gs.getScreenReader());
+		args->configurePickerThread();
 
 	}
 }
 
+static void on_linear_light_toggled(GtkWidget *widget, gpointer data) {
+	ColorPickerArgs* args = (ColorPickerArgs*)data;
+	sampler_set_linear_light(args->gs.getSampler(), gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(widget)));
+	screen_reader_invalidate(args->gs.getScreenReader());
+	args->configurePickerThread();
+}
+
 static GtkWidget* create_falloff_type_list()
 {
 	GtkListStore *store = gtk_list_store_new(3, GDK_TYPE_PIXBUF, G_TYPE_STRING, G_TYPE_INT);
@@ -934,13 +1079,13 @@ static std::unique_ptr<IColorSource> build(GlobalState &gs, const dynv::Ref &opt
 			args->expanderSettings=expander;
 			gtk_box_pack_start (GTK_BOX(vbox), expander, FALSE, FALSE, 0);
 
-			table = gtk_table_new(6, 2, FALSE);
+			table = gtk_table_new(7, 2, FALSE);
 			table_y=0;
 
 			gtk_container_add(GTK_CONTAINER(expander), table);
 
 				gtk_table_attach(GTK_TABLE(table), gtk_label_aligned_new(_("Oversample:"),0,0.5,0,0),0,1,table_y,table_y+1,GtkAttachOptions(GTK_FILL),GTK_FILL,5,5);
-				widget = gtk_hscale_new_with_range (0,16,1);
+				widget = gtk_hscale_new_with_range (0,sampler_max_oversample,1);
 				g_signal_connect (G_OBJECT (widget), "value-changed", G_CALLBACK (on_oversample_value_changed), args.get());
 				gtk_range_set_value(GTK_RANGE(widget), options->getInt32("sampler.oversample", 0));
 				gtk_table_attach(GTK_TABLE(table), widget,1,2,table_y,table_y+1,GtkAttachOptions(GTK_FILL | GTK_EXPAND),GTK_FILL,5,0);
@@ -953,6 +1098,13 @@ static std::unique_ptr<IColorSource> build(GlobalState &gs, const dynv::Ref &opt
 				gtk_table_attach(GTK_TABLE(table), widget,1,2,table_y,table_y+1,GtkAttachOptions(GTK_FILL | GTK_EXPAND),GTK_FILL,5,0);
 				table_y++;
 
+				widget = gtk_check_button_new_with_mnemonic(_("_Linear light averaging"));
+				g_signal_connect(G_OBJECT(widget), "toggled", G_CALLBACK(on_linear_light_toggled), args.get());
+				gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(widget), options->getBool("sampler.linear_light", false));
+				sampler_set_linear_light(args->gs.getSampler(), options->getBool("sampler.linear_light", false));
+				gtk_table_attach(GTK_TABLE(table), widget,1,2,table_y,table_y+1,GtkAttachOptions(GTK_FILL | GTK_EXPAND),GTK_FILL,5,0);
+				table_y++;
+
 				gtk_table_attach(GTK_TABLE(table), gtk_label_aligned_new(_("Zoom:"),0,0.5,0,0),0,1,table_y,table_y+1,GtkAttachOptions(GTK_FILL),GTK_FILL,5,5);
 				widget = gtk_hscale_new_with_range (0, 100, 1);
 				g_signal_connect (G_OBJECT (widget), "value-changed", G_CALLBACK (on_zoom_value_changed), args.get());
@@ -960,6 +1112,11 @@ static std::unique_ptr<IColorSource> build(GlobalState &gs, const dynv::Ref &opt
 				gtk_table_attach(GTK_TABLE(table), widget,1,2,table_y,table_y+1,GtkAttachOptions(GTK_FILL | GTK_EXPAND),GTK_FILL,5,0);
 				table_y++;
 
+				gtk_table_attach(GTK_TABLE(table), gtk_label_aligned_new(_("Performance:"),0,0.5,0,0),0,1,table_y,table_y+1,GtkAttachOptions(GTK_FILL),GTK_FILL,5,5);
+				args->statisticsLabel = widget = gtk_label_aligned_new("", 0, 0.5, 0, 0);
+				gtk_table_attach(GTK_TABLE(table), widget,1,2,table_y,table_y+1,GtkAttachOptions(GTK_FILL | GTK_EXPAND),GTK_FILL,5,0);
+				table_y++;
+
 			expander=gtk_expander_new("HSV");
 			gtk_expander_set_expanded(GTK_EXPANDER(expander), options->getBool("expander.hsv", false));
 			args->expanderHSV=expander;
@@ -82,6 +82,7 @@ std::vector<std::string> toTexts(ColorSpace colorSpace, const Color &color, floa
 	std::vector<std::string> result;
 	if (!gs.callbacks().componentToText().valid())
 		return result;
+	common::CallTimer timer(gs.callbacks().componentToTextCalls());
 	lua_State *L = gs.script();
 	int stackTop = lua_gettop(L);
 	gs.callbacks().componentToText().get();
@@ -108,6 +109,7 @@ std::vector<std::string> toTexts(ColorSpace colorSpace, const Color &color, floa
 	} else {
 		std::cerr << "componentToText: " << lua_tostring(L, -1) << '\n';
 	}
+	timer.error();
 	lua_settop(L, stackTop);
 	return result;
 }
@@ -22,31 +22,42 @@
 #include "lua/Color.h"
 #include "lua/ColorObject.h"
 #include "lua/Script.h"
+#include "lua/StatePool.h"
 #include "lua/Lua.h"
 #include <string>
 #include <iostream>
+#include <chrono>
 Converter::Options Converter::emptyOptions = {};
-Converter::Converter(const char *name, const char *label, lua::Ref &&serialize, lua::Ref &&deserialize):
+// Lua serialization of lists with at least this many colors is split between worker states.
+static const size_t parallelSerializeThreshold = 1024;
+Converter::Converter(const char *name, const char *label, lua::Ref &&serialize, lua::Ref &&deserialize, lua::Ref &&serializeList):
 	m_name(name),
 	m_label(label),
 	m_serialize(std::move(serialize)),
 	m_deserialize(std::move(deserialize)),
+	m_serializeList(std::move(serializeList)),
+	m_deserializeStatistics(),
 	m_copy(false),
 	m_paste(false) {
 }
-Converter::Converter(const char *name, const char *label, Callback<Serialize> serialize, Callback<Deserialize> deserialize):
+Converter::Converter(const char *name, const char *label, Callback<Serialize> serialize, Callback<Deserialize> deserialize, ConverterSignature signature):
 	m_name(name),
 	m_label(label),
 	m_serializeCallback(serialize),
 	m_deserializeCallback(deserialize),
+	m_signature(std::move(signature)),
+	m_deserializeStatistics(),
 	m_copy(false),
 	m_paste(false) {
 }
 std::string Converter::serialize(const ColorObject &colorObject, const ConverterSerializePosition &position) {
-	if (m_serializeCallback)
+	if (m_serializeCallback) {
+		common::CallTimer timer(m_serializeCalls);
 		return m_serializeCallback(colorObject, position);
+	}
 	if (!m_serialize.valid())
 		return "";
+	common::CallTimer timer(m_serializeCalls);
 	lua_State *L = m_serialize.script();
 	int stackTop = lua_gettop(L);
 	m_serialize.get();
@@ -73,14 +84,107 @@ std::string Converter::serialize(const ColorObject &colorObject, const Converter
 	} else {
 		std::cerr << "serialize: " << lua_tostring(L, -1) << '\n';
 	}
+	timer.error();
 	lua_settop(L, stackTop);
 	return "";
 }
+static void nextPosition(ConverterSerializePosition &position) {
+	position.incrementIndex();
+	if (position.index() + 1 == position.count())
+		position.last(true);
+	if (position.first())
+		position.first(false);
+}
+bool Converter::serializeList(const std::vector<const ColorObject *> &colorObjects, std::vector<std::string> &result) {
+	lua_State *L = m_serializeList.script();
+	int stackTop = lua_gettop(L);
+	std::vector<ColorObject> copies;
+	copies.reserve(colorObjects.size());
+	for (auto *colorObject: colorObjects)
+		copies.push_back(*colorObject);
+	m_serializeList.get();
+	lua_createtable(L, static_cast<int>(copies.size()), 0);
+	for (size_t i = 0; i < copies.size(); i++) {
+		lua::pushColorObject(L, &copies[i]);
+		lua_rawseti(L, -2, i + 1);
+	}
+	int status = lua_pcall(L, 1, 1, 0);
+	if (status != 0) {
+		std::cerr << "serializeList: " << lua_tostring(L, -1) << '\n';
+		lua_settop(L, stackTop);
+		return false;
+	}
+	if (lua_type(L, -1) != LUA_TTABLE || lua_rawlen(L, -1) != copies.size()) {
+		std::cerr << "serializeList: returned not a list of " << copies.size() << " values \"" << m_name << "\"\n";
+		lua_settop(L, stackTop);
+		return false;
+	}
+	result.reserve(copies.size());
+	for (size_t i = 0; i < copies.size(); i++) {
+		lua_rawgeti(L, -1, i + 1);
+		if (lua_type(L, -1) != LUA_TSTRING) {
+			std::cerr << "serializeList: returned not a string value \"" << m_name << "\"\n";
+			lua_settop(L, stackTop);
+			return false;
+		}
+		size_t length;
+		const char *value = lua_tolstring(L, -1, &length);
+		result.emplace_back(value, length);
+		lua_pop(L, 1);
+	}
+	lua_settop(L, stackTop);
+	return true;
+}
+std::vector<std::string> Converter::serialize(const std::vector<const ColorObject *> &colorObjects) {
+	std::vector<std::string> result;
+	if (colorObjects.empty())
+		return result;
+	if (!m_serializeCallback && m_serializeList.valid()) {
+		auto start = std::chrono::steady_clock::now();
+		bool status = serializeList(colorObjects, result);
+		m_serializeCalls.add(std::chrono::steady_clock::now() - start, status ? 0 : colorObjects.size(), colorObjects.size());
+		if (status)
+			return result;
+		result.clear();
+	}
+	if (m_serializeCallback || !m_serialize.valid()) {
+		result.reserve(colorObjects.size());
+		ConverterSerializePosition position(colorObjects.size());
+		for (auto *colorObject: colorObjects) {
+			result.push_back(serialize(*colorObject, position));
+			nextPosition(position);
+		}
+		return result;
+	}
+	lua_State *L = m_serialize.script();
+	auto start = std::chrono::steady_clock::now();
+	size_t errors = 0;
+	if (colorObjects.size() >= parallelSerializeThreshold) {
+		auto statePool = lua::StatePool::get(L);
+		if (statePool && statePool->serialize(m_name, colorObjects, result, errors)) {
+			m_serializeCalls.add(std::chrono::steady_clock::now() - start, errors, colorObjects.size());
+			return result;
+		}
+		result.clear();
+	}
+	result.resize(colorObjects.size());
+	int stackTop = lua_gettop(L);
+	m_serialize.get();
+	errors = lua::serializeColorObjects(L, -1, m_name, colorObjects, 0, colorObjects.size(), result.data());
+	lua_settop(L, stackTop);
+	m_serializeCalls.add(std::chrono::steady_clock::now() - start, errors, colorObjects.size());
+	return result;
+}
 bool Converter::deserialize(const char *value, ColorObject &colorObject, float &quality) {
-	if (m_deserializeCallback)
-		return m_deserializeCallback(value, colorObject, quality);
+	if (m_deserializeCallback) {
+		common::CallTimer timer(m_deserializeCalls);
+		bool result = m_deserializeCallback(value, colorObject, quality);
+		(result ? m_deserializeStatistics.hits : m_deserializeStatistics.misses)++;
+		return result;
+	}
 	if (!m_deserialize.valid())
-		return "";
+		return false;
+	common::CallTimer timer(m_deserializeCalls);
 	lua_State *L = m_deserialize.script();
 	int stackTop = lua_gettop(L);
 	m_deserialize.get();
@@ -91,6 +195,7 @@ bool Converter::deserialize(const char *value, ColorObject &colorObject, float &
 		if (lua_type(L, -1) == LUA_TNUMBER) {
 			quality = static_cast<float>(luaL_checknumber(L, -1));
 			lua_settop(L, stackTop);
+			m_deserializeStatistics.hits++;
 			return true;
 		} else {
 			std::cerr << "deserialize: returned not a number value \"" << m_name << "\"\n";
@@ -98,7 +203,9 @@ bool Converter::deserialize(const char *value, ColorObject &colorObject, float &
 	} else {
 		std::cerr << "deserialize: " << lua_tostring(L, -1) << '\n';
 	}
+	timer.error();
 	lua_settop(L, stackTop);
+	m_deserializeStatistics.misses++;
 	return false;
 }
 std::string Converter::serialize(const ColorObject &colorObject) {
@@ -122,6 +229,29 @@ bool Converter::hasSerialize() const {
 bool Converter::hasDeserialize() const {
 	return m_deserialize.valid() || m_deserializeCallback;
 }
+const ConverterSignature &Converter::signature() const {
+	return m_signature;
+}
+void Converter::signature(ConverterSignature signature) {
+	m_signature = std::move(signature);
+}
+const Converter::DeserializeStatistics &Converter::deserializeStatistics() const {
+	return m_deserializeStatistics;
+}
+const common::CallStatistics &Converter::serializeCalls() const {
+	return m_serializeCalls;
+}
+const common::CallStatistics &Converter::deserializeCalls() const {
+	return m_deserializeCalls;
+}
+void Converter::resetStatistics() {
+	m_serializeCalls.reset();
+	m_deserializeCalls.reset();
+	m_deserializeStatistics = DeserializeStatistics();
+}
+void Converter::skipped() {
+	m_deserializeStatistics.skipped++;
+}
 void Converter::copy(bool value) {
 	m_copy = value;
 }
@@ -167,3 +297,52 @@ void ConverterSerializePosition::first(bool value) {
 void ConverterSerializePosition::last(bool value) {
 	m_last = value;
 }
+namespace {
+struct CharacterClasses {
+	CharacterClasses() {
+		for (int i = 0; i < 256; i++)
+			classes[i] = CharacterClass::none;
+		classes[static_cast<uint8_t>('#')] = CharacterClass::hash;
+		classes[static_cast<uint8_t>(',')] = CharacterClass::comma;
+		classes[static_cast<uint8_t>(';')] = CharacterClass::semicolon;
+		classes[static_cast<uint8_t>('\t')] = CharacterClass::tab;
+		classes[static_cast<uint8_t>('%')] = CharacterClass::percent;
+		classes[static_cast<uint8_t>('(')] = CharacterClass::parenthesis;
+		classes[static_cast<uint8_t>(')')] = CharacterClass::parenthesis;
+		for (int i = '0'; i <= '9'; i++)
+			classes[i] = CharacterClass::digit | CharacterClass::hexDigit;
+		for (int i = 'a'; i <= 'f'; i++)
+			classes[i] = classes[i - 'a' + 'A'] = CharacterClass::hexDigit;
+	}
+	CharacterClass classes[256];
+};
+const CharacterClasses characterClasses;
+}
+ConverterSignature::ConverterSignature():
+	m_classes(CharacterClass::none) {
+}
+ConverterSignature::ConverterSignature(CharacterClass classes, std::vector<std::string> substrings):
+	m_classes(classes),
+	m_substrings(std::move(substrings)) {
+}
+CharacterClass ConverterSignature::classify(std::string_view text) {
+	auto result = CharacterClass::none;
+	for (auto ch: text)
+		result = result | characterClasses.classes[static_cast<uint8_t>(ch)];
+	return result;
+}
+bool ConverterSignature::matches(CharacterClass classes, std::string_view text) const {
+	if ((classes & m_classes) != m_classes)
+		return false;
+	for (const auto &substring: m_substrings) {
+		if (text.find(substring) == std::string_view::npos)
+			return false;
+	}
+	return true;
+}
+CharacterClass ConverterSignature::classes() const {
+	return m_classes;
+}
+const std::vector<std::string> &ConverterSignature::substrings() const {
+	return m_substrings;
+}
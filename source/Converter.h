@@ -19,11 +19,39 @@
 #ifndef GPICK_CONVERTER_H_
 #define GPICK_CONVERTER_H_
 #include "lua/Ref.h"
-#include "common/Scoped.h"
+#include "common/Bitmask.h"
+#include "common/CallStatistics.h"
 #include <string>
-#include <locale>
+#include <string_view>
+#include <vector>
+#include <functional>
+#include <cstdint>
 struct ColorObject;
 struct Color;
+enum class CharacterClass : uint16_t {
+	none = 0,
+	hash = 1 << 0,
+	digit = 1 << 1,
+	hexDigit = 1 << 2,
+	comma = 1 << 3,
+	semicolon = 1 << 4,
+	tab = 1 << 5,
+	percent = 1 << 6,
+	parenthesis = 1 << 7,
+};
+ENABLE_BITMASK_OPERATORS(CharacterClass);
+// Cheap lexical test which text has to pass before converter deserialization is attempted. Text must contain at least one character of each required class and all required substrings.
+struct ConverterSignature {
+	ConverterSignature();
+	ConverterSignature(CharacterClass classes, std::vector<std::string> substrings = {});
+	static CharacterClass classify(std::string_view text);
+	bool matches(CharacterClass classes, std::string_view text) const;
+	CharacterClass classes() const;
+	const std::vector<std::string> &substrings() const;
+private:
+	CharacterClass m_classes;
+	std::vector<std::string> m_substrings;
+};
 struct ConverterSerializePosition {
 	ConverterSerializePosition();
 	ConverterSerializePosition(size_t count);
@@ -44,6 +72,9 @@ struct Converter {
 		bool cssPercentages;
 		bool cssAlphaPercentage;
 	};
+	struct DeserializeStatistics {
+		uint64_t skipped, misses, hits;
+	};
 	static Options emptyOptions;
 	template<typename T>
 	struct Callback {
@@ -57,21 +88,19 @@ struct Converter {
 		}
 		template<typename... Args>
 		auto operator()(Args &... args) const {
-			auto locale = std::setlocale(LC_NUMERIC, "C");
-			common::Scoped resetLocale(std::setlocale, LC_NUMERIC, locale);
 			return m_callback(args..., m_options);
 		}
 		explicit operator bool() const {
-			return m_callback;
+			return static_cast<bool>(m_callback);
 		}
 	private:
 		T m_callback;
 		const Options &m_options;
 	};
-	using Serialize = std::string (*)(const ColorObject &colorObject, const ConverterSerializePosition &position, const Options &options);
-	using Deserialize = bool (*)(const char *value, ColorObject &colorObject, float &quality, const Options &options);
-	Converter(const char *name, const char *label, Callback<Serialize> serialize, Callback<Deserialize> deserialize);
-	Converter(const char *name, const char *label, lua::Ref &&serialize, lua::Ref &&deserialize);
+	using Serialize = std::function<std::string(const ColorObject &colorObject, const ConverterSerializePosition &position, const Options &options)>;
+	using Deserialize = std::function<bool(const char *value, ColorObject &colorObject, float &quality, const Options &options)>;
+	Converter(const char *name, const char *label, Callback<Serialize> serialize, Callback<Deserialize> deserialize, ConverterSignature signature = ConverterSignature());
+	Converter(const char *name, const char *label, lua::Ref &&serialize, lua::Ref &&deserialize, lua::Ref &&serializeList = lua::Ref());
 	const std::string &name() const;
 	const std::string &label() const;
 	bool hasSerialize() const;
@@ -83,13 +112,26 @@ struct Converter {
 	std::string serialize(const ColorObject &colorObject, const ConverterSerializePosition &position);
 	std::string serialize(const ColorObject &colorObject);
 	std::string serialize(const Color &color);
+	// Serializes multiple colors at once, filling in position for each color. Lua converters can provide a batch function, which is called once for all colors, otherwise per color serialization is used with reused position table and color object. Large lists are split between worker Lua states when state pool is available.
+	std::vector<std::string> serialize(const std::vector<const ColorObject *> &colorObjects);
 	bool deserialize(const char *value, ColorObject &colorObject, float &quality);
+	const ConverterSignature &signature() const;
+	void signature(ConverterSignature signature);
+	const DeserializeStatistics &deserializeStatistics() const;
+	void skipped();
+	const common::CallStatistics &serializeCalls() const;
+	const common::CallStatistics &deserializeCalls() const;
+	void resetStatistics();
 private:
 	std::string m_name;
 	std::string m_label;
-	lua::Ref m_serialize, m_deserialize;
+	lua::Ref m_serialize, m_deserialize, m_serializeList;
 	Callback<Serialize> m_serializeCallback;
 	Callback<Deserialize> m_deserializeCallback;
+	ConverterSignature m_signature;
+	DeserializeStatistics m_deserializeStatistics;
+	common::CallStatistics m_serializeCalls, m_deserializeCalls;
 	bool m_copy, m_paste;
+	bool serializeList(const std::vector<const ColorObject *> &colorObjects, std::vector<std::string> &result);
 };
 #endif /* GPICK_CONVERTER_H_ */
@@ -21,7 +21,9 @@
 #include "ColorObject.h"
 #include "common/First.h"
 #include <unordered_set>
-Converters::Converters() {
+Converters::Converters():
+	m_displayConverter(nullptr),
+	m_colorListConverter(nullptr) {
 }
 Converters::~Converters() {
 	for (auto converter: m_allConverters) {
@@ -37,23 +39,29 @@ void Converters::add(Converter *converter) {
 	if (converter->copy() && converter->hasSerialize())
 		m_copyConverters.push_back(converter);
 	if (converter->paste() && converter->hasDeserialize())
-		m_pasteConverters.push_back(converter);
+		addPasteConverter(converter);
 	m_converters[converter->name()] = converter;
 }
-void Converters::add(const char *name, const char *label, Converter::Callback<Converter::Serialize> serialize, Converter::Callback<Converter::Deserialize> deserialize) {
-	add(new Converter(name, label, serialize, deserialize));
+void Converters::add(const char *name, const char *label, Converter::Callback<Converter::Serialize> serialize, Converter::Callback<Converter::Deserialize> deserialize, ConverterSignature signature) {
+	add(new Converter(name, label, serialize, deserialize, std::move(signature)));
 }
-void Converters::add(const char *name, const std::string &label, Converter::Callback<Converter::Serialize> serialize, Converter::Callback<Converter::Deserialize> deserialize) {
-	add(new Converter(name, label.c_str(), serialize, deserialize));
+void Converters::add(const char *name, const std::string &label, Converter::Callback<Converter::Serialize> serialize, Converter::Callback<Converter::Deserialize> deserialize, ConverterSignature signature) {
+	add(new Converter(name, label.c_str(), serialize, deserialize, std::move(signature)));
+}
+void Converters::addPasteConverter(Converter *converter) {
+	m_pasteConverters.push_back(converter);
+	const auto &signature = converter->signature();
+	m_pasteCandidates.push_back(PasteCandidate { signature.classes(), !signature.substrings().empty(), converter });
 }
 void Converters::rebuildCopyPasteArrays() {
 	m_copyConverters.clear();
 	m_pasteConverters.clear();
+	m_pasteCandidates.clear();
 	for (auto converter: m_allConverters) {
 		if (converter->copy() && converter->hasSerialize())
 			m_copyConverters.push_back(converter);
 		if (converter->paste() && converter->hasDeserialize())
-			m_pasteConverters.push_back(converter);
+			addPasteConverter(converter);
 	}
 }
 const std::vector<Converter *> &Converters::all() const {
@@ -161,27 +169,35 @@ std::string Converters::serialize(const Color &color, Type type) {
 	ColorObject colorObject("", color);
 	return serialize(colorObject, type);
 }
+bool Converters::tryDeserialize(Converter *converter, const std::string &value, CharacterClass classes, ColorObject &colorObject, float &quality) {
+	if (!converter->signature().matches(classes, value)) {
+		converter->skipped();
+		return false;
+	}
+	return converter->deserialize(value.c_str(), colorObject, quality) && quality > 0;
+}
 bool Converters::deserialize(const std::string &value, ColorObject &outputColorObject) {
 	common::First<float, std::greater<float>, ColorObject> bestConversion;
 	ColorObject colorObject;
 	float quality;
-	if (m_displayConverter) {
-		Converter *converter = m_displayConverter;
-		if (converter->hasDeserialize()) {
-			if (converter->deserialize(value.c_str(), colorObject, quality)) {
-				if (quality > 0) {
-					bestConversion(quality, colorObject);
-				}
-			}
-		}
+	auto classes = ConverterSignature::classify(value);
+	if (m_displayConverter && m_displayConverter->hasDeserialize()) {
+		if (tryDeserialize(m_displayConverter, value, classes, colorObject, quality))
+			bestConversion(quality, colorObject);
 	}
-	for (auto &converter: m_pasteConverters) {
-		if (converter == m_displayConverter || !converter->hasDeserialize())
+	for (const auto &candidate: m_pasteCandidates) {
+		if (candidate.converter == m_displayConverter)
+			continue;
+		// Character classes are checked from the table, so most converters which can not match are skipped without looking at converter itself.
+		if ((classes & candidate.classes) != candidate.classes) {
+			candidate.converter->skipped();
 			continue;
-		if (converter->deserialize(value.c_str(), colorObject, quality)) {
-			if (quality > 0) {
+		}
+		if (candidate.hasSubstrings) {
+			if (tryDeserialize(candidate.converter, value, classes, colorObject, quality))
 				bestConversion(quality, colorObject);
-			}
+		} else if (candidate.converter->deserialize(value.c_str(), colorObject, quality) && quality > 0) {
+			bestConversion(quality, colorObject);
 		}
 	}
 	if (!bestConversion)
@@ -33,8 +33,8 @@ struct Converters {
 	Converters();
 	~Converters();
 	void add(Converter *converter);
-	void add(const char *name, const char *label, Converter::Callback<Converter::Serialize> serialize, Converter::Callback<Converter::Deserialize> deserialize);
-	void add(const char *name, const std::string &label, Converter::Callback<Converter::Serialize> serialize, Converter::Callback<Converter::Deserialize> deserialize);
+	void add(const char *name, const char *label, Converter::Callback<Converter::Serialize> serialize, Converter::Callback<Converter::Deserialize> deserialize, ConverterSignature signature = ConverterSignature());
+	void add(const char *name, const std::string &label, Converter::Callback<Converter::Serialize> serialize, Converter::Callback<Converter::Deserialize> deserialize, ConverterSignature signature = ConverterSignature());
 	const std::vector<Converter *> &all() const;
 	const std::vector<Converter *> &allCopy() const;
 	const std::vector<Converter *> &allPaste() const;
@@ -60,8 +60,16 @@ struct Converters {
 	void reorder(const std::vector<std::string> &names);
 	bool hasCopy() const;
 private:
+	struct PasteCandidate {
+		CharacterClass classes;
+		bool hasSubstrings;
+		Converter *converter;
+	};
 	std::unordered_map<std::string, Converter *> m_converters;
 	std::vector<Converter *> m_allConverters, m_copyConverters, m_pasteConverters;
+	std::vector<PasteCandidate> m_pasteCandidates;
+	void addPasteConverter(Converter *converter);
+	bool tryDeserialize(Converter *converter, const std::string &value, CharacterClass classes, ColorObject &colorObject, float &quality);
 	Converter *m_displayConverter;
 	Converter *m_colorListConverter;
 };
@@ -32,9 +32,16 @@
 #include "ToolColorNaming.h"
 #include "ScreenReader.h"
 #include "Sampler.h"
+#include "PickerThread.h"
+#include "PickerScheduler.h"
+#include "math/RegionStatistics.h"
 #include "color_names/ColorNames.h"
 #include "common/SetOnScopeEnd.h"
+#include "common/Format.h"
+#include "I18N.h"
 #include <gdk/gdkkeysyms.h>
+#include <cmath>
+#include <iomanip>
 #include <string>
 #include <sstream>
 using namespace std;
@@ -43,7 +50,6 @@ struct FloatingPickerArgs {
 	GtkWidget* window;
 	GtkWidget* zoomed;
 	GtkWidget* color_widget;
-	guint timeout_source_id;
 	IColorPicker *colorPicker;
 	Converter *converter;
 	GlobalState* gs;
@@ -54,6 +60,16 @@ struct FloatingPickerArgs {
 	bool menu_button_pressed;
 	function<void(FloatingPicker, const Color&)> custom_pick_action;
 	function<void(FloatingPicker)> custom_done_action;
+	std::unique_ptr<PickerThread> picker_thread;
+	bool picker_thread_started;
+	std::unique_ptr<PickerScheduler> scheduler;
+	bool region_mode;
+	bool region_started;
+	math::Vector2i region_start;
+	math::Rectangle<int> region;
+	GdkScreen *region_screen;
+	guint region_capture_id;
+	bool region_capture_pending;
 };
 
 struct PickerColorNameAssigner: public ToolColorNameAssigner {
@@ -71,7 +87,21 @@ struct PickerColorNameAssigner: public ToolColorNameAssigner {
 protected:
 	std::stringstream m_stream;
 };
-static void get_color_sample(FloatingPickerArgs *args, bool update_widgets, Color* c)
+struct RegionColorNameAssigner: public ToolColorNameAssigner {
+	RegionColorNameAssigner(GlobalState &gs):
+		ToolColorNameAssigner(gs) {
+	}
+	void assign(ColorObject &colorObject, const std::string &statistic) {
+		m_statistic = statistic;
+		ToolColorNameAssigner::assign(colorObject);
+	}
+	virtual std::string getToolSpecificName(const ColorObject &colorObject) override {
+		return m_statistic;
+	}
+protected:
+	std::string m_statistic;
+};
+static bool get_color_sample(FloatingPickerArgs *args, bool update_widgets, bool only_if_changed, Color* c)
 {
 	GdkScreen *screen;
 	GdkModifierType state;
@@ -91,7 +121,10 @@ static void get_color_sample(FloatingPickerArgs *args, bool update_widgets, Colo
 		gtk_zoomed_get_screen_rect(GTK_ZOOMED(args->zoomed), pointer, screen_rect, &zoomed_rect);
 		screen_reader_add_rect(screen_reader, screen, zoomed_rect);
 	}
-	screen_reader_update_surface(screen_reader, &final_rect);
+	if (!only_if_changed)
+		screen_reader_invalidate(screen_reader);
+	if (!screen_reader_update_surface(screen_reader, pointer, &final_rect) && only_if_changed)
+		return false;
 	math::Vector2i offset;
 	offset = sampler_rect.position() - final_rect.position();
 	sampler_get_color_sample(args->gs->getSampler(), pointer, screen_rect, offset, c);
@@ -99,14 +132,11 @@ static void get_color_sample(FloatingPickerArgs *args, bool update_widgets, Colo
 		offset = final_rect.position() - zoomed_rect.position();
 		gtk_zoomed_update(GTK_ZOOMED(args->zoomed), pointer, screen_rect, offset, screen_reader_get_surface(screen_reader));
 	}
+	return true;
 }
-static gboolean update_display(FloatingPickerArgs *args)
+static void move_window(FloatingPickerArgs *args, GdkScreen *screen, int x, int y)
 {
-	GdkScreen *screen;
-	GdkModifierType state;
-	int x, y;
 	int width, height;
-	gdk_display_get_pointer(gdk_display_get_default(), &screen, &x, &y, &state);
 	width = gdk_screen_get_width(screen);
 	height = gdk_screen_get_height(screen);
 	gint sx, sy;
@@ -125,8 +155,9 @@ static gboolean update_display(FloatingPickerArgs *args)
 		gtk_window_set_screen(GTK_WINDOW(args->window), screen);
 	}
 	gtk_window_move(GTK_WINDOW(args->window), x, y);
-	Color c;
-	get_color_sample(args, true, &c);
+}
+static void set_color(FloatingPickerArgs *args, Color &c)
+{
 	string text;
 	auto converter = args->converter;
 	if (!converter){
@@ -135,8 +166,68 @@ static gboolean update_display(FloatingPickerArgs *args)
 	if (converter)
 		text = converter->serialize(c);
 	gtk_color_set_color(GTK_COLOR(args->color_widget), &c, text.c_str());
+}
+static math::Rectangle<int> region_rect(const math::Vector2i &start, int x, int y)
+{
+	return math::Rectangle<int>(std::min(start.x, x), std::min(start.y, y), std::max(start.x, x) + 1, std::max(start.y, y) + 1);
+}
+static void show_region_size(FloatingPickerArgs *args, int x, int y)
+{
+	if (!args->region_started)
+		return;
+	auto rect = region_rect(args->region_start, x, y);
+	stringstream ss;
+	ss << rect.getWidth() << "x" << rect.getHeight();
+	gtk_color_set_text(GTK_COLOR(args->color_widget), ss.str());
+}
+static bool update_display(FloatingPickerArgs *args, bool only_if_changed)
+{
+	GdkScreen *screen;
+	GdkModifierType state;
+	int x, y;
+	gdk_display_get_pointer(gdk_display_get_default(), &screen, &x, &y, &state);
+	Color c;
+	if (!get_color_sample(args, true, only_if_changed, &c))
+		return false;
+	move_window(args, screen, x, y);
+	set_color(args, c);
+	show_region_size(args, x, y);
 	return true;
 }
+static void update_display(FloatingPickerArgs *args, const PickerFrame &frame)
+{
+	move_window(args, gtk_window_get_screen(GTK_WINDOW(args->window)), frame.pointer.x, frame.pointer.y);
+	math::Vector2i pointer = frame.pointer;
+	math::Rectangle<int> screen_rect = frame.screenRect;
+	math::Vector2i offset = frame.captureRect.position() - frame.zoomedRect.position();
+	cairo_surface_t *surface = frame.createSurface();
+	gtk_zoomed_update(GTK_ZOOMED(args->zoomed), pointer, screen_rect, offset, surface);
+	cairo_surface_destroy(surface);
+	Color c = frame.color;
+	set_color(args, c);
+	show_region_size(args, frame.pointer.x, frame.pointer.y);
+}
+static PickerThread::Settings picker_thread_settings(FloatingPickerArgs *args)
+{
+	PickerThread::Settings settings;
+	settings.oversample = sampler_get_oversample(args->gs->getSampler());
+	settings.falloff = sampler_get_falloff(args->gs->getSampler());
+	settings.linearLight = sampler_get_linear_light(args->gs->getSampler());
+	settings.zoomedAreaSize = gtk_zoomed_get_area_size(GTK_ZOOMED(args->zoomed));
+	settings.maxStaleness = args->gs->settings().getInt32("gpick.picker.max_staleness", 500);
+	return settings;
+}
+static bool scheduled_update(FloatingPickerArgs *args)
+{
+	if (args->picker_thread && !args->picker_thread->failed()) {
+		bool changed = args->picker_thread->consume();
+		if (changed)
+			update_display(args, args->picker_thread->frame());
+		args->picker_thread->request();
+		return changed;
+	}
+	return update_display(args, true);
+}
 void floating_picker_activate(FloatingPickerArgs *args, bool hide_on_mouse_release, bool single_pick_mode, const char *converter_name)
 {
 #ifndef WIN32 //Pointer grabbing in Windows is broken, disabling floating picker for now
@@ -148,17 +239,28 @@ void floating_picker_activate(FloatingPickerArgs *args, bool hide_on_mouse_relea
 	args->release_mode = hide_on_mouse_release && !single_pick_mode;
 	args->single_pick_mode = single_pick_mode;
 	args->click_mode = true;
+	args->region_mode = false;
+	args->region_started = false;
 	GdkCursor* cursor;
 	if (args->gs->settings().getBool("gpick.picker.hide_cursor", false))
 		cursor = gdk_cursor_new(GDK_BLANK_CURSOR);
 	else
 		cursor = gdk_cursor_new(GDK_TCROSS);
-	update_display(args);
+	update_display(args, false);
 	gtk_widget_show(args->window);
 	gdk_pointer_grab(gtk_widget_get_window(args->window), false, GdkEventMask(GDK_POINTER_MOTION_MASK | GDK_BUTTON_RELEASE_MASK | GDK_BUTTON_PRESS_MASK | GDK_SCROLL_MASK), nullptr, cursor, GDK_CURRENT_TIME);
 	gdk_keyboard_grab(gtk_widget_get_window(args->window), false, GDK_CURRENT_TIME);
-	auto refresh_rate = args->gs->settings().getInt32("gpick.picker.refresh_rate", 30);
-	args->timeout_source_id = g_timeout_add_full(G_PRIORITY_DEFAULT_IDLE, static_cast<int>(1000 / refresh_rate), (GSourceFunc)update_display, args, (GDestroyNotify)nullptr);
+	screen_reader_set_max_staleness(args->gs->getScreenReader(), args->gs->settings().getInt32("gpick.picker.max_staleness", 500));
+	args->scheduler->start(args->gs->settings().getInt32("gpick.picker.refresh_rate", 30));
+	if (!args->picker_thread_started) {
+		// Thread and its display connection are kept until floating picker is destroyed, inactive thread only waits for requests.
+		args->picker_thread = PickerThread::start(gtk_window_get_screen(GTK_WINDOW(args->window)), picker_thread_settings(args));
+		args->picker_thread_started = true;
+	} else if (args->picker_thread) {
+		args->picker_thread->configure(picker_thread_settings(args));
+	}
+	if (args->picker_thread)
+		args->picker_thread->request(true);
 #if GTK_MAJOR_VERSION >= 3
 	g_object_unref(cursor);
 #else
@@ -166,14 +268,16 @@ void floating_picker_activate(FloatingPickerArgs *args, bool hide_on_mouse_relea
 #endif
 #endif
 }
+void floating_picker_activate_region(FloatingPickerArgs *args)
+{
+	floating_picker_activate(args, false, false, nullptr);
+	args->region_mode = true;
+}
 void floating_picker_deactivate(FloatingPickerArgs *args)
 {
 	gdk_pointer_ungrab(GDK_CURRENT_TIME);
 	gdk_keyboard_ungrab(GDK_CURRENT_TIME);
-	if (args->timeout_source_id > 0){
-		g_source_remove(args->timeout_source_id);
-		args->timeout_source_id = 0;
-	}
+	args->scheduler->stop();
 	gtk_widget_hide(args->window);
 }
 static gboolean scroll_event_cb(GtkWidget *widget, GdkEventScroll *event, FloatingPickerArgs *args)
@@ -187,6 +291,9 @@ static gboolean scroll_event_cb(GtkWidget *widget, GdkEventScroll *event, Floati
 		gtk_zoomed_set_zoom(GTK_ZOOMED(args->zoomed), zoom);
 	} else
 		return false;
+	screen_reader_invalidate(args->gs->getScreenReader());
+	if (args->picker_thread)
+		args->picker_thread->configure(picker_thread_settings(args));
 	return true;
 }
 static void finish_picking(FloatingPickerArgs *args)
@@ -200,7 +307,7 @@ static void complete_picking(FloatingPickerArgs *args)
 {
 	if (args->release_mode || args->click_mode){
 		Color c;
-		get_color_sample(args, false, &c);
+		get_color_sample(args, false, false, &c);
 		if (args->perform_custom_pick_action){
 			if (args->custom_pick_action)
 				args->custom_pick_action(args, c);
@@ -227,16 +334,80 @@ static void complete_picking(FloatingPickerArgs *args)
 		}
 	}
 }
+static void pick_region(FloatingPickerArgs *args)
+{
+	math::Rectangle<int> region = args->region;
+	// Region is captured into a temporary surface, so that picker buffers do not grow to region size.
+	cairo_surface_t *surface = screen_reader_capture_area(args->region_screen, region);
+	if (!surface)
+		return;
+	auto statistics = math::regionStatistics(cairo_image_surface_get_data(surface), region.getWidth(), region.getHeight(), cairo_image_surface_get_stride(surface));
+	cairo_surface_destroy(surface);
+	stringstream size, deviation;
+	size << region.getWidth() << "x" << region.getHeight();
+	deviation << std::fixed << std::setprecision(1);
+	for (int channel = 0; channel < 3; channel++)
+		deviation << (channel ? " " : "") << std::sqrt(statistics.variance[channel]) * 255;
+	struct {
+		const Color &color;
+		std::string name;
+	} results[] = {
+		{ statistics.mean, common::format(_("Region {} mean, deviation {}"), size.str(), deviation.str()) },
+		{ statistics.median, common::format(_("Region {} median"), size.str()) },
+		{ statistics.dominant, common::format(_("Region {} dominant"), size.str()) },
+	};
+	RegionColorNameAssigner nameAssigner(*args->gs);
+	for (const auto &result: results){
+		ColorObject colorObject(result.color);
+		nameAssigner.assign(colorObject, result.name);
+		args->gs->colorList().add(colorObject);
+	}
+}
+static gboolean capture_region_cb(FloatingPickerArgs *args)
+{
+	args->region_capture_id = 0;
+	pick_region(args);
+	return false;
+}
+static void complete_region_picking(FloatingPickerArgs *args)
+{
+	int x, y;
+	gdk_display_get_pointer(gdk_display_get_default(), &args->region_screen, &x, &y, nullptr);
+	auto rect = region_rect(args->region_start, x, y);
+	int left = std::max(rect.getLeft(), 0), top = std::max(rect.getTop(), 0);
+	int right = std::min(rect.getRight(), gdk_screen_get_width(args->region_screen)), bottom = std::min(rect.getBottom(), gdk_screen_get_height(args->region_screen));
+	if (left >= right || top >= bottom)
+		return;
+	args->region = math::Rectangle<int>(left, top, right, bottom);
+	// Floating picker window covers part of the region, so capture is done only after window is unmapped.
+	args->region_capture_pending = true;
+}
+static gboolean unmap_event_cb(GtkWidget *widget, GdkEvent *event, FloatingPickerArgs *args)
+{
+	if (!args->region_capture_pending)
+		return false;
+	args->region_capture_pending = false;
+	if (args->region_capture_id == 0)
+		args->region_capture_id = g_idle_add((GSourceFunc)capture_region_cb, args);
+	return false;
+}
 static void show_copy_menu(int button, int event_time, FloatingPickerArgs *args)
 {
 	Color color;
-	get_color_sample(args, false, &color);
+	get_color_sample(args, false, false, &color);
 	auto menu = StandardMenu::newMenu(color, args->gs);
 	showContextMenu(menu, nullptr);
 }
 static gboolean button_release_cb(GtkWidget *widget, GdkEventButton *event, FloatingPickerArgs *args)
 {
 	if ((event->type == GDK_BUTTON_RELEASE) && (event->button == 1)) {
+		if (args->region_mode){
+			if (!args->region_started)
+				return false;
+			complete_region_picking(args);
+			finish_picking(args);
+			return false;
+		}
 		complete_picking(args);
 		finish_picking(args);
 	}else if ((event->type == GDK_BUTTON_RELEASE) && (event->button == 3) && args->menu_button_pressed) {
@@ -250,6 +421,9 @@ static gboolean button_press_cb(GtkWidget *widget, GdkEventButton *event, Floati
 {
 	if ((event->type == GDK_BUTTON_PRESS) && (event->button == 3)) {
 		args->menu_button_pressed = true;
+	}else if ((event->type == GDK_BUTTON_PRESS) && (event->button == 1) && args->region_mode) {
+		args->region_started = true;
+		args->region_start = math::Vector2i(static_cast<int>(event->x_root), static_cast<int>(event->y_root));
 	}
 	return false;
 }
@@ -349,14 +523,24 @@ static gboolean key_up_cb(GtkWidget *widget, GdkEventKey *event, FloatingPickerA
 }
 static void destroy_cb(GtkWidget *widget, FloatingPickerArgs *args)
 {
+	if (args->region_capture_id > 0)
+		g_source_remove(args->region_capture_id);
+	args->scheduler.reset();
 	delete args;
 }
 FloatingPickerArgs* floating_picker_new(GlobalState *gs)
 {
 	FloatingPickerArgs *args = new FloatingPickerArgs;
-	args->timeout_source_id = 0;
 	args->gs = gs;
+	args->region_mode = false;
+	args->region_started = false;
+	args->region_capture_id = 0;
+	args->region_capture_pending = false;
+	args->picker_thread_started = false;
 	args->window = gtk_window_new(GTK_WINDOW_POPUP);
+	args->scheduler = std::make_unique<PickerScheduler>(args->window, [args]() {
+		return scheduled_update(args);
+	});
 	args->colorPicker = nullptr;
 	args->perform_custom_pick_action = false;
 	args->menu_button_pressed = false;
@@ -379,6 +563,7 @@ FloatingPickerArgs* floating_picker_new(GlobalState *gs)
 	g_signal_connect(G_OBJECT(args->window), "button-press-event", G_CALLBACK(button_press_cb), args);
 	g_signal_connect(G_OBJECT(args->window), "button-release-event", G_CALLBACK(button_release_cb), args);
 	g_signal_connect(G_OBJECT(args->window), "key_press_event", G_CALLBACK(key_up_cb), args);
+	g_signal_connect(G_OBJECT(args->window), "unmap-event", G_CALLBACK(unmap_event_cb), args);
 	g_signal_connect(G_OBJECT(args->window), "destroy", G_CALLBACK(destroy_cb), args);
 	return args;
 }
@@ -26,6 +26,10 @@ FloatingPicker floating_picker_new(GlobalState *gs);
 void floating_picker_set_picker_source(FloatingPicker fp, IColorPicker *colorPicker);
 void floating_picker_free(FloatingPicker fp);
 void floating_picker_activate(FloatingPicker fp, bool hide_on_mouse_release, bool single_pick_mode, const char *converter_name);
+/**
+ * Activate floating picker in region mode. Dragged rectangle mean, median and dominant colors are added to palette.
+ */
+void floating_picker_activate_region(FloatingPicker fp);
 void floating_picker_deactivate(FloatingPicker fp);
 void floating_picker_set_custom_pick_action(FloatingPicker fp, std::function<void(FloatingPicker, const Color&)> action);
 void floating_picker_set_custom_done_action(FloatingPicker fp, std::function<void(FloatingPicker)> action);
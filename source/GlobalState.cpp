@@ -22,6 +22,7 @@
 #include "Converters.h"
 #include "Converter.h"
 #include "InternalConverters.h"
+#include "TemplateConverter.h"
 #include "Random.h"
 #include "color_names/ColorNames.h"
 #include "Sampler.h"
@@ -35,6 +36,8 @@
 #include "lua/Script.h"
 #include "lua/Extensions.h"
 #include "lua/Callbacks.h"
+#include "lua/DynvSystem.h"
+#include "lua/StatePool.h"
 #include "lua/Lua.h"
 #include <filesystem>
 #include <cstdlib>
@@ -42,6 +45,8 @@
 #include <fstream>
 #include <iostream>
 #include <stdexcept>
+#include <thread>
+#include <algorithm>
 namespace {
 struct ConverterOptions: public Converter::Options, public IEventHandler {
 	ConverterOptions(const dynv::Map &settings):
@@ -88,6 +93,7 @@ struct GlobalState::Impl {
 	IColorSource *m_colorSource;
 	EventBus m_eventBus;
 	ConverterOptions m_converterOptions;
+	std::unique_ptr<lua::StatePool> m_statePool;
 	Impl(GlobalState *decl):
 		m_decl(decl),
 		m_colorNames(nullptr),
@@ -181,16 +187,53 @@ struct GlobalState::Impl {
 		paths.push_back(buildFilename());
 		paths.push_back(buildConfigPath());
 		m_script.setPaths(paths);
+		m_script.setCachePath(buildConfigPath("lua-cache"));
 		bool result = m_script.load("init");
 		if (!result) {
 			std::cerr << "Lua load error: " << m_script.getLastError() << "\n";
 		}
+		initializeStatePool(paths);
 		return result;
 	}
+	void initializeStatePool(const std::vector<std::string> &paths) {
+		size_t size = std::min<size_t>(std::thread::hardware_concurrency(), 4);
+		if (size < 2)
+			return;
+		auto initialize = [this, paths](lua::Script &script) {
+			lua::registerAll(script, *m_decl);
+			script.setPaths(paths);
+			script.setCachePath(buildConfigPath("lua-cache"));
+			if (!script.load("init")) {
+				std::cerr << "Lua worker load error: " << script.getLastError() << "\n";
+				return false;
+			}
+			return true;
+		};
+		auto prepare = [this](lua::Script &script) {
+			lua_State *L = script;
+			int stackTop = lua_gettop(L);
+			lua_getfield(L, LUA_REGISTRYINDEX, lua::StatePool::optionChangeKey);
+			if (lua_type(L, -1) != LUA_TFUNCTION) {
+				lua_settop(L, stackTop);
+				return true;
+			}
+			lua::pushDynvSystem(L, dynv::Ref(&m_settings));
+			if (lua_pcall(L, 1, 0, 0) != 0) {
+				std::cerr << "optionsUpdate: " << lua_tostring(L, -1) << "\n";
+				lua_settop(L, stackTop);
+				return false;
+			}
+			lua_settop(L, stackTop);
+			return true;
+		};
+		m_statePool = std::make_unique<lua::StatePool>(size, initialize, prepare);
+		lua::StatePool::set(m_script, m_statePool.get());
+	}
 	void initializeConverters() {
 		m_eventBus.subscribe(EventType::optionsUpdate, m_converterOptions);
 		m_converterOptions.update();
 		addInternalConverters(m_converters, m_converterOptions);
+		addTemplateConverters(m_converters, m_settings, m_converterOptions);
 	}
 	bool loadConverters() {
 		auto converters = m_settings.getOrCreateMap("gpick.converters");
@@ -17,12 +17,14 @@
  */
 
 #pragma once
+#include <vector>
 struct ColorList;
 struct ColorObject;
 struct IPalette {
 	virtual ~IPalette() = default;
 	virtual void add(ColorList &colorList, ColorObject *colorObject) = 0;
-	virtual void remove(ColorList &colorList, ColorObject *colorObject) = 0;
+	virtual void add(ColorList &colorList, const std::vector<ColorObject *> &colorObjects) = 0;
+	virtual void remove(ColorList &colorList, const std::vector<ColorObject *> &colorObjects) = 0;
 	virtual void removeSelected(ColorList &colorList) = 0;
 	virtual void clear(ColorList &colorList) = 0;
 	virtual void update(ColorList &colorList) = 0;
@@ -208,20 +208,14 @@ bool ImportExport::exportTXT() {
 		m_lastError = Error::couldNotOpenFile;
 		return false;
 	}
-	ConverterSerializePosition position(m_colorList.size());
-	for (auto color: m_colorList) {
-		std::string line = m_converter->serialize(*color, position);
+	std::vector<const ColorObject *> colorObjects(m_colorList.begin(), m_colorList.end());
+	auto lines = m_converter->serialize(colorObjects);
+	for (size_t i = 0; i < lines.size(); i++) {
 		if (m_includeColorNames) {
-			f << line << " " << color->getName() << '\n';
+			f << lines[i] << " " << colorObjects[i]->getName() << '\n';
 		} else {
-			f << line << '\n';
-		}
-		position.incrementIndex();
-		if (position.index() + 1 == position.count()) {
-			position.last(true);
+			f << lines[i] << '\n';
 		}
-		if (position.first())
-			position.first(false);
 		if (!f.good()) {
 			f.close();
 			m_lastError = Error::fileWriteError;
@@ -310,7 +304,7 @@ bool ImportExport::exportCSS() {
 	f.close();
 	return true;
 }
-static void htmlColor(ColorObject *colorObject, Converter *converter, bool includeColorName, std::ostream &stream) {
+static void htmlColor(const ColorObject *colorObject, const std::string *text, bool includeColorName, std::ostream &stream) {
 	Color color, textColor;
 	color = colorObject->getColor();
 	textColor = color.getContrasting();
@@ -321,8 +315,8 @@ static void htmlColor(ColorObject *colorObject, Converter *converter, bool inclu
 		if (!name.empty())
 			stream << name << ":<br/>";
 	}
-	if (converter)
-		stream << "<span>" << converter->serialize(*colorObject) << "</span></div>";
+	if (text)
+		stream << "<span>" << *text << "</span></div>";
 	else
 		stream << "<span>" << HtmlRGB(color) << "</span></div>";
 }
@@ -425,8 +419,12 @@ bool ImportExport::exportHTML() {
 	} else {
 		f << std::nouppercase;
 	}
-	for (auto color: m_colorList) {
-		htmlColor(color, m_converter, m_includeColorNames, f);
+	std::vector<const ColorObject *> colorObjects(m_colorList.begin(), m_colorList.end());
+	std::vector<std::string> texts;
+	if (m_converter)
+		texts = m_converter->serialize(colorObjects);
+	for (size_t i = 0; i < colorObjects.size(); i++) {
+		htmlColor(colorObjects[i], m_converter ? &texts[i] : nullptr, m_includeColorNames, f);
 		if (!f.good()) {
 			f.close();
 			m_lastError = Error::fileWriteError;
@@ -22,10 +22,12 @@
 #include "I18N.h"
 #include "common/MatchPattern.h"
 #include "common/Convert.h"
+#include "common/NumberFormat.h"
 #include "math/Algorithms.h"
 #include "version/Version.h"
 #include <cstddef>
 #include <algorithm>
+#include <initializer_list>
 using namespace std::string_literals;
 using namespace std::string_view_literals;
 using namespace common;
@@ -34,6 +36,7 @@ namespace {
 using Options = Converter::Options;
 using Serialize = Converter::Callback<Converter::Serialize>;
 using Deserialize = Converter::Callback<Converter::Deserialize>;
+using Signature = ConverterSignature;
 static int toInteger(float value) {
 	return std::max(std::min(static_cast<int>(value * 256), 255), 0);
 }
@@ -66,6 +69,16 @@ inline auto percentage(std::string_view &value) {
 	return sequence(save(number, value), single('%'));
 }
 const auto valueSeparator = oneOrMore(single({',', ';', '\t', ' '}));
+static std::string toDecimals(std::string_view separator, std::initializer_list<float> values) {
+	std::string result;
+	result.reserve(values.size() * (5 + separator.length()));
+	for (auto value: values) {
+		if (!result.empty())
+			result += separator;
+		appendFixed(result, value, 3);
+	}
+	return result;
+}
 static std::string webHexSerialize(const ColorObject &colorObject, const ConverterSerializePosition &position, const Options &options) {
 	char result[8];
 	auto &c = colorObject.getColor();
@@ -222,10 +235,14 @@ static std::string cssRgbaSerialize(const ColorObject &colorObject, const Conver
 		}
 	} else {
 		if (options.cssPercentages) {
-			std::snprintf(result, sizeof(result), "rgba(%d%%, %d%%, %d%%, %0.3f)", toPercentage(c.red), toPercentage(c.green), toPercentage(c.blue), c.alpha);
+			std::snprintf(result, sizeof(result), "rgba(%d%%, %d%%, %d%%, ", toPercentage(c.red), toPercentage(c.green), toPercentage(c.blue));
 		} else {
-			std::snprintf(result, sizeof(result), "rgba(%d, %d, %d, %0.3f)", toInteger(c.red), toInteger(c.green), toInteger(c.blue), c.alpha);
+			std::snprintf(result, sizeof(result), "rgba(%d, %d, %d, ", toInteger(c.red), toInteger(c.green), toInteger(c.blue));
 		}
+		std::string text = result;
+		appendFixed(text, c.alpha, 3);
+		text += ')';
+		return text;
 	}
 	return result;
 }
@@ -267,8 +284,11 @@ static bool cssHslDeserialize(const char *value, ColorObject &colorObject, float
 static std::string cssHslaSerialize(const ColorObject &colorObject, const ConverterSerializePosition &position, const Options &options) {
 	char result[29];
 	auto c = colorObject.getColor().rgbToHsl();
-	std::snprintf(result, sizeof(result), "hsla(%d, %d%%, %d%%, %0.3f)", toDegrees(c.hsl.hue), toPercentage(c.hsl.saturation), toPercentage(c.hsl.lightness), c.alpha);
-	return result;
+	std::snprintf(result, sizeof(result), "hsla(%d, %d%%, %d%%, ", toDegrees(c.hsl.hue), toPercentage(c.hsl.saturation), toPercentage(c.hsl.lightness));
+	std::string text = result;
+	appendFixed(text, c.alpha, 3);
+	text += ')';
+	return text;
 }
 static bool cssHslaDeserialize(const char *value, ColorObject &colorObject, float &quality, const Options &options) {
 	std::string_view hue, saturation, lightness, alpha;
@@ -286,10 +306,8 @@ static bool cssHslaDeserialize(const char *value, ColorObject &colorObject, floa
 	return true;
 }
 static std::string csvRgbSerialize(const ColorObject &colorObject, const ConverterSerializePosition &position, const Options &options) {
-	char result[18];
 	auto &c = colorObject.getColor();
-	std::snprintf(result, sizeof(result), "%0.3f,%0.3f,%0.3f", c.red, c.green, c.blue);
-	return result;
+	return toDecimals(",", { c.red, c.green, c.blue });
 }
 static bool csvRgbDeserialize(const char *value, ColorObject &colorObject, float &quality, const Options &options) {
 	std::string_view red, green, blue;
@@ -306,10 +324,8 @@ static bool csvRgbDeserialize(const char *value, ColorObject &colorObject, float
 	return true;
 }
 static std::string csvRgbTabSerialize(const ColorObject &colorObject, const ConverterSerializePosition &position, const Options &options) {
-	char result[18];
 	auto &c = colorObject.getColor();
-	std::snprintf(result, sizeof(result), "%0.3f\t%0.3f\t%0.3f", c.red, c.green, c.blue);
-	return result;
+	return toDecimals("\t", { c.red, c.green, c.blue });
 }
 static bool csvRgbTabDeserialize(const char *value, ColorObject &colorObject, float &quality, const Options &options) {
 	std::string_view red, green, blue;
@@ -326,10 +342,8 @@ static bool csvRgbTabDeserialize(const char *value, ColorObject &colorObject, fl
 	return true;
 }
 static std::string csvRgbSemicolonSerialize(const ColorObject &colorObject, const ConverterSerializePosition &position, const Options &options) {
-	char result[18];
 	auto &c = colorObject.getColor();
-	std::snprintf(result, sizeof(result), "%0.3f;%0.3f;%0.3f", c.red, c.green, c.blue);
-	return result;
+	return toDecimals(";", { c.red, c.green, c.blue });
 }
 static bool csvRgbSemicolonDeserialize(const char *value, ColorObject &colorObject, float &quality, const Options &options) {
 	std::string_view red, green, blue;
@@ -346,10 +360,8 @@ static bool csvRgbSemicolonDeserialize(const char *value, ColorObject &colorObje
 	return true;
 }
 static std::string csvRgbaSerialize(const ColorObject &colorObject, const ConverterSerializePosition &position, const Options &options) {
-	char result[24];
 	auto &c = colorObject.getColor();
-	std::snprintf(result, sizeof(result), "%0.3f,%0.3f,%0.3f,%0.3f", c.red, c.green, c.blue, c.alpha);
-	return result;
+	return toDecimals(",", { c.red, c.green, c.blue, c.alpha });
 }
 static bool csvRgbaDeserialize(const char *value, ColorObject &colorObject, float &quality, const Options &options) {
 	std::string_view red, green, blue, alpha;
@@ -366,10 +378,8 @@ static bool csvRgbaDeserialize(const char *value, ColorObject &colorObject, floa
 	return true;
 }
 static std::string csvRgbaTabSerialize(const ColorObject &colorObject, const ConverterSerializePosition &position, const Options &options) {
-	char result[24];
 	auto &c = colorObject.getColor();
-	std::snprintf(result, sizeof(result), "%0.3f\t%0.3f\t%0.3f\t%0.3f", c.red, c.green, c.blue, c.alpha);
-	return result;
+	return toDecimals("\t", { c.red, c.green, c.blue, c.alpha });
 }
 static bool csvRgbaTabDeserialize(const char *value, ColorObject &colorObject, float &quality, const Options &options) {
 	std::string_view red, green, blue, alpha;
@@ -386,10 +396,8 @@ static bool csvRgbaTabDeserialize(const char *value, ColorObject &colorObject, f
 	return true;
 }
 static std::string csvRgbaSemicolonSerialize(const ColorObject &colorObject, const ConverterSerializePosition &position, const Options &options) {
-	char result[24];
 	auto &c = colorObject.getColor();
-	std::snprintf(result, sizeof(result), "%0.3f;%0.3f;%0.3f;%0.3f", c.red, c.green, c.blue, c.alpha);
-	return result;
+	return toDecimals(";", { c.red, c.green, c.blue, c.alpha });
 }
 static bool csvRgbaSemicolonDeserialize(const char *value, ColorObject &colorObject, float &quality, const Options &options) {
 	std::string_view red, green, blue, alpha;
@@ -406,10 +414,8 @@ static bool csvRgbaSemicolonDeserialize(const char *value, ColorObject &colorObj
 	return true;
 }
 static std::string valueRgbSerialize(const ColorObject &colorObject, const ConverterSerializePosition &position, const Options &options) {
-	char result[20];
 	auto &c = colorObject.getColor();
-	std::snprintf(result, sizeof(result), "%0.3f, %0.3f, %0.3f", c.red, c.green, c.blue);
-	return result;
+	return toDecimals(", ", { c.red, c.green, c.blue });
 }
 static bool valueRgbDeserialize(const char *value, ColorObject &colorObject, float &quality, const Options &options) {
 	std::string_view red, green, blue;
@@ -426,10 +432,8 @@ static bool valueRgbDeserialize(const char *value, ColorObject &colorObject, flo
 	return true;
 }
 static std::string valueRgbaSerialize(const ColorObject &colorObject, const ConverterSerializePosition &position, const Options &options) {
-	char result[27];
 	auto &c = colorObject.getColor();
-	std::snprintf(result, sizeof(result), "%0.3f, %0.3f, %0.3f, %0.3f", c.red, c.green, c.blue, c.alpha);
-	return result;
+	return toDecimals(", ", { c.red, c.green, c.blue, c.alpha });
 }
 static bool valueRgbaDeserialize(const char *value, ColorObject &colorObject, float &quality, const Options &options) {
 	std::string_view red, green, blue, alpha;
@@ -510,15 +514,15 @@ static std::string cssBlockWithAlphaSerialize(const ColorObject &colorObject, co
 }
 }
 void addInternalConverters(Converters &converters, Converter::Options &options) {
-	converters.add("color_web_hex", _("Web: hex code"), Serialize(webHexSerialize, options), Deserialize(webHexDeserialize, options));
-	converters.add("color_web_hex_with_alpha", _("Web: hex code with alpha"), Serialize(webHexWithAlphaSerialize, options), Deserialize(webHexWithAlphaDeserialize, options));
-	converters.add("color_web_hex_no_hash", _("Web: hex code (no hash symbol)"), Serialize(webHexNoHashSerialize, options), Deserialize(webHexNoHashDeserialize, options));
-	converters.add("color_web_hex_short", _("Web: short hex code"), Serialize(webHexShortSerialize, options), Deserialize(webHexShortDeserialize, options));
-	converters.add("color_web_hex_short_with_alpha", _("Web: short hex code with alpha"), Serialize(webHexShortWithAlphaSerialize, options), Deserialize(webHexShortWithAlphaDeserialize, options));
-	converters.add("color_css_rgb", _("CSS: red green blue"), Serialize(cssRgbSerialize, options), Deserialize(cssRgbDeserialize, options));
-	converters.add("color_css_rgba", _("CSS: red green blue alpha"), Serialize(cssRgbaSerialize, options), Deserialize(cssRgbaDeserialize, options));
-	converters.add("color_css_hsl", _("CSS: hue saturation lightness"), Serialize(cssHslSerialize, options), Deserialize(cssHslDeserialize, options));
-	converters.add("color_css_hsla", _("CSS: hue saturation lightness alpha"), Serialize(cssHslaSerialize, options), Deserialize(cssHslaDeserialize, options));
+	converters.add("color_web_hex", _("Web: hex code"), Serialize(webHexSerialize, options), Deserialize(webHexDeserialize, options), Signature(CharacterClass::hash | CharacterClass::hexDigit));
+	converters.add("color_web_hex_with_alpha", _("Web: hex code with alpha"), Serialize(webHexWithAlphaSerialize, options), Deserialize(webHexWithAlphaDeserialize, options), Signature(CharacterClass::hash | CharacterClass::hexDigit));
+	converters.add("color_web_hex_no_hash", _("Web: hex code (no hash symbol)"), Serialize(webHexNoHashSerialize, options), Deserialize(webHexNoHashDeserialize, options), Signature(CharacterClass::hexDigit));
+	converters.add("color_web_hex_short", _("Web: short hex code"), Serialize(webHexShortSerialize, options), Deserialize(webHexShortDeserialize, options), Signature(CharacterClass::hash | CharacterClass::hexDigit));
+	converters.add("color_web_hex_short_with_alpha", _("Web: short hex code with alpha"), Serialize(webHexShortWithAlphaSerialize, options), Deserialize(webHexShortWithAlphaDeserialize, options), Signature(CharacterClass::hash | CharacterClass::hexDigit));
+	converters.add("color_css_rgb", _("CSS: red green blue"), Serialize(cssRgbSerialize, options), Deserialize(cssRgbDeserialize, options), Signature(CharacterClass::digit | CharacterClass::parenthesis, { "rgb(" }));
+	converters.add("color_css_rgba", _("CSS: red green blue alpha"), Serialize(cssRgbaSerialize, options), Deserialize(cssRgbaDeserialize, options), Signature(CharacterClass::digit | CharacterClass::parenthesis, { "rgba(" }));
+	converters.add("color_css_hsl", _("CSS: hue saturation lightness"), Serialize(cssHslSerialize, options), Deserialize(cssHslDeserialize, options), Signature(CharacterClass::digit | CharacterClass::percent, { "hsl(" }));
+	converters.add("color_css_hsla", _("CSS: hue saturation lightness alpha"), Serialize(cssHslaSerialize, options), Deserialize(cssHslaDeserialize, options), Signature(CharacterClass::digit | CharacterClass::percent, { "hsla(" }));
 	converters.add("css_color_hex", "CSS(color)", Serialize(cssColorHexSerialize, options), Deserialize());
 	converters.add("css_background_color_hex", "CSS(background-color)", Serialize(cssBackgroundColorHexSerialize, options), Deserialize());
 	converters.add("css_border_color_hex", "CSS(border-color)", Serialize(cssBorderColorHexSerialize, options), Deserialize());
@@ -528,12 +532,12 @@ void addInternalConverters(Converters &converters, Converter::Options &options)
 	converters.add("css_border_left_hex", "CSS(border-left-color)", Serialize(cssBorderLeftColorHexSerialize, options), Deserialize());
 	converters.add("color_css_block", _("CSS block"), Serialize(cssBlockSerialize, options), Deserialize());
 	converters.add("color_css_block_with_alpha", _("CSS block with alpha"), Serialize(cssBlockWithAlphaSerialize, options), Deserialize());
-	converters.add("csv_rgb", "CSV RGB", Serialize(csvRgbSerialize, options), Deserialize(csvRgbDeserialize, options));
-	converters.add("csv_rgb_tab", "CSV RGB "s + _("(tab separator)"), Serialize(csvRgbTabSerialize, options), Deserialize(csvRgbTabDeserialize, options));
-	converters.add("csv_rgb_semicolon", "CSV RGB "s + _("(semicolon separator)"), Serialize(csvRgbSemicolonSerialize, options), Deserialize(csvRgbSemicolonDeserialize, options));
-	converters.add("csv_rgba", "CSV RGBA", Serialize(csvRgbaSerialize, options), Deserialize(csvRgbaDeserialize, options));
-	converters.add("csv_rgba_tab", "CSV RGBA "s + _("(tab separator)"), Serialize(csvRgbaTabSerialize, options), Deserialize(csvRgbaTabDeserialize, options));
-	converters.add("csv_rgba_semicolon", "CSV RGBA "s + _("(semicolon separator)"), Serialize(csvRgbaSemicolonSerialize, options), Deserialize(csvRgbaSemicolonDeserialize, options));
-	converters.add("value_rgb", _("RGB values"), Serialize(valueRgbSerialize, options), Deserialize(valueRgbDeserialize, options));
-	converters.add("value_rgba", _("RGBA values"), Serialize(valueRgbaSerialize, options), Deserialize(valueRgbaDeserialize, options));
+	converters.add("csv_rgb", "CSV RGB", Serialize(csvRgbSerialize, options), Deserialize(csvRgbDeserialize, options), Signature(CharacterClass::digit | CharacterClass::comma));
+	converters.add("csv_rgb_tab", "CSV RGB "s + _("(tab separator)"), Serialize(csvRgbTabSerialize, options), Deserialize(csvRgbTabDeserialize, options), Signature(CharacterClass::digit | CharacterClass::tab));
+	converters.add("csv_rgb_semicolon", "CSV RGB "s + _("(semicolon separator)"), Serialize(csvRgbSemicolonSerialize, options), Deserialize(csvRgbSemicolonDeserialize, options), Signature(CharacterClass::digit | CharacterClass::semicolon));
+	converters.add("csv_rgba", "CSV RGBA", Serialize(csvRgbaSerialize, options), Deserialize(csvRgbaDeserialize, options), Signature(CharacterClass::digit | CharacterClass::comma));
+	converters.add("csv_rgba_tab", "CSV RGBA "s + _("(tab separator)"), Serialize(csvRgbaTabSerialize, options), Deserialize(csvRgbaTabDeserialize, options), Signature(CharacterClass::digit | CharacterClass::tab));
+	converters.add("csv_rgba_semicolon", "CSV RGBA "s + _("(semicolon separator)"), Serialize(csvRgbaSemicolonSerialize, options), Deserialize(csvRgbaSemicolonDeserialize, options), Signature(CharacterClass::digit | CharacterClass::semicolon));
+	converters.add("value_rgb", _("RGB values"), Serialize(valueRgbSerialize, options), Deserialize(valueRgbDeserialize, options), Signature(CharacterClass::digit));
+	converters.add("value_rgba", _("RGBA values"), Serialize(valueRgbaSerialize, options), Deserialize(valueRgbaDeserialize, options), Signature(CharacterClass::digit));
 }
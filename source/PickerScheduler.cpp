@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "PickerScheduler.h"
+#include <algorithm>
+namespace {
+// Time without changes after which scheduler switches to idle rate.
+const gint64 idleDelay = 300000;
+const int idleRefreshRate = 10;
+const float averagingFactor = 0.1f;
+}
+PickerScheduler::PickerScheduler(GtkWidget *widget, std::function<bool()> update):
+	m_widget(widget),
+	m_update(update),
+	m_tickId(0),
+	m_timeoutId(0),
+	m_refreshRate(30),
+	m_running(false),
+	m_idle(false),
+	m_lastUpdate(0),
+	m_lastChange(0),
+	m_statisticsStart(0),
+	m_frames(0),
+	m_statistics() {
+}
+PickerScheduler::~PickerScheduler() {
+	stop();
+}
+void PickerScheduler::start(int refreshRate) {
+	stop();
+	m_refreshRate = std::max(1, refreshRate);
+	m_running = true;
+	m_lastChange = m_statisticsStart = g_get_monotonic_time();
+	m_frames = 0;
+	m_statistics.framesPerSecond = 0;
+	m_idle = true;
+	setIdle(false);
+}
+void PickerScheduler::stop() {
+	removeSources();
+	m_running = false;
+}
+bool PickerScheduler::running() const {
+	return m_running;
+}
+void PickerScheduler::removeSources() {
+#if GTK_MAJOR_VERSION >= 3
+	if (m_tickId > 0) {
+		gtk_widget_remove_tick_callback(m_widget, m_tickId);
+		m_tickId = 0;
+	}
+#endif
+	if (m_timeoutId > 0) {
+		g_source_remove(m_timeoutId);
+		m_timeoutId = 0;
+	}
+}
+void PickerScheduler::setIdle(bool idle) {
+	if (m_idle == idle)
+		return;
+	m_idle = idle;
+	removeSources();
+	if (idle) {
+		m_timeoutId = g_timeout_add_full(G_PRIORITY_DEFAULT_IDLE, 1000 / idleRefreshRate, (GSourceFunc)onTimeout, this, (GDestroyNotify)nullptr);
+		return;
+	}
+#if GTK_MAJOR_VERSION >= 3
+	m_tickId = gtk_widget_add_tick_callback(m_widget, (GtkTickCallback)onTick, this, nullptr);
+#else
+	m_timeoutId = g_timeout_add_full(G_PRIORITY_DEFAULT_IDLE, 1000 / m_refreshRate, (GSourceFunc)onTimeout, this, (GDestroyNotify)nullptr);
+#endif
+}
+void PickerScheduler::update(gint64 now) {
+	m_lastUpdate = now;
+	if (m_update()) {
+		m_lastChange = now;
+		++m_frames;
+		setIdle(false);
+	} else if (!m_idle && now - m_lastChange > idleDelay) {
+		setIdle(true);
+	}
+	if (now - m_statisticsStart >= 1000000) {
+		m_statistics.framesPerSecond = static_cast<float>(m_frames * 1000000.0 / (now - m_statisticsStart));
+		m_statisticsStart = now;
+		m_frames = 0;
+	}
+}
+void PickerScheduler::addStageTimes(int64_t capture, int64_t sample, int64_t display) {
+	m_statistics.captureTime += (capture / 1000.0f - m_statistics.captureTime) * averagingFactor;
+	m_statistics.sampleTime += (sample / 1000.0f - m_statistics.sampleTime) * averagingFactor;
+	m_statistics.displayTime += (display / 1000.0f - m_statistics.displayTime) * averagingFactor;
+}
+const PickerScheduler::Statistics &PickerScheduler::statistics() const {
+	return m_statistics;
+}
+#if GTK_MAJOR_VERSION >= 3
+gboolean PickerScheduler::onTick(GtkWidget *, GdkFrameClock *frameClock, PickerScheduler *scheduler) {
+	gint64 now = gdk_frame_clock_get_frame_time(frameClock);
+	// Refresh rate is an upper limit, frames are skipped when monitor refresh rate is higher. Small tolerance avoids skipping frames due to jitter.
+	gint64 interval = 1000000 / scheduler->m_refreshRate;
+	gint64 tolerance = std::min<gint64>(interval / 2, 4000);
+	if (now - scheduler->m_lastUpdate + tolerance < interval)
+		return G_SOURCE_CONTINUE;
+	scheduler->update(now);
+	return G_SOURCE_CONTINUE;
+}
+#endif
+gboolean PickerScheduler::onTimeout(PickerScheduler *scheduler) {
+	scheduler->update(g_get_monotonic_time());
+	return G_SOURCE_CONTINUE;
+}
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef GPICK_PICKER_SCHEDULER_H_
+#define GPICK_PICKER_SCHEDULER_H_
+#include <gtk/gtk.h>
+#include <cstdint>
+#include <functional>
+/**
+ * Schedules picker updates.
+ * On GTK3 updates are driven by widget frame clock, with refresh rate used as upper limit, otherwise a timer is used.
+ * When updates stop reporting changes, scheduler backs off to a low idle rate until next change.
+ */
+struct PickerScheduler {
+	struct Statistics {
+		float framesPerSecond;
+		// Average stage durations in milliseconds.
+		float captureTime, sampleTime, displayTime;
+	};
+	/**
+	 * @param[in] widget Widget which frame clock is used.
+	 * @param[in] update Update callback. Returns true if something changed.
+	 */
+	PickerScheduler(GtkWidget *widget, std::function<bool()> update);
+	PickerScheduler(const PickerScheduler &) = delete;
+	PickerScheduler &operator=(const PickerScheduler &) = delete;
+	~PickerScheduler();
+	void start(int refreshRate);
+	void stop();
+	bool running() const;
+	/**
+	 * Record durations of a single update stages in microseconds.
+	 */
+	void addStageTimes(int64_t capture, int64_t sample, int64_t display);
+	const Statistics &statistics() const;
+private:
+	GtkWidget *m_widget;
+	std::function<bool()> m_update;
+	guint m_tickId, m_timeoutId;
+	int m_refreshRate;
+	bool m_running, m_idle;
+	gint64 m_lastUpdate, m_lastChange, m_statisticsStart;
+	int m_frames;
+	Statistics m_statistics;
+	void setIdle(bool idle);
+	void removeSources();
+	void update(gint64 now);
+#if GTK_MAJOR_VERSION >= 3
+	static gboolean onTick(GtkWidget *widget, GdkFrameClock *frameClock, PickerScheduler *scheduler);
+#endif
+	static gboolean onTimeout(PickerScheduler *scheduler);
+};
+#endif /* GPICK_PICKER_SCHEDULER_H_ */
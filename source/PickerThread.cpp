@@ -0,0 +1,499 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "PickerThread.h"
+#include "common/TripleBuffer.h"
+#include <gtk/gtk.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#if defined(GPICK_XSHM) && defined(GDK_WINDOWING_X11)
+#include <gdk/gdkx.h>
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <X11/extensions/XShm.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#define GPICK_PICKER_THREAD
+#ifdef GPICK_XDAMAGE
+#include <X11/extensions/Xdamage.h>
+#define GPICK_PICKER_THREAD_XDAMAGE
+#endif
+#endif
+cairo_surface_t *PickerFrame::createSurface() const {
+	auto data = reinterpret_cast<unsigned char *>(const_cast<uint32_t *>(pixels.data()));
+	int width = captureRect.getWidth();
+	return cairo_image_surface_create_for_data(data, CAIRO_FORMAT_RGB24, width, captureRect.getHeight(), width * 4);
+}
+#ifdef GPICK_PICKER_THREAD
+namespace {
+// Xlib image capture using a connection owned by picker thread. Shared memory is used for local displays only, as attaching to remote server reports asynchronous errors to process wide error handler.
+struct Capture {
+	Capture(Display *display, int screenNumber):
+		m_display(display),
+		m_root(RootWindow(display, screenNumber)),
+		m_visual(DefaultVisual(display, screenNumber)),
+		m_depth(DefaultDepth(display, screenNumber)),
+		m_image(nullptr),
+		m_segmentSize(0),
+		m_width(0),
+		m_height(0) {
+		m_segment.shmaddr = nullptr;
+		m_segment.shmid = -1;
+		m_segment.readOnly = False;
+		const char *name = DisplayString(display);
+		m_useSharedMemory = name && (name[0] == ':' || std::strncmp(name, "unix:", 5) == 0) && XShmQueryExtension(display);
+	}
+	~Capture() {
+		releaseImage();
+		if (m_segment.shmaddr) {
+			XShmDetach(m_display, &m_segment);
+			XSync(m_display, False);
+			shmdt(m_segment.shmaddr);
+		}
+	}
+	bool supported() const {
+		const uint16_t byteOrderTest = 1;
+		int nativeByteOrder = *reinterpret_cast<const uint8_t *>(&byteOrderTest) ? LSBFirst : MSBFirst;
+		return (m_depth == 24 || m_depth == 32) && m_visual->red_mask == 0xff0000 && m_visual->green_mask == 0xff00 && m_visual->blue_mask == 0xff && ImageByteOrder(m_display) == nativeByteOrder;
+	}
+	bool capture(const math::Rectangle<int> &rect, std::vector<uint32_t> &pixels) {
+		int width = rect.getWidth(), height = rect.getHeight();
+		pixels.resize(static_cast<size_t>(width) * height);
+		XImage *image;
+		if (m_useSharedMemory) {
+			if (!prepare(width, height))
+				return false;
+			if (!XShmGetImage(m_display, m_root, m_image, rect.getX(), rect.getY(), AllPlanes))
+				return false;
+			image = m_image;
+		} else {
+			image = XGetImage(m_display, m_root, rect.getX(), rect.getY(), width, height, AllPlanes, ZPixmap);
+			if (!image)
+				return false;
+			if (image->bits_per_pixel != 32) {
+				XDestroyImage(image);
+				return false;
+			}
+		}
+		for (int y = 0; y < height; ++y)
+			std::memcpy(&pixels[static_cast<size_t>(y) * width], image->data + static_cast<size_t>(y) * image->bytes_per_line, width * 4);
+		if (image != m_image)
+			XDestroyImage(image);
+		return true;
+	}
+private:
+	Display *m_display;
+	Window m_root;
+	Visual *m_visual;
+	int m_depth;
+	XShmSegmentInfo m_segment;
+	XImage *m_image;
+	size_t m_segmentSize;
+	int m_width, m_height;
+	bool m_useSharedMemory;
+	bool prepare(int width, int height) {
+		if (m_image && m_width == width && m_height == height)
+			return true;
+		releaseImage();
+		m_image = XShmCreateImage(m_display, m_visual, m_depth, ZPixmap, nullptr, &m_segment, width, height);
+		if (!m_image || m_image->bits_per_pixel != 32)
+			return false;
+		size_t size = static_cast<size_t>(m_image->bytes_per_line) * height;
+		if (size > m_segmentSize && !attachSegment(size))
+			return false;
+		m_image->data = m_segment.shmaddr;
+		m_width = width;
+		m_height = height;
+		return true;
+	}
+	bool attachSegment(size_t size) {
+		if (m_segment.shmaddr) {
+			XShmDetach(m_display, &m_segment);
+			XSync(m_display, False);
+			shmdt(m_segment.shmaddr);
+			m_segment.shmaddr = nullptr;
+			m_segmentSize = 0;
+		}
+		size = (size / (150 * 150 * 4) + 1) * (150 * 150 * 4);
+		m_segment.shmid = shmget(IPC_PRIVATE, size, IPC_CREAT | 0600);
+		if (m_segment.shmid < 0)
+			return false;
+		m_segment.shmaddr = reinterpret_cast<char *>(shmat(m_segment.shmid, nullptr, 0));
+		shmctl(m_segment.shmid, IPC_RMID, nullptr);
+		if (m_segment.shmaddr == reinterpret_cast<char *>(-1)) {
+			m_segment.shmaddr = nullptr;
+			return false;
+		}
+		if (!XShmAttach(m_display, &m_segment)) {
+			shmdt(m_segment.shmaddr);
+			m_segment.shmaddr = nullptr;
+			return false;
+		}
+		XSync(m_display, False);
+		m_segmentSize = size;
+		return true;
+	}
+	void releaseImage() {
+		if (m_image) {
+			m_image->data = nullptr;
+			XDestroyImage(m_image);
+			m_image = nullptr;
+		}
+		m_width = m_height = 0;
+	}
+};
+// Xlib error handler is process wide, so errors on picker thread connections are recorded and all other errors are passed to previously installed handler.
+struct ErrorTrap {
+	ErrorTrap(Display *display):
+		m_display(display),
+		m_failed(false) {
+		auto &handlers = Handlers::get();
+		std::lock_guard<std::mutex> lock(handlers.mutex);
+		if (!handlers.installed) {
+			handlers.previousHandler = XSetErrorHandler(onError);
+			handlers.installed = true;
+		}
+		handlers.traps.push_back(this);
+	}
+	~ErrorTrap() {
+		auto &handlers = Handlers::get();
+		std::lock_guard<std::mutex> lock(handlers.mutex);
+		handlers.traps.erase(std::remove(handlers.traps.begin(), handlers.traps.end(), this), handlers.traps.end());
+	}
+	bool failed() const {
+		return m_failed;
+	}
+private:
+	struct Handlers {
+		std::mutex mutex;
+		std::vector<ErrorTrap *> traps;
+		XErrorHandler previousHandler = nullptr;
+		bool installed = false;
+		static Handlers &get() {
+			static Handlers handlers;
+			return handlers;
+		}
+	};
+	Display *m_display;
+	std::atomic_bool m_failed;
+	static int onError(Display *display, XErrorEvent *event) {
+		auto &handlers = Handlers::get();
+		XErrorHandler previousHandler;
+		{
+			std::lock_guard<std::mutex> lock(handlers.mutex);
+			for (auto *trap: handlers.traps) {
+				if (trap->m_display == display) {
+					trap->m_failed = true;
+					return 0;
+				}
+			}
+			previousHandler = handlers.previousHandler;
+		}
+		return previousHandler ? previousHandler(display, event) : 0;
+	}
+};
+#ifdef GPICK_PICKER_THREAD_XDAMAGE
+// Root window damage tracking on picker thread connection. Events are read by picker thread itself, so main loop is not involved.
+struct DamageTracker {
+	DamageTracker(Display *display, int screenNumber):
+		m_display(display),
+		m_damage(0),
+		m_eventBase(0) {
+		int errorBase;
+		if (XDamageQueryExtension(display, &m_eventBase, &errorBase))
+			m_damage = XDamageCreate(display, RootWindow(display, screenNumber), XDamageReportBoundingBox);
+	}
+	~DamageTracker() {
+		if (m_damage)
+			XDamageDestroy(m_display, m_damage);
+	}
+	bool supported() const {
+		return m_damage != 0;
+	}
+	// Process queued damage notifications and check if any of them touched specified area.
+	bool damaged(const math::Rectangle<int> &area) {
+		bool damaged = false;
+		while (XPending(m_display)) {
+			XEvent event;
+			XNextEvent(m_display, &event);
+			if (event.type != m_eventBase + XDamageNotify)
+				continue;
+			auto &damageEvent = reinterpret_cast<XDamageNotifyEvent &>(event);
+			const auto &rect = damageEvent.area;
+			if (area.intersects(math::Rectangle<int>(rect.x, rect.y, rect.x + rect.width, rect.y + rect.height)))
+				damaged = true;
+			// Bounding box reporting sends a new notification only after damage is subtracted.
+			XDamageSubtract(m_display, m_damage, None, None);
+		}
+		return damaged;
+	}
+private:
+	Display *m_display;
+	Damage m_damage;
+	int m_eventBase;
+};
+#endif
+}
+struct PickerThread::Impl {
+	Impl(Display *display, GdkScreen *screen, const Settings &settings):
+		m_display(display),
+		m_errorTrap(display),
+		m_screen(screen),
+		m_screenNumber(gdk_screen_get_number(screen)),
+		m_settings(settings),
+		m_settingsChanged(true),
+		m_monitorsChanged(false),
+		m_requested(false),
+		m_forcePublish(false),
+		m_stop(false),
+		m_failed(false) {
+		m_monitors = readMonitors(screen);
+		m_monitorsChangedHandler = g_signal_connect(G_OBJECT(screen), "monitors-changed", G_CALLBACK(onMonitorsChanged), this);
+	}
+	~Impl() {
+		g_signal_handler_disconnect(m_screen, m_monitorsChangedHandler);
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stop = true;
+		}
+		m_wakeUp.notify_all();
+		if (m_thread.joinable())
+			m_thread.join();
+		XSync(m_display, False);
+		XCloseDisplay(m_display);
+	}
+	void start() {
+		m_thread = std::thread(&Impl::run, this);
+	}
+	void configure(const Settings &settings) {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_settings = settings;
+		m_settingsChanged = true;
+	}
+	void request(bool forcePublish) {
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_requested = true;
+			m_forcePublish = m_forcePublish || forcePublish;
+		}
+		m_wakeUp.notify_all();
+	}
+	static std::vector<math::Rectangle<int>> readMonitors(GdkScreen *screen) {
+		std::vector<math::Rectangle<int>> monitors;
+		for (int i = 0, count = gdk_screen_get_n_monitors(screen); i < count; ++i) {
+			GdkRectangle geometry;
+			gdk_screen_get_monitor_geometry(screen, i, &geometry);
+			monitors.emplace_back(geometry.x, geometry.y, geometry.x + geometry.width, geometry.y + geometry.height);
+		}
+		if (monitors.empty())
+			monitors.emplace_back(0, 0, gdk_screen_get_width(screen), gdk_screen_get_height(screen));
+		return monitors;
+	}
+	static void onMonitorsChanged(GdkScreen *screen, Impl *impl) {
+		auto monitors = readMonitors(screen);
+		std::lock_guard<std::mutex> lock(impl->m_mutex);
+		impl->m_pendingMonitors = std::move(monitors);
+		impl->m_monitorsChanged = true;
+	}
+	void run() {
+		Capture capture(m_display, m_screenNumber);
+		if (!capture.supported()) {
+			m_failed = true;
+			return;
+		}
+#ifdef GPICK_PICKER_THREAD_XDAMAGE
+		DamageTracker damageTracker(m_display, m_screenNumber);
+		XSync(m_display, False);
+		m_damageTracker = damageTracker.supported() && !m_errorTrap.failed() ? &damageTracker : nullptr;
+#endif
+		Sampler *sampler = sampler_new(nullptr);
+		Settings settings;
+		std::unique_lock<std::mutex> lock(m_mutex);
+		for (;;) {
+			m_wakeUp.wait(lock, [this] {
+				return m_stop || m_requested;
+			});
+			if (m_stop)
+				break;
+			bool forcePublish = m_forcePublish;
+			m_requested = m_forcePublish = false;
+			if (m_settingsChanged) {
+				settings = m_settings;
+				m_settingsChanged = false;
+				sampler_set_oversample(sampler, settings.oversample);
+				sampler_set_falloff(sampler, settings.falloff);
+				sampler_set_linear_light(sampler, settings.linearLight);
+				forcePublish = true;
+			}
+			if (m_monitorsChanged) {
+				m_monitors.swap(m_pendingMonitors);
+				m_monitorsChanged = false;
+				forcePublish = true;
+			}
+			lock.unlock();
+			bool succeeded = step(capture, sampler, settings, forcePublish);
+			lock.lock();
+			if (!succeeded || m_errorTrap.failed()) {
+				m_failed = true;
+				break;
+			}
+		}
+		sampler_destroy(sampler);
+#ifdef GPICK_PICKER_THREAD_XDAMAGE
+		m_damageTracker = nullptr;
+#endif
+	}
+	bool step(Capture &capture, Sampler *sampler, const Settings &settings, bool forcePublish) {
+		Window root = RootWindow(m_display, m_screenNumber), rootReturn, childReturn;
+		int x, y, windowX, windowY;
+		unsigned int mask;
+		if (!XQueryPointer(m_display, root, &rootReturn, &childReturn, &x, &y, &windowX, &windowY, &mask))
+			return true; // Pointer is on another screen.
+		math::Vector2i pointer(x, y);
+		math::Rectangle<int> screenRect = m_monitors.front();
+		for (const auto &monitor: m_monitors) {
+			if (monitor.isInside(x, y)) {
+				screenRect = monitor;
+				break;
+			}
+		}
+		math::Rectangle<int> samplerRect, zoomedRect;
+		sampler_get_screen_rect(sampler, pointer, screenRect, &samplerRect);
+		if (settings.zoomedAreaSize > 0) {
+			int size = settings.zoomedAreaSize;
+			zoomedRect = screenRect.positionInside(math::Rectangle<int>(x - size / 2, y - size / 2, x + (size - size / 2), y + (size - size / 2)));
+		}
+		math::Rectangle<int> captureRect = samplerRect + zoomedRect;
+		// Screen contents are captured again only when captured area was damaged or has become stale, like in ScreenReader.
+		auto startTime = std::chrono::steady_clock::now();
+		bool damaged = true;
+#ifdef GPICK_PICKER_THREAD_XDAMAGE
+		if (m_damageTracker)
+			damaged = m_damageTracker->damaged(captureRect);
+#endif
+		bool stale = startTime - m_lastCaptureTime >= std::chrono::milliseconds(settings.maxStaleness);
+		bool captureNeeded = forcePublish || damaged || stale || captureRect != m_lastCaptureRect || m_lastPixels.empty();
+		if (!captureNeeded && pointer == m_lastPointer)
+			return true;
+		const std::vector<uint32_t> *pixels = &m_lastPixels;
+		if (captureNeeded) {
+			if (!capture.capture(captureRect, m_pixels) || m_errorTrap.failed())
+				return false;
+			m_lastCaptureTime = startTime;
+			if (!forcePublish && pointer == m_lastPointer && captureRect == m_lastCaptureRect && m_pixels == m_lastPixels)
+				return true;
+			pixels = &m_pixels;
+		}
+		auto captureTime = std::chrono::steady_clock::now();
+		auto &frame = m_frames.writeBuffer();
+		frame.pointer = pointer;
+		frame.screenRect = screenRect;
+		frame.captureRect = captureRect;
+		frame.zoomedRect = zoomedRect;
+		frame.pixels = *pixels;
+		math::Vector2i offset = samplerRect.position() - captureRect.position();
+		sampler_get_color_sample_from_data(sampler, reinterpret_cast<const unsigned char *>(frame.pixels.data()), captureRect.getWidth() * 4, pointer, screenRect, offset, &frame.color);
+		frame.captureTime = std::chrono::duration_cast<std::chrono::microseconds>(captureTime - startTime).count();
+		frame.sampleTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - captureTime).count();
+		m_frames.publish();
+		m_lastPointer = pointer;
+		m_lastCaptureRect = captureRect;
+		if (captureNeeded)
+			m_lastPixels.swap(m_pixels);
+		return true;
+	}
+	Display *m_display;
+	ErrorTrap m_errorTrap;
+	GdkScreen *m_screen;
+	int m_screenNumber;
+	gulong m_monitorsChangedHandler;
+	std::vector<math::Rectangle<int>> m_monitors, m_pendingMonitors;
+	std::thread m_thread;
+	std::mutex m_mutex;
+	std::condition_variable m_wakeUp;
+	Settings m_settings;
+	bool m_settingsChanged, m_monitorsChanged, m_requested, m_forcePublish, m_stop;
+	std::atomic_bool m_failed;
+	common::TripleBuffer<PickerFrame> m_frames;
+	std::vector<uint32_t> m_pixels, m_lastPixels;
+	math::Vector2i m_lastPointer;
+	math::Rectangle<int> m_lastCaptureRect;
+	std::chrono::steady_clock::time_point m_lastCaptureTime;
+#ifdef GPICK_PICKER_THREAD_XDAMAGE
+	DamageTracker *m_damageTracker = nullptr;
+#endif
+};
+std::unique_ptr<PickerThread> PickerThread::start(GdkScreen *screen, const Settings &settings) {
+	GdkDisplay *gdkDisplay = gdk_screen_get_display(screen);
+#if GTK_MAJOR_VERSION >= 3
+	if (!GDK_IS_X11_DISPLAY(gdkDisplay))
+		return nullptr;
+#endif
+	Display *display = XOpenDisplay(DisplayString(GDK_DISPLAY_XDISPLAY(gdkDisplay)));
+	if (!display)
+		return nullptr;
+	auto impl = std::make_unique<Impl>(display, screen, settings);
+	impl->start();
+	return std::unique_ptr<PickerThread>(new PickerThread(std::move(impl)));
+}
+void PickerThread::configure(const Settings &settings) {
+	m_impl->configure(settings);
+}
+void PickerThread::request(bool forcePublish) {
+	m_impl->request(forcePublish);
+}
+bool PickerThread::consume() {
+	return m_impl->m_frames.consume();
+}
+const PickerFrame &PickerThread::frame() const {
+	return m_impl->m_frames.readBuffer();
+}
+bool PickerThread::failed() const {
+	return m_impl->m_failed;
+}
+#else
+struct PickerThread::Impl {
+	common::TripleBuffer<PickerFrame> m_frames;
+};
+std::unique_ptr<PickerThread> PickerThread::start(GdkScreen *, const Settings &) {
+	return nullptr;
+}
+void PickerThread::configure(const Settings &) {
+}
+void PickerThread::request(bool) {
+}
+bool PickerThread::consume() {
+	return false;
+}
+const PickerFrame &PickerThread::frame() const {
+	return m_impl->m_frames.readBuffer();
+}
+bool PickerThread::failed() const {
+	return true;
+}
+#endif
+PickerThread::PickerThread(std::unique_ptr<Impl> impl):
+	m_impl(std::move(impl)) {
+}
+PickerThread::~PickerThread() {
+}
@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef GPICK_PICKER_THREAD_H_
+#define GPICK_PICKER_THREAD_H_
+#include "Color.h"
+#include "Sampler.h"
+#include "math/Rectangle.h"
+#include "math/Vector.h"
+#include <gdk/gdk.h>
+#include <cairo/cairo.h>
+#include <cstdint>
+#include <memory>
+#include <vector>
+/**
+ * Screen area captured and sampled by picker thread.
+ */
+struct PickerFrame {
+	math::Vector2i pointer;
+	math::Rectangle<int> screenRect, captureRect, zoomedRect;
+	Color color;
+	std::vector<uint32_t> pixels;
+	int64_t captureTime, sampleTime; // Microseconds spent capturing and sampling frame.
+	/**
+	 * Create cairo surface using frame pixels. Surface must be destroyed before frame is consumed again.
+	 */
+	cairo_surface_t *createSurface() const;
+};
+/**
+ * Captures screen around pointer and samples color on a separate thread using a dedicated X11 connection.
+ * Capture is done only when requested by main thread, so update rate follows picker scheduler. Requested capture is skipped when captured area was not damaged and is not older than max staleness.
+ * X errors on picker thread connection stop the thread, so picker can fall back to capturing on main thread.
+ * Frames are passed to main thread through triple buffer, so main thread always gets the latest frame without blocking.
+ */
+struct PickerThread {
+	struct Settings {
+		int oversample;
+		SamplerFalloff falloff;
+		bool linearLight;
+		int zoomedAreaSize;
+		int maxStaleness; // Milliseconds after which unchanged screen area is captured again.
+	};
+	/**
+	 * Start picker thread for specified screen.
+	 * @return Picker thread or nullptr when capturing outside main thread is not supported.
+	 */
+	static std::unique_ptr<PickerThread> start(GdkScreen *screen, const Settings &settings);
+	~PickerThread();
+	void configure(const Settings &settings);
+	/**
+	 * Wake picker thread to capture a single frame. Frame is published only if something changed since previous frame.
+	 * @param[in] forcePublish Publish frame even if nothing changed.
+	 */
+	void request(bool forcePublish = false);
+	/**
+	 * Take latest frame published by picker thread.
+	 * @return True if new frame is available.
+	 */
+	bool consume();
+	const PickerFrame &frame() const;
+	/**
+	 * @return True if picker thread stopped because of capture failure. Picker should fall back to capturing on main thread.
+	 */
+	bool failed() const;
+	struct Impl;
+private:
+	std::unique_ptr<Impl> m_impl;
+	PickerThread(std::unique_ptr<Impl> impl);
+};
+#endif /* GPICK_PICKER_THREAD_H_ */
@@ -18,7 +18,11 @@
 
 #include "Sampler.h"
 #include "ScreenReader.h"
+#include <algorithm>
+#include <array>
 #include <cmath>
+#include <cstdint>
+#include <vector>
 #include <gdk/gdk.h>
 
 struct Sampler {
@@ -26,7 +30,30 @@ struct Sampler {
 	SamplerFalloff falloff;
 	float (*falloff_fnc)(float distance);
 	ScreenReader *screen_reader;
+	// Fixed point falloff weights for every pixel in (2 * oversample + 1)^2 area. Empty when falloff is none, as all weights are equal.
+	std::vector<uint32_t> kernel;
+	bool kernelValid;
+	bool linearLight;
 };
+// Weights are stored with 12 fractional bits: at maximum oversample accumulated sums still fit into 64 bits.
+static const int kernelPrecision = 12;
+// Channel byte to 16 bit fixed point value lookup tables, one for gamma encoded and one for linear light averaging.
+using ChannelTable = std::array<uint32_t, 256>;
+static const ChannelTable &channelTable(bool linearLight) {
+	static const ChannelTable gammaTable = []() {
+		ChannelTable table;
+		for (size_t i = 0; i < table.size(); ++i)
+			table[i] = static_cast<uint32_t>(i * 257);
+		return table;
+	}();
+	static const ChannelTable linearTable = []() {
+		ChannelTable table;
+		for (size_t i = 0; i < table.size(); ++i)
+			table[i] = static_cast<uint32_t>(std::lround(Color(static_cast<float>(i / 255.0)).linearRgb().red * 65535));
+		return table;
+	}();
+	return linearLight ? linearTable : gammaTable;
+}
 static float sampler_falloff_none(float distance) {
 	return 1;
 }
@@ -45,6 +72,8 @@ static float sampler_falloff_exponential(float distance) {
 struct Sampler *sampler_new(ScreenReader *screen_reader) {
 	Sampler *sampler = new Sampler;
 	sampler->oversample = 0;
+	sampler->kernelValid = false;
+	sampler->linearLight = false;
 	sampler_set_falloff(sampler, SamplerFalloff::none);
 	sampler->screen_reader = screen_reader;
 	return sampler;
@@ -54,6 +83,7 @@ void sampler_destroy(Sampler *sampler) {
 }
 void sampler_set_falloff(Sampler *sampler, SamplerFalloff falloff) {
 	sampler->falloff = falloff;
+	sampler->kernelValid = false;
 	switch (falloff) {
 	case SamplerFalloff::none:
 		sampler->falloff_fnc = sampler_falloff_none;
@@ -75,49 +105,89 @@ void sampler_set_falloff(Sampler *sampler, SamplerFalloff falloff) {
 	}
 }
 void sampler_set_oversample(Sampler *sampler, int oversample) {
+	oversample = math::clamp(oversample, 0, sampler_max_oversample);
+	if (sampler->oversample != oversample)
+		sampler->kernelValid = false;
 	sampler->oversample = oversample;
 }
-static void getPixel(unsigned char *data, int stride, int x, int y, Color *color) {
-	unsigned char *p;
-	p = data + y * stride + x * 4;
-	color->rgb.red = p[2] * (1 / 255.0f);
-	color->rgb.green = p[1] * (1 / 255.0f);
-	color->rgb.blue = p[0] * (1 / 255.0f);
+void sampler_set_linear_light(Sampler *sampler, bool linearLight) {
+	sampler->linearLight = linearLight;
+}
+bool sampler_get_linear_light(Sampler *sampler) {
+	return sampler->linearLight;
+}
+static void updateKernel(Sampler *sampler) {
+	sampler->kernelValid = true;
+	sampler->kernel.clear();
+	if (sampler->oversample == 0 || sampler->falloff == SamplerFalloff::none || !sampler->falloff_fnc)
+		return;
+	int oversample = sampler->oversample;
+	int size = oversample * 2 + 1;
+	float maxDistance = static_cast<float>(1 / std::sqrt(2 * std::pow((double)oversample, 2)));
+	sampler->kernel.resize(size * size);
+	for (int y = -oversample; y <= oversample; ++y) {
+		for (int x = -oversample; x <= oversample; ++x) {
+			float f = sampler->falloff_fnc(static_cast<float>(std::sqrt((double)(x * x + y * y)) * maxDistance));
+			sampler->kernel[(y + oversample) * size + x + oversample] = static_cast<uint32_t>(std::lround(std::max(0.0f, f) * (1 << kernelPrecision)));
+		}
+	}
 }
 int sampler_get_color_sample(Sampler *sampler, math::Vector2i &pointer, math::Rectangle<int> &screen_rect, math::Vector2i &offset, Color *color) {
-	Color sample, result = { 0.0f };
-	float divider = 0;
 	cairo_surface_t *surface = screen_reader_get_surface(sampler->screen_reader);
+	return sampler_get_color_sample_from_data(sampler, cairo_image_surface_get_data(surface), cairo_image_surface_get_stride(surface), pointer, screen_rect, offset, color);
+}
+int sampler_get_color_sample_from_data(Sampler *sampler, const unsigned char *data, int stride, const math::Vector2i &pointer, const math::Rectangle<int> &screen_rect, const math::Vector2i &offset, Color *color) {
+	if (!sampler->kernelValid)
+		updateKernel(sampler);
+	int oversample = sampler->oversample;
 	int x = pointer.x, y = pointer.y;
 	int left, right, top, bottom;
-	left = math::max(screen_rect.getLeft(), x - sampler->oversample);
-	right = math::min(screen_rect.getRight(), x + sampler->oversample + 1);
-	top = math::max(screen_rect.getTop(), y - sampler->oversample);
-	bottom = math::min(screen_rect.getBottom(), y + sampler->oversample + 1);
+	left = math::max(screen_rect.getLeft(), x - oversample);
+	right = math::min(screen_rect.getRight(), x + oversample + 1);
+	top = math::max(screen_rect.getTop(), y - oversample);
+	bottom = math::min(screen_rect.getBottom(), y + oversample + 1);
 	int width = right - left;
 	int height = bottom - top;
-	int center_x = x - left;
-	int center_y = y - top;
-	float max_distance = static_cast<float>(1 / std::sqrt(2 * std::pow((double)sampler->oversample, 2)));
-	unsigned char *data = cairo_image_surface_get_data(surface);
-	int stride = cairo_image_surface_get_stride(surface);
-	for (int x = -sampler->oversample; x <= sampler->oversample; ++x) {
-		for (int y = -sampler->oversample; y <= sampler->oversample; ++y) {
-			if ((center_x + x < 0) || (center_y + y < 0)) continue;
-			if ((center_x + x >= width) || (center_y + y >= height)) continue;
-			getPixel(data, stride, offset.x + center_x + x, offset.y + center_y + y, &sample);
-			float f;
-			if (sampler->oversample) {
-				f = sampler->falloff_fnc(static_cast<float>(std::sqrt((double)(x * x + y * y)) * max_distance));
-			} else {
-				f = 1;
+	// Pixels are stored as native endian 32 bit BGRA values and accumulated as integers, conversion to float happens once.
+	const auto &table = channelTable(sampler->linearLight);
+	uint64_t red = 0, green = 0, blue = 0, divider = 0;
+	if (sampler->kernel.empty()) {
+		for (int row = 0; row < height; ++row) {
+			const unsigned char *p = data + (offset.y + row) * stride + offset.x * 4;
+			uint32_t rowRed = 0, rowGreen = 0, rowBlue = 0;
+			for (int column = 0; column < width; ++column, p += 4) {
+				rowRed += table[p[2]];
+				rowGreen += table[p[1]];
+				rowBlue += table[p[0]];
+			}
+			red += rowRed;
+			green += rowGreen;
+			blue += rowBlue;
+		}
+		divider = static_cast<uint64_t>(width) * height;
+	} else {
+		int size = oversample * 2 + 1;
+		const uint32_t *kernel = sampler->kernel.data() + (top - (y - oversample)) * size + (left - (x - oversample));
+		for (int row = 0; row < height; ++row, kernel += size) {
+			const unsigned char *p = data + (offset.y + row) * stride + offset.x * 4;
+			for (int column = 0; column < width; ++column, p += 4) {
+				uint32_t weight = kernel[column];
+				red += static_cast<uint64_t>(table[p[2]]) * weight;
+				green += static_cast<uint64_t>(table[p[1]]) * weight;
+				blue += static_cast<uint64_t>(table[p[0]]) * weight;
+				divider += weight;
 			}
-			result += sample * f;
-			divider += f;
 		}
 	}
-	if (divider > 0)
-		result *= 1 / divider;
+	Color result = { 0.0f };
+	if (divider > 0) {
+		double scale = 1 / (65535.0 * static_cast<double>(divider));
+		result.rgb.red = static_cast<float>(red * scale);
+		result.rgb.green = static_cast<float>(green * scale);
+		result.rgb.blue = static_cast<float>(blue * scale);
+		if (sampler->linearLight)
+			result.nonLinearRgbInplace();
+	}
 	result.alpha = 1;
 	*color = result;
 	return 0;
@@ -32,13 +32,27 @@ enum class SamplerFalloff: int
 	cubic = 3,
 	exponential = 4,
 };
+/**
+ * Largest supported oversample radius. Larger values are clamped.
+ */
+const int sampler_max_oversample = 16;
 Sampler* sampler_new(ScreenReader* screen_reader);
 void sampler_set_falloff(Sampler *sampler, SamplerFalloff falloff);
 void sampler_set_oversample(Sampler *sampler, int oversample);
+/**
+ * Average samples in linear light instead of averaging gamma encoded sRGB values.
+ */
+void sampler_set_linear_light(Sampler *sampler, bool linearLight);
+bool sampler_get_linear_light(Sampler *sampler);
 SamplerFalloff sampler_get_falloff(Sampler *sampler);
 int sampler_get_oversample(Sampler *sampler);
 void sampler_destroy(Sampler *sampler);
 int sampler_get_color_sample(Sampler *sampler, math::Vector2i &pointer, math::Rectangle<int>& screen_rect, math::Vector2i &offset, Color* color);
+/**
+ * Sample color from 32 bit native endian xRGB pixel data instead of screen reader surface.
+ * Can be used outside of main thread with a sampler which is not shared with other threads.
+ */
+int sampler_get_color_sample_from_data(Sampler *sampler, const unsigned char *data, int stride, const math::Vector2i &pointer, const math::Rectangle<int> &screen_rect, const math::Vector2i &offset, Color *color);
 void sampler_get_screen_rect(Sampler *sampler, math::Vector2i &pointer, math::Rectangle<int>& screen_rect, math::Rectangle<int> *rect);
 
 #endif /* GPICK_SAMPLER_H_ */
@@ -19,18 +19,300 @@
 #include "ScreenReader.h"
 #include <gtk/gtk.h>
 #include <algorithm>
+#include <cstdint>
 #include <iostream>
+#if defined(GPICK_XSHM) && defined(GDK_WINDOWING_X11)
+#include <gdk/gdkx.h>
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <X11/extensions/XShm.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#define GPICK_SCREEN_READER_XSHM
+#endif
+#if defined(GPICK_XDAMAGE) && defined(GDK_WINDOWING_X11)
+#include <gdk/gdkx.h>
+#include <X11/Xlib.h>
+#include <X11/extensions/Xdamage.h>
+#define GPICK_SCREEN_READER_XDAMAGE
+#endif
+#ifdef GPICK_SCREEN_READER_XSHM
+namespace {
+// Captures root window contents directly into a persistent shared memory segment, which is also used as cairo surface data.
+struct SharedMemoryCapture {
+	SharedMemoryCapture():
+		m_display(nullptr),
+		m_visual(nullptr),
+		m_depth(0),
+		m_image(nullptr),
+		m_surface(nullptr),
+		m_segmentSize(0),
+		m_width(0),
+		m_height(0),
+		m_failed(false) {
+		m_segment.shmid = -1;
+		m_segment.shmaddr = nullptr;
+		m_segment.readOnly = False;
+	}
+	~SharedMemoryCapture() {
+		releaseImage();
+		releaseSegment();
+	}
+	cairo_surface_t *capture(GdkScreen *screen, const math::Rectangle<int> &area) {
+		if (m_failed)
+			return nullptr;
+		GdkDisplay *gdkDisplay = gdk_screen_get_display(screen);
+#if GTK_MAJOR_VERSION >= 3
+		if (!GDK_IS_X11_DISPLAY(gdkDisplay)) {
+			m_failed = true;
+			return nullptr;
+		}
+#endif
+		Display *display = GDK_DISPLAY_XDISPLAY(gdkDisplay);
+		if (m_display != display) {
+			releaseImage();
+			releaseSegment();
+			m_display = display;
+			if (!XShmQueryExtension(m_display) || !checkVisual(screen)) {
+				m_failed = true;
+				return nullptr;
+			}
+		}
+		int width = area.getWidth(), height = area.getHeight();
+		if (width <= 0 || height <= 0)
+			return nullptr;
+		if (!prepare(width, height)) {
+			m_failed = true;
+			return nullptr;
+		}
+		GdkWindow *rootWindow = gdk_screen_get_root_window(screen);
+		gdk_error_trap_push();
+		Bool result = XShmGetImage(m_display, GDK_WINDOW_XID(rootWindow), m_image, area.getX(), area.getY(), AllPlanes);
+		if (gdk_error_trap_pop() != 0 || !result)
+			return nullptr;
+		cairo_surface_mark_dirty(m_surface);
+		return m_surface;
+	}
+	bool failed() const {
+		return m_failed;
+	}
+private:
+	Display *m_display;
+	Visual *m_visual;
+	int m_depth;
+	XShmSegmentInfo m_segment;
+	XImage *m_image;
+	cairo_surface_t *m_surface;
+	size_t m_segmentSize;
+	int m_width, m_height;
+	bool m_failed;
+	bool checkVisual(GdkScreen *screen) {
+		int screenNumber = gdk_screen_get_number(screen);
+		m_visual = DefaultVisual(m_display, screenNumber);
+		m_depth = DefaultDepth(m_display, screenNumber);
+		const uint16_t byteOrderTest = 1;
+		int nativeByteOrder = *reinterpret_cast<const uint8_t *>(&byteOrderTest) ? LSBFirst : MSBFirst;
+		// Only layouts identical to CAIRO_FORMAT_RGB24 can be used without conversion.
+		return (m_depth == 24 || m_depth == 32) && m_visual->red_mask == 0xff0000 && m_visual->green_mask == 0xff00 && m_visual->blue_mask == 0xff && ImageByteOrder(m_display) == nativeByteOrder;
+	}
+	bool prepare(int width, int height) {
+		if (m_image && m_width == width && m_height == height)
+			return true;
+		releaseImage();
+		m_image = XShmCreateImage(m_display, m_visual, m_depth, ZPixmap, nullptr, &m_segment, width, height);
+		if (!m_image)
+			return false;
+		if (m_image->bits_per_pixel != 32 || m_image->bytes_per_line != cairo_format_stride_for_width(CAIRO_FORMAT_RGB24, width))
+			return false;
+		size_t size = static_cast<size_t>(m_image->bytes_per_line) * height;
+		if (size > m_segmentSize) {
+			releaseSegment();
+			// Grow in steps to avoid reallocating segment when read area size changes slightly.
+			size_t segmentSize = (size / (150 * 150 * 4) + 1) * (150 * 150 * 4);
+			if (!attachSegment(segmentSize))
+				return false;
+		}
+		m_image->data = m_segment.shmaddr;
+		m_surface = cairo_image_surface_create_for_data(reinterpret_cast<unsigned char *>(m_segment.shmaddr), CAIRO_FORMAT_RGB24, width, height, m_image->bytes_per_line);
+		if (cairo_surface_status(m_surface) != CAIRO_STATUS_SUCCESS)
+			return false;
+		m_width = width;
+		m_height = height;
+		return true;
+	}
+	bool attachSegment(size_t size) {
+		m_segment.shmid = shmget(IPC_PRIVATE, size, IPC_CREAT | 0600);
+		if (m_segment.shmid < 0)
+			return false;
+		m_segment.shmaddr = reinterpret_cast<char *>(shmat(m_segment.shmid, nullptr, 0));
+		if (m_segment.shmaddr == reinterpret_cast<char *>(-1)) {
+			m_segment.shmaddr = nullptr;
+			shmctl(m_segment.shmid, IPC_RMID, nullptr);
+			m_segment.shmid = -1;
+			return false;
+		}
+		m_segment.readOnly = False;
+		gdk_error_trap_push();
+		Bool attached = XShmAttach(m_display, &m_segment);
+		XSync(m_display, False);
+		bool error = gdk_error_trap_pop() != 0;
+		// Segment is destroyed automatically when both gpick and X server detach from it.
+		shmctl(m_segment.shmid, IPC_RMID, nullptr);
+		if (!attached || error) {
+			shmdt(m_segment.shmaddr);
+			m_segment.shmaddr = nullptr;
+			m_segment.shmid = -1;
+			return false;
+		}
+		m_segmentSize = size;
+		return true;
+	}
+	void releaseImage() {
+		if (m_surface) {
+			cairo_surface_destroy(m_surface);
+			m_surface = nullptr;
+		}
+		if (m_image) {
+			m_image->data = nullptr;
+			XDestroyImage(m_image);
+			m_image = nullptr;
+		}
+		m_width = m_height = 0;
+	}
+	void releaseSegment() {
+		if (!m_segment.shmaddr)
+			return;
+		XShmDetach(m_display, &m_segment);
+		XSync(m_display, False);
+		shmdt(m_segment.shmaddr);
+		m_segment.shmaddr = nullptr;
+		m_segment.shmid = -1;
+		m_segmentSize = 0;
+	}
+};
+}
+#endif
+#ifdef GPICK_SCREEN_READER_XDAMAGE
+namespace {
+// Listens for root window damage notifications and remembers if any of them touched watched area.
+struct DamageTracker {
+	DamageTracker():
+		m_display(nullptr),
+		m_screen(nullptr),
+		m_damage(0),
+		m_eventBase(0),
+		m_damaged(true),
+		m_failed(false) {
+	}
+	~DamageTracker() {
+		stop();
+	}
+	// Returns false if damage can not be tracked for specified screen.
+	bool watch(GdkScreen *screen, const math::Rectangle<int> &area) {
+		if (m_failed)
+			return false;
+		GdkDisplay *gdkDisplay = gdk_screen_get_display(screen);
+#if GTK_MAJOR_VERSION >= 3
+		if (!GDK_IS_X11_DISPLAY(gdkDisplay)) {
+			m_failed = true;
+			return false;
+		}
+#endif
+		Display *display = GDK_DISPLAY_XDISPLAY(gdkDisplay);
+		if (m_display != display || m_screen != screen) {
+			stop();
+			if (!start(screen, display)) {
+				m_failed = true;
+				return false;
+			}
+		}
+		m_area = area;
+		return true;
+	}
+	bool takeDamaged() {
+		bool damaged = m_damaged;
+		m_damaged = false;
+		return damaged;
+	}
+private:
+	Display *m_display;
+	GdkScreen *m_screen;
+	Damage m_damage;
+	int m_eventBase;
+	math::Rectangle<int> m_area;
+	bool m_damaged, m_failed;
+	bool start(GdkScreen *screen, Display *display) {
+		int errorBase;
+		if (!XDamageQueryExtension(display, &m_eventBase, &errorBase))
+			return false;
+		gdk_error_trap_push();
+		m_damage = XDamageCreate(display, GDK_WINDOW_XID(gdk_screen_get_root_window(screen)), XDamageReportBoundingBox);
+		XSync(display, False);
+		if (gdk_error_trap_pop() != 0) {
+			m_damage = 0;
+			return false;
+		}
+		m_display = display;
+		m_screen = screen;
+		m_damaged = true;
+		gdk_window_add_filter(nullptr, onEvent, this);
+		return true;
+	}
+	void stop() {
+		if (!m_display)
+			return;
+		gdk_window_remove_filter(nullptr, onEvent, this);
+		gdk_error_trap_push();
+		XDamageDestroy(m_display, m_damage);
+		XSync(m_display, False);
+		gdk_error_trap_pop();
+		m_display = nullptr;
+		m_damage = 0;
+	}
+	static GdkFilterReturn onEvent(GdkXEvent *xevent, GdkEvent *, gpointer data) {
+		auto *tracker = reinterpret_cast<DamageTracker *>(data);
+		auto *event = reinterpret_cast<XEvent *>(xevent);
+		if (event->type != tracker->m_eventBase + XDamageNotify)
+			return GDK_FILTER_CONTINUE;
+		auto *damageEvent = reinterpret_cast<XDamageNotifyEvent *>(event);
+		if (damageEvent->damage != tracker->m_damage)
+			return GDK_FILTER_CONTINUE;
+		const auto &area = damageEvent->area;
+		if (tracker->m_area.intersects(math::Rectangle<int>(area.x, area.y, area.x + area.width, area.y + area.height)))
+			tracker->m_damaged = true;
+		// Bounding box reporting sends a new notification only after damage is subtracted.
+		XDamageSubtract(tracker->m_display, tracker->m_damage, None, None);
+		return GDK_FILTER_REMOVE;
+	}
+};
+}
+#endif
 struct ScreenReader {
 	cairo_surface_t *surface;
+	cairo_surface_t *currentSurface;
 	int maxSize;
 	GdkScreen *screen;
-	math::Rectangle<int> readArea;
+	math::Rectangle<int> readArea, capturedArea;
+	math::Vector2i pointer;
+	gint64 captureTime;
+	int maxStaleness;
+	bool invalid;
+#ifdef GPICK_SCREEN_READER_XSHM
+	SharedMemoryCapture sharedMemoryCapture;
+#endif
+#ifdef GPICK_SCREEN_READER_XDAMAGE
+	DamageTracker damageTracker;
+#endif
 };
 struct ScreenReader *screen_reader_new() {
 	ScreenReader *screen = new ScreenReader;
 	screen->maxSize = 0;
 	screen->surface = 0;
+	screen->currentSurface = 0;
 	screen->screen = 0;
+	screen->captureTime = 0;
+	screen->maxStaleness = 500;
+	screen->invalid = true;
 	return screen;
 }
 void screen_reader_destroy(ScreenReader *screen) {
@@ -49,26 +331,27 @@ void screen_reader_reset_rect(ScreenReader *screen) {
 	screen->readArea = math::Rectangle<int>();
 	screen->screen = NULL;
 }
-void screen_reader_update_surface(ScreenReader *screen, math::Rectangle<int> *updateRect) {
-	if (!screen->screen) return;
-	int left = screen->readArea.getX();
-	int top = screen->readArea.getY();
-	int width = screen->readArea.getWidth();
-	int height = screen->readArea.getHeight();
-	if (width > screen->maxSize || height > screen->maxSize) {
-		if (screen->surface) cairo_surface_destroy(screen->surface);
-		screen->maxSize = (std::max(width, height) / 150 + 1) * 150;
-		screen->surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, screen->maxSize, screen->maxSize);
-	}
-	GdkWindow *rootWindow = gdk_screen_get_root_window(screen->screen);
+void screen_reader_set_max_staleness(ScreenReader *screen, int milliseconds) {
+	screen->maxStaleness = milliseconds;
+}
+void screen_reader_invalidate(ScreenReader *screen) {
+	screen->invalid = true;
+}
+static bool copyRootWindow(GdkScreen *gdkScreen, const math::Rectangle<int> &area, cairo_surface_t *target) {
+	int left = area.getX();
+	int top = area.getY();
+	int width = area.getWidth();
+	int height = area.getHeight();
+	GdkWindow *rootWindow = gdk_screen_get_root_window(gdkScreen);
 	cairo_t *rootCairo = gdk_cairo_create(rootWindow);
 	cairo_surface_t *rootSurface = cairo_get_target(rootCairo);
 	if (cairo_surface_status(rootSurface) != CAIRO_STATUS_SUCCESS) {
 		std::cerr << "can not get root window surface" << std::endl;
-		return;
+		cairo_destroy(rootCairo);
+		return false;
 	}
 	cairo_surface_mark_dirty_rectangle(rootSurface, left, top, width, height);
-	cairo_t *cr = cairo_create(screen->surface);
+	cairo_t *cr = cairo_create(target);
 	cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
 	cairo_set_source_surface(cr, rootSurface, -left, -top);
 	cairo_pattern_set_filter(cairo_get_source(cr), CAIRO_FILTER_NEAREST);
@@ -76,8 +359,63 @@ void screen_reader_update_surface(ScreenReader *screen, math::Rectangle<int> *up
 	cairo_fill(cr);
 	cairo_destroy(cr);
 	cairo_destroy(rootCairo);
-	*updateRect = screen->readArea;
+	return true;
+}
+static bool capture(ScreenReader *screen) {
+#ifdef GPICK_SCREEN_READER_XSHM
+	if (cairo_surface_t *surface = screen->sharedMemoryCapture.capture(screen->screen, screen->readArea)) {
+		screen->currentSurface = surface;
+		return true;
+	}
+#endif
+	int width = screen->readArea.getWidth();
+	int height = screen->readArea.getHeight();
+	if (width > screen->maxSize || height > screen->maxSize) {
+		if (screen->surface) cairo_surface_destroy(screen->surface);
+		screen->maxSize = (std::max(width, height) / 150 + 1) * 150;
+		screen->surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, screen->maxSize, screen->maxSize);
+	}
+	if (!copyRootWindow(screen->screen, screen->readArea, screen->surface))
+		return false;
+	screen->currentSurface = screen->surface;
+	return true;
+}
+bool screen_reader_update_surface(ScreenReader *screen, const math::Vector2i &pointer, math::Rectangle<int> *updateRect) {
+	if (!screen->screen) return false;
+	bool areaChanged = screen->invalid || screen->currentSurface == nullptr || screen->readArea != screen->capturedArea;
+	bool damaged = true;
+#ifdef GPICK_SCREEN_READER_XDAMAGE
+	if (screen->damageTracker.watch(screen->screen, screen->readArea))
+		damaged = screen->damageTracker.takeDamaged();
+#endif
+	gint64 now = g_get_monotonic_time();
+	bool stale = now - screen->captureTime >= static_cast<gint64>(screen->maxStaleness) * 1000;
+	*updateRect = screen->capturedArea;
+	if (!areaChanged && !damaged && !stale) {
+		// Screen contents are still valid, but pointer position might still need to be redrawn.
+		if (screen->pointer == pointer)
+			return false;
+		screen->pointer = pointer;
+		return true;
+	}
+	if (!capture(screen))
+		return false;
+	screen->capturedArea = screen->readArea;
+	screen->pointer = pointer;
+	screen->captureTime = now;
+	screen->invalid = false;
+	*updateRect = screen->capturedArea;
+	return true;
 }
 cairo_surface_t *screen_reader_get_surface(ScreenReader *screen) {
-	return screen->surface;
+	return screen->currentSurface;
+}
+cairo_surface_t *screen_reader_capture_area(GdkScreen *gdkScreen, const math::Rectangle<int> &area) {
+	cairo_surface_t *surface = cairo_image_surface_create(CAIRO_FORMAT_RGB24, area.getWidth(), area.getHeight());
+	if (cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS || !copyRootWindow(gdkScreen, area, surface)) {
+		cairo_surface_destroy(surface);
+		return nullptr;
+	}
+	cairo_surface_flush(surface);
+	return surface;
 }
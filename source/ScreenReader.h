@@ -25,7 +25,19 @@ struct ScreenReader;
 ScreenReader *screen_reader_new();
 void screen_reader_reset_rect(ScreenReader *screen);
 void screen_reader_add_rect(ScreenReader *screen, GdkScreen *gdkScreen, math::Rectangle<int> &rect);
-void screen_reader_update_surface(ScreenReader *screen, math::Rectangle<int> *updateRect);
+/**
+ * Capture read area if it, pointer position or screen contents changed since last capture.
+ * Without damage tracking support screen contents are assumed to change all the time.
+ * @return True if surface or pointer position changed and picker widgets need to be updated.
+ */
+bool screen_reader_update_surface(ScreenReader *screen, const math::Vector2i &pointer, math::Rectangle<int> *updateRect);
+void screen_reader_invalidate(ScreenReader *screen);
+void screen_reader_set_max_staleness(ScreenReader *screen, int milliseconds);
 cairo_surface_t *screen_reader_get_surface(ScreenReader *screen);
+/**
+ * Capture screen area into a new surface, without touching buffers used for picking.
+ * @return Surface which has to be destroyed by caller, or nullptr on failure.
+ */
+cairo_surface_t *screen_reader_capture_area(GdkScreen *gdkScreen, const math::Rectangle<int> &area);
 void screen_reader_destroy(ScreenReader *screen);
 #endif /* GPICK_SCREEN_READER_H_ */
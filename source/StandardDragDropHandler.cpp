@@ -20,6 +20,7 @@
 #include "GlobalState.h"
 #include "ColorObject.h"
 #include "Converter.h"
+#include "TextColors.h"
 #include "dynv/Map.h"
 #include "IDroppableColorUI.h"
 #include "gtk/ColorWidget.h"
@@ -143,12 +144,13 @@ static void onDragDataReceived(GtkWidget *widget, GdkDragContext *context, gint
 	} break;
 	case Target::string: {
 		gchar *data = (gchar *)gtk_selection_data_get_data(selectionData);
-		ColorObject colorObject;
-		if (!state.gs.converters().deserialize(std::string(data, data + gtk_selection_data_get_length(selectionData)), colorObject)) {
+		gint length = gtk_selection_data_get_length(selectionData);
+		auto colorObjects = extractColors(std::string_view(data, length > 0 ? length : 0), state.gs.converters());
+		if (colorObjects.empty()) {
 			gtk_drag_finish(context, false, false, time);
 			return;
 		}
-		success = setColor(colorObject, readonlyColorUI, x, y);
+		success = setColors(colorObjects, readonlyColorUI, x, y);
 	} break;
 	case Target::color: {
 		guint16 *data = (guint16 *)gtk_selection_data_get_data(selectionData);
@@ -257,19 +259,17 @@ static void onDragDataGet(GtkWidget *widget, GdkDragContext *context, GtkSelecti
 	} break;
 	case Target::string: {
 		std::stringstream ss;
-		ConverterSerializePosition position(state.colorObjects.size());
 		auto converter = state.gs.converters().firstCopy();
 		if (converter) {
-			for (size_t i = 0, count = state.colorObjects.size(); i < count; i++) {
-				if (position.index() + 1 == position.count())
-					position.last(true);
-				if (position.first()) {
-					ss << converter->serialize(state.colorObjects[i], position);
-					position.first(false);
-				} else {
-					ss << "\n" << converter->serialize(state.colorObjects[i], position);
-				}
-				position.incrementIndex();
+			std::vector<const ColorObject *> colorObjects;
+			colorObjects.reserve(state.colorObjects.size());
+			for (const auto &colorObject: state.colorObjects)
+				colorObjects.push_back(&colorObject);
+			auto lines = converter->serialize(colorObjects);
+			for (size_t i = 0; i < lines.size(); i++) {
+				if (i != 0)
+					ss << "\n";
+				ss << lines[i];
 			}
 		}
 		std::string text = ss.str();
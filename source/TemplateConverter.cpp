@@ -0,0 +1,383 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "TemplateConverter.h"
+#include "Converters.h"
+#include "ColorObject.h"
+#include "common/MatchPattern.h"
+#include "common/Convert.h"
+#include "common/NumberFormat.h"
+#include "math/Algorithms.h"
+#include "dynv/Map.h"
+#include <algorithm>
+#include <iostream>
+namespace {
+using Component = TemplateConverter::Component;
+using Format = TemplateConverter::Format;
+const size_t componentCount = 7;
+static bool isSpace(char value) {
+	return value == ' ' || value == '\t' || value == '\n' || value == '\r';
+}
+static bool isHex(char value) {
+	return (value >= '0' && value <= '9') || (value >= 'a' && value <= 'f') || (value >= 'A' && value <= 'F');
+}
+static int fromHex(char value) {
+	if (value >= '0' && value <= '9')
+		return value - '0';
+	else if (value >= 'a' && value <= 'f')
+		return value - 'a' + 10;
+	else if (value >= 'A' && value <= 'F')
+		return value - 'A' + 10;
+	else
+		return 0;
+}
+static int toRange(float value, int max) {
+	return std::max(std::min(static_cast<int>(value * (max + 1)), max), 0);
+}
+static float toQuality(size_t start, size_t end, size_t length) {
+	return 1.0f - static_cast<float>(std::atan(start) / math::PI) - static_cast<float>(std::atan(length - end) / math::PI);
+}
+static bool parseComponent(std::string_view value, Component &component, Format &format) {
+	if (value == "r" || value == "g" || value == "b" || value == "a") {
+		component = value == "r" ? Component::red : value == "g" ? Component::green : value == "b" ? Component::blue : Component::alpha;
+		format = Format::integer;
+	} else if (value == "h") {
+		component = Component::hue;
+		format = Format::integer;
+	} else if (value == "s" || value == "l") {
+		component = value == "s" ? Component::saturation : Component::lightness;
+		format = Format::percentage;
+	} else if (value == "name") {
+		component = Component::name;
+		format = Format::integer;
+	} else {
+		return false;
+	}
+	return true;
+}
+static bool parseFormat(std::string_view value, Format &format) {
+	if (value == "d")
+		format = Format::integer;
+	else if (value == "x")
+		format = Format::hex;
+	else if (value == "%")
+		format = Format::percentage;
+	else if (value == "f")
+		format = Format::decimal;
+	else
+		return false;
+	return true;
+}
+// Largest integer value written for a component, values are scaled to [0, max] range.
+static int integerRange(Component component, Format format) {
+	switch (format) {
+	case Format::integer:
+		if (component == Component::hue)
+			return 360;
+		if (component == Component::saturation || component == Component::lightness)
+			return 100;
+		return 255;
+	case Format::hex:
+		return 255;
+	case Format::percentage:
+		return 100;
+	case Format::decimal:
+		return 1;
+	}
+	return 1;
+}
+static void appendHex(std::string &result, int value, bool upperCase) {
+	const char *digits = upperCase ? "0123456789ABCDEF" : "0123456789abcdef";
+	result += digits[(value >> 4) & 0xf];
+	result += digits[value & 0xf];
+}
+}
+TemplateConverter::TemplateConverter():
+	m_literalLength(0),
+	m_hasRgb(false),
+	m_hasHsl(false),
+	m_hasName(false) {
+}
+std::shared_ptr<TemplateConverter> TemplateConverter::compile(std::string_view format) {
+	std::shared_ptr<TemplateConverter> result(new TemplateConverter());
+	auto &instructions = result->m_instructions;
+	std::string text;
+	auto flushText = [&]() {
+		if (text.empty())
+			return;
+		result->m_literalLength += text.length();
+		instructions.push_back(Instruction { true, Component::red, Format::integer, std::move(text) });
+		text.clear();
+	};
+	bool used[componentCount] = {};
+	for (size_t i = 0, length = format.length(); i < length; i++) {
+		char ch = format[i];
+		if (ch == '}') {
+			if (i + 1 >= length || format[i + 1] != '}')
+				return nullptr;
+			text += '}';
+			i++;
+			continue;
+		}
+		if (ch != '{') {
+			text += ch;
+			continue;
+		}
+		if (i + 1 < length && format[i + 1] == '{') {
+			text += '{';
+			i++;
+			continue;
+		}
+		auto close = format.find('}', i + 1);
+		if (close == std::string_view::npos)
+			return nullptr;
+		auto placeholder = format.substr(i + 1, close - i - 1);
+		auto colon = placeholder.find(':');
+		Component component;
+		Format valueFormat;
+		if (!parseComponent(placeholder.substr(0, colon), component, valueFormat))
+			return nullptr;
+		if (colon != std::string_view::npos && (component == Component::name || !parseFormat(placeholder.substr(colon + 1), valueFormat)))
+			return nullptr;
+		flushText();
+		instructions.push_back(Instruction { false, component, valueFormat, std::string() });
+		if (component == Component::name)
+			result->m_hasName = true;
+		else
+			used[static_cast<size_t>(component)] = true;
+		i = close;
+	}
+	flushText();
+	if (instructions.empty())
+		return nullptr;
+	result->m_hasRgb = used[static_cast<size_t>(Component::red)] && used[static_cast<size_t>(Component::green)] && used[static_cast<size_t>(Component::blue)];
+	result->m_hasHsl = used[static_cast<size_t>(Component::hue)] || used[static_cast<size_t>(Component::saturation)] || used[static_cast<size_t>(Component::lightness)];
+	return result;
+}
+const std::vector<TemplateConverter::Instruction> &TemplateConverter::instructions() const {
+	return m_instructions;
+}
+bool TemplateConverter::canDeserialize() const {
+	if (m_hasRgb)
+		return true;
+	if (!m_hasHsl)
+		return false;
+	bool used[componentCount] = {};
+	for (const auto &instruction: m_instructions) {
+		if (!instruction.literal && instruction.component != Component::name)
+			used[static_cast<size_t>(instruction.component)] = true;
+	}
+	return used[static_cast<size_t>(Component::hue)] && used[static_cast<size_t>(Component::saturation)] && used[static_cast<size_t>(Component::lightness)];
+}
+ConverterSignature TemplateConverter::signature() const {
+	auto classes = CharacterClass::none;
+	std::vector<std::string> substrings;
+	for (const auto &instruction: m_instructions) {
+		if (!instruction.literal) {
+			if (instruction.component != Component::name)
+				classes = classes | (instruction.format == Format::hex ? CharacterClass::hexDigit : CharacterClass::digit);
+			continue;
+		}
+		// Whitespace in literals matches any amount of whitespace, so only parts between whitespace are required.
+		std::string part;
+		for (char ch: instruction.text + ' ') {
+			if (!isSpace(ch)) {
+				part += ch;
+				continue;
+			}
+			if (part.empty())
+				continue;
+			classes = classes | ConverterSignature::classify(part);
+			substrings.push_back(std::move(part));
+			part.clear();
+		}
+	}
+	return ConverterSignature(classes, std::move(substrings));
+}
+std::string TemplateConverter::serialize(const ColorObject &colorObject, const Converter::Options &options) const {
+	const auto &color = colorObject.getColor();
+	Color hsl;
+	if (m_hasHsl)
+		hsl = color.rgbToHsl();
+	std::string result;
+	result.reserve(m_literalLength + m_instructions.size() * 4);
+	for (const auto &instruction: m_instructions) {
+		if (instruction.literal) {
+			result += instruction.text;
+			continue;
+		}
+		float value;
+		switch (instruction.component) {
+		case Component::red:
+			value = color.red;
+			break;
+		case Component::green:
+			value = color.green;
+			break;
+		case Component::blue:
+			value = color.blue;
+			break;
+		case Component::alpha:
+			value = color.alpha;
+			break;
+		case Component::hue:
+			value = hsl.hsl.hue;
+			break;
+		case Component::saturation:
+			value = hsl.hsl.saturation;
+			break;
+		case Component::lightness:
+			value = hsl.hsl.lightness;
+			break;
+		case Component::name:
+		default:
+			result += colorObject.getName();
+			continue;
+		}
+		switch (instruction.format) {
+		case Format::integer:
+		case Format::percentage:
+			common::appendInteger(result, toRange(value, integerRange(instruction.component, instruction.format)));
+			break;
+		case Format::hex:
+			appendHex(result, toRange(value, 255), options.upperCaseHex);
+			break;
+		case Format::decimal:
+			common::appendFixed(result, math::clamp(value), 3);
+			break;
+		}
+	}
+	return result;
+}
+bool TemplateConverter::match(std::string_view value, size_t position, size_t &end, float *values, std::string_view &name) const {
+	for (size_t i = 0, count = m_instructions.size(); i < count; i++) {
+		const auto &instruction = m_instructions[i];
+		if (instruction.literal) {
+			for (char ch: instruction.text) {
+				if (isSpace(ch)) {
+					while (position < value.length() && isSpace(value[position]))
+						position++;
+					continue;
+				}
+				if (position >= value.length() || value[position] != ch)
+					return false;
+				position++;
+			}
+			continue;
+		}
+		if (instruction.component == Component::name) {
+			size_t nameEnd = value.length();
+			if (i + 1 < count) {
+				const auto &text = m_instructions[i + 1].text;
+				auto stop = std::find_if(text.begin(), text.end(), [](char ch) { return !isSpace(ch); });
+				if (stop != text.end()) {
+					nameEnd = value.find(*stop, position);
+					if (nameEnd == std::string_view::npos)
+						return false;
+				}
+			}
+			name = value.substr(position, nameEnd - position);
+			position = nameEnd;
+			continue;
+		}
+		float number;
+		if (instruction.format == Format::hex) {
+			if (position + 2 > value.length() || !isHex(value[position]) || !isHex(value[position + 1]))
+				return false;
+			number = (fromHex(value[position]) << 4 | fromHex(value[position + 1])) / 255.0f;
+			position += 2;
+		} else {
+			size_t start = position;
+			if (!common::ops::number(value, position))
+				return false;
+			number = common::convert<float>(value.substr(start, position - start), 0.0f) / integerRange(instruction.component, instruction.format);
+		}
+		values[static_cast<size_t>(instruction.component)] = math::clamp(number);
+	}
+	end = position;
+	return true;
+}
+bool TemplateConverter::deserialize(const char *value, ColorObject &colorObject, float &quality) const {
+	if (!canDeserialize())
+		return false;
+	std::string_view input(value);
+	// Only positions where the leading literal starts can produce a match, so skip directly to them.
+	char first = 0;
+	if (m_instructions.front().literal && !isSpace(m_instructions.front().text.front()))
+		first = m_instructions.front().text.front();
+	for (size_t start = 0; start < input.length(); start++) {
+		if (first) {
+			start = input.find(first, start);
+			if (start == std::string_view::npos)
+				return false;
+		}
+		float values[componentCount] = { 0, 0, 0, 1, 0, 0, 0 };
+		std::string_view name;
+		size_t end;
+		if (!match(input, start, end, values, name))
+			continue;
+		Color color;
+		if (m_hasRgb) {
+			color.red = values[static_cast<size_t>(Component::red)];
+			color.green = values[static_cast<size_t>(Component::green)];
+			color.blue = values[static_cast<size_t>(Component::blue)];
+		} else {
+			Color hsl;
+			hsl.hsl.hue = values[static_cast<size_t>(Component::hue)];
+			hsl.hsl.saturation = values[static_cast<size_t>(Component::saturation)];
+			hsl.hsl.lightness = values[static_cast<size_t>(Component::lightness)];
+			color = hsl.hslToRgb();
+		}
+		color.alpha = values[static_cast<size_t>(Component::alpha)];
+		colorObject.setColor(color);
+		if (m_hasName)
+			colorObject.setName(std::string(name));
+		quality = toQuality(start, end, input.length());
+		return true;
+	}
+	return false;
+}
+bool addTemplateConverter(Converters &converters, const std::string &name, const std::string &label, std::string_view format, Converter::Options &options) {
+	auto templateConverter = TemplateConverter::compile(format);
+	if (!templateConverter)
+		return false;
+	Converter::Callback<Converter::Serialize> serialize([templateConverter](const ColorObject &colorObject, const ConverterSerializePosition &, const Converter::Options &options) {
+		return templateConverter->serialize(colorObject, options);
+	}, options);
+	if (templateConverter->canDeserialize()) {
+		Converter::Callback<Converter::Deserialize> deserialize([templateConverter](const char *value, ColorObject &colorObject, float &quality, const Converter::Options &) {
+			return templateConverter->deserialize(value, colorObject, quality);
+		}, options);
+		converters.add(name.c_str(), label, serialize, deserialize, templateConverter->signature());
+	} else {
+		converters.add(name.c_str(), label, serialize, Converter::Callback<Converter::Deserialize>());
+	}
+	return true;
+}
+void addTemplateConverters(Converters &converters, const dynv::Map &settings, Converter::Options &options) {
+	for (auto values: settings.getMaps("gpick.converters.templates")) {
+		if (!values)
+			continue;
+		auto name = values->getString("name", "");
+		auto format = values->getString("template", "");
+		if (name.empty() || format.empty())
+			continue;
+		if (!addTemplateConverter(converters, name, values->getString("label", name), format, options))
+			std::cerr << "Invalid converter template \"" << name << "\": " << format << '\n';
+	}
+}
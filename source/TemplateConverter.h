@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef GPICK_TEMPLATE_CONVERTER_H_
+#define GPICK_TEMPLATE_CONVERTER_H_
+#include "Converter.h"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <cstdint>
+struct Converters;
+struct ColorObject;
+namespace dynv {
+struct Map;
+}
+// Converter defined by a text template like "rgb({r}, {g}, {b})". Template is compiled once into a list of instructions, which are then used to both serialize and deserialize colors.
+// Placeholders have "{component}" or "{component:format}" form, where component is one of r, g, b, a, h, s, l or name, and format is one of d (integer), x (two digit hex), % (percentage) or f (0 to 1 decimal). "{{" and "}}" produce literal braces.
+struct TemplateConverter {
+	enum class Component : uint8_t {
+		red,
+		green,
+		blue,
+		alpha,
+		hue,
+		saturation,
+		lightness,
+		name,
+	};
+	enum class Format : uint8_t {
+		integer,
+		hex,
+		percentage,
+		decimal,
+	};
+	struct Instruction {
+		bool literal;
+		Component component;
+		Format format;
+		std::string text;
+	};
+	static std::shared_ptr<TemplateConverter> compile(std::string_view format);
+	const std::vector<Instruction> &instructions() const;
+	bool canDeserialize() const;
+	ConverterSignature signature() const;
+	std::string serialize(const ColorObject &colorObject, const Converter::Options &options) const;
+	bool deserialize(const char *value, ColorObject &colorObject, float &quality) const;
+private:
+	std::vector<Instruction> m_instructions;
+	size_t m_literalLength;
+	bool m_hasRgb, m_hasHsl, m_hasName;
+	TemplateConverter();
+	bool match(std::string_view value, size_t start, size_t &end, float *values, std::string_view &name) const;
+};
+bool addTemplateConverter(Converters &converters, const std::string &name, const std::string &label, std::string_view format, Converter::Options &options);
+void addTemplateConverters(Converters &converters, const dynv::Map &settings, Converter::Options &options);
+#endif /* GPICK_TEMPLATE_CONVERTER_H_ */
@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "TextColors.h"
+#include "Converters.h"
+#include "parser/TextFile.h"
+#include <algorithm>
+#include <cstring>
+namespace {
+static bool isSpace(char value) {
+	return value == ' ' || value == '\t' || value == '\n' || value == '\r';
+}
+static std::string_view trim(std::string_view value) {
+	while (!value.empty() && isSpace(value.front()))
+		value.remove_prefix(1);
+	while (!value.empty() && isSpace(value.back()))
+		value.remove_suffix(1);
+	return value;
+}
+static int hexValue(char value) {
+	if (value >= '0' && value <= '9') return value - '0';
+	if (value >= 'a' && value <= 'f') return value - 'a' + 10;
+	if (value >= 'A' && value <= 'F') return value - 'A' + 10;
+	return -1;
+}
+static bool isWordCharacter(char value) {
+	return hexValue(value) >= 0 || (value >= 'g' && value <= 'z') || (value >= 'G' && value <= 'Z') || value == '_' || value == '-';
+}
+// Parse "#rgb", "#rgba", "#rrggbb" or "#rrggbbaa" color at the start of text. Longer runs of hex digits, like in "#12345" or "#fffffffff", are not colors.
+// @return Length of color including hash symbol, or zero if text does not start with a hash color.
+static size_t parseHashColor(std::string_view text, Color &color) {
+	size_t digits = 0;
+	while (1 + digits < text.length() && hexValue(text[1 + digits]) >= 0)
+		digits++;
+	if (1 + digits < text.length() && isWordCharacter(text[1 + digits]))
+		return 0;
+	auto value = [&text](size_t index) {
+		return hexValue(text[1 + index]);
+	};
+	switch (digits) {
+	case 3:
+	case 4:
+		color = Color(value(0) / 15.0f, value(1) / 15.0f, value(2) / 15.0f, digits == 4 ? value(3) / 15.0f : 1.0f);
+		break;
+	case 6:
+	case 8:
+		color = Color((value(0) << 4 | value(1)) / 255.0f, (value(2) << 4 | value(3)) / 255.0f, (value(4) << 4 | value(5)) / 255.0f, digits == 8 ? (value(6) << 4 | value(7)) / 255.0f : 1.0f);
+		break;
+	default:
+		return 0;
+	}
+	return 1 + digits;
+}
+struct TextColorScanner: public text_file_parser::TextFile {
+	TextColorScanner(std::string_view text, std::vector<ColorObject> &colorObjects):
+		m_text(text),
+		m_position(0),
+		m_colorObjects(colorObjects) {
+	}
+	virtual ~TextColorScanner() {
+	}
+	virtual void outOfMemory() override {
+	}
+	virtual void syntaxError(size_t startLine, size_t startColumn, size_t endLine, size_t endColunn) override {
+	}
+	virtual size_t read(char *buffer, size_t length) override {
+		auto size = std::min(m_text.length() - m_position, length);
+		std::memcpy(buffer, m_text.data() + m_position, size);
+		m_position += size;
+		return size;
+	}
+	virtual void addColor(const Color &color) override {
+		m_colorObjects.emplace_back("", color);
+	}
+private:
+	std::string_view m_text;
+	size_t m_position;
+	std::vector<ColorObject> &m_colorObjects;
+};
+// Functional notations are found by text file parser. Parser is skipped for text which can not contain them.
+static void scanFunctionalColors(std::string_view text, const text_file_parser::Configuration &configuration, std::vector<ColorObject> &colorObjects) {
+	if (text.find('(') == std::string_view::npos)
+		return;
+	TextColorScanner scanner(text, colorObjects);
+	scanner.parse(configuration);
+}
+}
+std::vector<ColorObject> extractColors(std::string_view text, Converters &converters) {
+	std::vector<ColorObject> colorObjects;
+	auto trimmed = trim(text);
+	bool singleLine = trimmed.find('\n') == std::string_view::npos;
+	if (singleLine) {
+		ColorObject colorObject;
+		if (converters.deserialize(std::string(trimmed), colorObject)) {
+			colorObjects.push_back(colorObject);
+			return colorObjects;
+		}
+	}
+	// Bare hex codes and numbers match too much of regular text (font weights, sizes, words like "fade"), so only hash and functional notations are extracted.
+	// Lines consisting of such values are still handled by paste converters.
+	text_file_parser::Configuration configuration(false);
+	configuration.cssRgb = configuration.cssRgba = true;
+	configuration.cssHsl = configuration.cssHsla = true;
+	for (size_t lineStart = 0;;) {
+		auto lineEnd = std::min(text.find('\n', lineStart), text.length());
+		auto line = text.substr(lineStart, lineEnd - lineStart);
+		size_t colorCount = colorObjects.size(), segmentStart = 0;
+		// Text between hash colors is given to parser, so that colors keep their order within line.
+		for (size_t position = line.find('#'); position != std::string_view::npos; position = line.find('#', position + 1)) {
+			Color color;
+			size_t length = parseHashColor(line.substr(position), color);
+			if (length == 0)
+				continue;
+			scanFunctionalColors(line.substr(segmentStart, position - segmentStart), configuration, colorObjects);
+			colorObjects.emplace_back("", color);
+			segmentStart = position + length;
+			position = segmentStart - 1;
+		}
+		scanFunctionalColors(line.substr(segmentStart), configuration, colorObjects);
+		if (colorObjects.size() == colorCount && !singleLine) {
+			auto value = trim(line);
+			ColorObject colorObject;
+			if (!value.empty() && converters.deserialize(std::string(value), colorObject))
+				colorObjects.push_back(colorObject);
+		}
+		if (lineEnd == text.length())
+			break;
+		lineStart = lineEnd + 1;
+	}
+	return colorObjects;
+}
@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "CallStatistics.h"
+#include "NumberFormat.h"
+#include <algorithm>
+namespace common {
+CallStatistics::CallStatistics():
+	m_calls(0),
+	m_errors(0),
+	m_total(Duration::zero()),
+	m_max(Duration::zero()) {
+}
+void CallStatistics::add(Duration duration, uint64_t errors, uint64_t calls) {
+	if (calls == 0)
+		return;
+	m_calls += calls;
+	m_errors += errors;
+	m_total += duration;
+	m_max = std::max(m_max, duration / static_cast<Duration::rep>(calls));
+}
+void CallStatistics::reset() {
+	*this = CallStatistics();
+}
+uint64_t CallStatistics::calls() const {
+	return m_calls;
+}
+uint64_t CallStatistics::errors() const {
+	return m_errors;
+}
+CallStatistics::Duration CallStatistics::total() const {
+	return m_total;
+}
+CallStatistics::Duration CallStatistics::max() const {
+	return m_max;
+}
+CallTimer::CallTimer(CallStatistics &statistics):
+	m_statistics(statistics),
+	m_start(std::chrono::steady_clock::now()),
+	m_error(false) {
+}
+CallTimer::~CallTimer() {
+	m_statistics.add(std::chrono::steady_clock::now() - m_start, m_error ? 1 : 0);
+}
+void CallTimer::error() {
+	m_error = true;
+}
+static void appendString(std::string &output, const std::string &value) {
+	static const char hexDigits[] = "0123456789abcdef";
+	output += '"';
+	for (auto ch: value) {
+		switch (ch) {
+		case '"':
+			output += "\\\"";
+			break;
+		case '\\':
+			output += "\\\\";
+			break;
+		case '\n':
+			output += "\\n";
+			break;
+		case '\t':
+			output += "\\t";
+			break;
+		default:
+			if (static_cast<uint8_t>(ch) < 0x20) {
+				output += "\\u00";
+				output += hexDigits[(ch >> 4) & 0xf];
+				output += hexDigits[ch & 0xf];
+			} else {
+				output += ch;
+			}
+		}
+	}
+	output += '"';
+}
+static void appendMilliseconds(std::string &output, CallStatistics::Duration duration) {
+	appendFixed(output, std::chrono::duration<float, std::milli>(duration).count(), 3);
+}
+std::string toJson(const std::vector<NamedCallStatistics> &statistics) {
+	std::string result = "[";
+	for (size_t i = 0; i < statistics.size(); i++) {
+		const auto &entry = statistics[i];
+		if (i != 0)
+			result += ',';
+		result += "\n\t{\"kind\": ";
+		appendString(result, entry.kind);
+		result += ", \"name\": ";
+		appendString(result, entry.name);
+		result += ", \"calls\": " + std::to_string(entry.statistics.calls());
+		result += ", \"errors\": " + std::to_string(entry.statistics.errors());
+		result += ", \"totalMs\": ";
+		appendMilliseconds(result, entry.statistics.total());
+		result += ", \"maxMs\": ";
+		appendMilliseconds(result, entry.statistics.max());
+		result += '}';
+	}
+	if (!statistics.empty())
+		result += '\n';
+	result += "]\n";
+	return result;
+}
+}
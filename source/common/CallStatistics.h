@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef GPICK_COMMON_CALL_STATISTICS_H_
+#define GPICK_COMMON_CALL_STATISTICS_H_
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+namespace common {
+// Call count, error count and time spent in instrumented function.
+struct CallStatistics {
+	using Duration = std::chrono::steady_clock::duration;
+	CallStatistics();
+	// Adds calls which took duration in total. When multiple calls are added at once, maximum is updated with average call duration.
+	void add(Duration duration, uint64_t errors = 0, uint64_t calls = 1);
+	void reset();
+	uint64_t calls() const;
+	uint64_t errors() const;
+	Duration total() const;
+	Duration max() const;
+private:
+	uint64_t m_calls, m_errors;
+	Duration m_total, m_max;
+};
+// Measures time between construction and destruction and adds it to statistics as a single call.
+struct CallTimer {
+	CallTimer(CallStatistics &statistics);
+	~CallTimer();
+	void error();
+private:
+	CallStatistics &m_statistics;
+	std::chrono::steady_clock::time_point m_start;
+	bool m_error;
+};
+struct NamedCallStatistics {
+	std::string kind, name;
+	CallStatistics statistics;
+};
+// Formats statistics as JSON array of objects with kind, name, calls, errors, totalMs and maxMs fields.
+std::string toJson(const std::vector<NamedCallStatistics> &statistics);
+}
+#endif /* GPICK_COMMON_CALL_STATISTICS_H_ */
@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "NumberFormat.h"
+#include <charconv>
+#ifndef __cpp_lib_to_chars
+#include <cstdio>
+#endif
+namespace common {
+void appendInteger(std::string &output, int value) {
+	char buffer[16];
+	auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+	output.append(buffer, result.ptr);
+}
+#ifdef __cpp_lib_to_chars
+void appendFixed(std::string &output, float value, int precision) {
+	char buffer[64];
+	auto result = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::fixed, precision);
+	if (result.ec != std::errc()) {
+		output += '0';
+		return;
+	}
+	output.append(buffer, result.ptr);
+}
+#else
+// Floating point std::to_chars is missing before libstdc++ 11, so snprintf is used and decimal separator of current locale is replaced with a dot.
+void appendFixed(std::string &output, float value, int precision) {
+	char buffer[64];
+	int length = std::snprintf(buffer, sizeof(buffer), "%.*f", precision, value);
+	if (length < 0 || length >= static_cast<int>(sizeof(buffer))) {
+		output += '0';
+		return;
+	}
+	auto isDigit = [](char c) {
+		return c >= '0' && c <= '9';
+	};
+	const char *begin = buffer, *i = begin, *end = begin + length;
+	if (*i == '-')
+		i++;
+	while (i != end && isDigit(*i))
+		i++;
+	output.append(begin, i);
+	if (i == end)
+		return;
+	output += '.';
+	while (i != end && !isDigit(*i))
+		i++;
+	output.append(i, end);
+}
+#endif
+std::string toFixed(float value, int precision) {
+	std::string result;
+	appendFixed(result, value, precision);
+	return result;
+}
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef GPICK_COMMON_TRIPLE_BUFFER_H_
+#define GPICK_COMMON_TRIPLE_BUFFER_H_
+#include <atomic>
+#include <cstdint>
+namespace common {
+/**
+ * Lock-free single producer, single consumer triple buffer.
+ * Producer always has a buffer to write into, consumer always gets the most recently published buffer and intermediate buffers are dropped.
+ */
+template<typename T>
+struct TripleBuffer {
+	TripleBuffer():
+		m_state(1),
+		m_write(0),
+		m_read(2) {
+	}
+	TripleBuffer(const TripleBuffer &) = delete;
+	TripleBuffer &operator=(const TripleBuffer &) = delete;
+	/**
+	 * Buffer owned by producer. Contents are undefined, as buffer might contain any previously published value.
+	 */
+	T &writeBuffer() {
+		return m_buffers[m_write];
+	}
+	/**
+	 * Make write buffer available to consumer and take another buffer for writing.
+	 */
+	void publish() {
+		m_write = m_state.exchange(m_write | newFlag, std::memory_order_acq_rel) & indexMask;
+	}
+	/**
+	 * Take most recently published buffer if there is one.
+	 * @return True if read buffer changed.
+	 */
+	bool consume() {
+		if ((m_state.load(std::memory_order_relaxed) & newFlag) == 0)
+			return false;
+		m_read = m_state.exchange(m_read, std::memory_order_acq_rel) & indexMask;
+		return true;
+	}
+	/**
+	 * Buffer owned by consumer. Contains most recently consumed value.
+	 */
+	const T &readBuffer() const {
+		return m_buffers[m_read];
+	}
+private:
+	static constexpr uint8_t indexMask = 3;
+	static constexpr uint8_t newFlag = 4;
+	T m_buffers[3];
+	// Index of buffer exchanged between producer and consumer, and a flag indicating that it was published and not yet consumed.
+	std::atomic<uint8_t> m_state;
+	uint8_t m_write, m_read;
+};
+}
+#endif /* GPICK_COMMON_TRIPLE_BUFFER_H_ */
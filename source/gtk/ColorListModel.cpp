@@ -0,0 +1,292 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ColorListModel.h"
+#include "ColorObject.h"
+#include <new>
+
+struct GtkColorListModelPrivate
+{
+	std::vector<ColorObject *> colors;
+	// Rows kept by an ongoing removal, in reverse order. They logically follow rows in colors.
+	std::vector<ColorObject *> keptTail;
+	gint stamp;
+};
+static void tree_model_init(GtkTreeModelIface *iface);
+#define GET_PRIVATE(obj) reinterpret_cast<GtkColorListModelPrivate *>(gtk_color_list_model_get_instance_private(GTK_COLOR_LIST_MODEL(obj)))
+G_DEFINE_TYPE_WITH_CODE(GtkColorListModel, gtk_color_list_model, G_TYPE_OBJECT, G_ADD_PRIVATE(GtkColorListModel) G_IMPLEMENT_INTERFACE(GTK_TYPE_TREE_MODEL, tree_model_init));
+static void finalize(GObject *obj)
+{
+	GtkColorListModelPrivate *ns = GET_PRIVATE(obj);
+	for (auto *colorObject: ns->colors)
+		colorObject->release();
+	ns->colors.~vector();
+	ns->keptTail.~vector();
+	G_OBJECT_CLASS(gtk_color_list_model_parent_class)->finalize(obj);
+}
+static void gtk_color_list_model_class_init(GtkColorListModelClass *model_class)
+{
+	GObjectClass *obj_class = G_OBJECT_CLASS(model_class);
+	obj_class->finalize = finalize;
+}
+static void gtk_color_list_model_init(GtkColorListModel *model)
+{
+	GtkColorListModelPrivate *ns = GET_PRIVATE(model);
+	new (&ns->colors) std::vector<ColorObject *>();
+	new (&ns->keptTail) std::vector<ColorObject *>();
+	ns->stamp = g_random_int();
+}
+static size_t count(GtkColorListModelPrivate *ns)
+{
+	return ns->colors.size() + ns->keptTail.size();
+}
+static ColorObject *at(GtkColorListModelPrivate *ns, size_t index)
+{
+	if (index < ns->colors.size())
+		return ns->colors[index];
+	return ns->keptTail[ns->keptTail.size() - 1 - (index - ns->colors.size())];
+}
+static bool is_valid(GtkColorListModelPrivate *ns, GtkTreeIter *iter)
+{
+	return iter && iter->stamp == ns->stamp && GPOINTER_TO_SIZE(iter->user_data) < count(ns);
+}
+static void set_iter(GtkColorListModelPrivate *ns, size_t index, GtkTreeIter *iter)
+{
+	iter->stamp = ns->stamp;
+	iter->user_data = GSIZE_TO_POINTER(index);
+	iter->user_data2 = nullptr;
+	iter->user_data3 = nullptr;
+}
+static GtkTreeModelFlags get_flags(GtkTreeModel *)
+{
+	return GTK_TREE_MODEL_LIST_ONLY;
+}
+static gint get_n_columns(GtkTreeModel *)
+{
+	return 2;
+}
+static GType get_column_type(GtkTreeModel *, gint index)
+{
+	return index == 0 ? G_TYPE_POINTER : G_TYPE_STRING;
+}
+static gboolean get_iter(GtkTreeModel *model, GtkTreeIter *iter, GtkTreePath *path)
+{
+	GtkColorListModelPrivate *ns = GET_PRIVATE(model);
+	if (gtk_tree_path_get_depth(path) != 1)
+		return false;
+	gint index = gtk_tree_path_get_indices(path)[0];
+	if (index < 0 || static_cast<size_t>(index) >= count(ns))
+		return false;
+	set_iter(ns, index, iter);
+	return true;
+}
+static GtkTreePath *get_path(GtkTreeModel *model, GtkTreeIter *iter)
+{
+	GtkColorListModelPrivate *ns = GET_PRIVATE(model);
+	g_return_val_if_fail(is_valid(ns, iter), nullptr);
+	return gtk_tree_path_new_from_indices(static_cast<gint>(GPOINTER_TO_SIZE(iter->user_data)), -1);
+}
+static void get_value(GtkTreeModel *model, GtkTreeIter *iter, gint column, GValue *value)
+{
+	GtkColorListModelPrivate *ns = GET_PRIVATE(model);
+	g_value_init(value, get_column_type(model, column));
+	g_return_if_fail(is_valid(ns, iter));
+	ColorObject *colorObject = at(ns, GPOINTER_TO_SIZE(iter->user_data));
+	if (column == 0)
+		g_value_set_pointer(value, colorObject);
+	else
+		g_value_set_string(value, colorObject->getName().c_str());
+}
+static gboolean iter_next(GtkTreeModel *model, GtkTreeIter *iter)
+{
+	GtkColorListModelPrivate *ns = GET_PRIVATE(model);
+	if (!is_valid(ns, iter))
+		return false;
+	size_t index = GPOINTER_TO_SIZE(iter->user_data) + 1;
+	if (index >= count(ns)) {
+		iter->stamp = 0;
+		return false;
+	}
+	set_iter(ns, index, iter);
+	return true;
+}
+static gboolean iter_nth_child(GtkTreeModel *model, GtkTreeIter *iter, GtkTreeIter *parent, gint n)
+{
+	GtkColorListModelPrivate *ns = GET_PRIVATE(model);
+	if (parent || n < 0 || static_cast<size_t>(n) >= count(ns))
+		return false;
+	set_iter(ns, n, iter);
+	return true;
+}
+static gboolean iter_children(GtkTreeModel *model, GtkTreeIter *iter, GtkTreeIter *parent)
+{
+	return iter_nth_child(model, iter, parent, 0);
+}
+static gboolean iter_has_child(GtkTreeModel *, GtkTreeIter *)
+{
+	return false;
+}
+static gint iter_n_children(GtkTreeModel *model, GtkTreeIter *iter)
+{
+	GtkColorListModelPrivate *ns = GET_PRIVATE(model);
+	if (iter)
+		return 0;
+	return static_cast<gint>(count(ns));
+}
+static gboolean iter_parent(GtkTreeModel *, GtkTreeIter *, GtkTreeIter *)
+{
+	return false;
+}
+static void tree_model_init(GtkTreeModelIface *iface)
+{
+	iface->get_flags = get_flags;
+	iface->get_n_columns = get_n_columns;
+	iface->get_column_type = get_column_type;
+	iface->get_iter = get_iter;
+	iface->get_path = get_path;
+	iface->get_value = get_value;
+	iface->iter_next = iter_next;
+	iface->iter_children = iter_children;
+	iface->iter_has_child = iter_has_child;
+	iface->iter_n_children = iter_n_children;
+	iface->iter_nth_child = iter_nth_child;
+	iface->iter_parent = iter_parent;
+}
+GtkTreeModel *gtk_color_list_model_new()
+{
+	return GTK_TREE_MODEL(g_object_new(GTK_TYPE_COLOR_LIST_MODEL, nullptr));
+}
+size_t gtk_color_list_model_size(GtkColorListModel *model)
+{
+	return count(GET_PRIVATE(model));
+}
+const std::vector<ColorObject *> &gtk_color_list_model_colors(GtkColorListModel *model)
+{
+	return GET_PRIVATE(model)->colors;
+}
+ColorObject *gtk_color_list_model_get(GtkColorListModel *model, size_t index)
+{
+	GtkColorListModelPrivate *ns = GET_PRIVATE(model);
+	if (index >= count(ns))
+		return nullptr;
+	return at(ns, index);
+}
+ColorObject *gtk_color_list_model_get(GtkColorListModel *model, GtkTreeIter *iter)
+{
+	GtkColorListModelPrivate *ns = GET_PRIVATE(model);
+	if (!is_valid(ns, iter))
+		return nullptr;
+	return at(ns, GPOINTER_TO_SIZE(iter->user_data));
+}
+size_t gtk_color_list_model_get_index(GtkColorListModel *, GtkTreeIter *iter)
+{
+	return GPOINTER_TO_SIZE(iter->user_data);
+}
+void gtk_color_list_model_get_iter(GtkColorListModel *model, size_t index, GtkTreeIter *iter)
+{
+	set_iter(GET_PRIVATE(model), index, iter);
+}
+static void emit_inserted(GtkColorListModel *model, size_t index)
+{
+	GtkTreeIter iter;
+	set_iter(GET_PRIVATE(model), index, &iter);
+	GtkTreePath *path = gtk_tree_path_new_from_indices(static_cast<gint>(index), -1);
+	gtk_tree_model_row_inserted(GTK_TREE_MODEL(model), path, &iter);
+	gtk_tree_path_free(path);
+}
+static void emit_deleted(GtkColorListModel *model, size_t index)
+{
+	GtkTreePath *path = gtk_tree_path_new_from_indices(static_cast<gint>(index), -1);
+	gtk_tree_model_row_deleted(GTK_TREE_MODEL(model), path);
+	gtk_tree_path_free(path);
+}
+void gtk_color_list_model_insert(GtkColorListModel *model, size_t index, ColorObject *colorObject)
+{
+	GtkColorListModelPrivate *ns = GET_PRIVATE(model);
+	if (index > ns->colors.size())
+		index = ns->colors.size();
+	ns->colors.insert(ns->colors.begin() + index, colorObject->reference());
+	emit_inserted(model, index);
+}
+void gtk_color_list_model_append(GtkColorListModel *model, ColorObject *colorObject)
+{
+	GtkColorListModelPrivate *ns = GET_PRIVATE(model);
+	ns->colors.push_back(colorObject->reference());
+	emit_inserted(model, ns->colors.size() - 1);
+}
+void gtk_color_list_model_set(GtkColorListModel *model, size_t index, ColorObject *colorObject)
+{
+	GtkColorListModelPrivate *ns = GET_PRIVATE(model);
+	if (index >= ns->colors.size())
+		return;
+	colorObject->reference();
+	ns->colors[index]->release();
+	ns->colors[index] = colorObject;
+}
+void gtk_color_list_model_changed(GtkColorListModel *model, size_t index)
+{
+	GtkColorListModelPrivate *ns = GET_PRIVATE(model);
+	if (index >= ns->colors.size())
+		return;
+	GtkTreeIter iter;
+	set_iter(ns, index, &iter);
+	GtkTreePath *path = gtk_tree_path_new_from_indices(static_cast<gint>(index), -1);
+	gtk_tree_model_row_changed(GTK_TREE_MODEL(model), path, &iter);
+	gtk_tree_path_free(path);
+}
+void gtk_color_list_model_remove(GtkColorListModel *model, size_t index)
+{
+	GtkColorListModelPrivate *ns = GET_PRIVATE(model);
+	if (index >= ns->colors.size())
+		return;
+	ColorObject *colorObject = ns->colors[index];
+	ns->colors.erase(ns->colors.begin() + index);
+	emit_deleted(model, index);
+	colorObject->release();
+}
+void gtk_color_list_model_remove_if(GtkColorListModel *model, std::function<bool(size_t, ColorObject *)> callback)
+{
+	GtkColorListModelPrivate *ns = GET_PRIVATE(model);
+	// Rows are visited from the end and moved into keptTail, so each row deletion signal sees the model
+	// in a consistent state without shifting remaining rows on every removal.
+	ns->keptTail.reserve(ns->colors.size());
+	while (!ns->colors.empty()) {
+		size_t index = ns->colors.size() - 1;
+		ColorObject *colorObject = ns->colors.back();
+		ns->colors.pop_back();
+		if (callback(index, colorObject)) {
+			emit_deleted(model, index);
+			colorObject->release();
+		} else {
+			ns->keptTail.push_back(colorObject);
+		}
+	}
+	ns->colors.assign(ns->keptTail.rbegin(), ns->keptTail.rend());
+	ns->keptTail.clear();
+	ns->keptTail.shrink_to_fit();
+}
+void gtk_color_list_model_clear(GtkColorListModel *model)
+{
+	GtkColorListModelPrivate *ns = GET_PRIVATE(model);
+	while (!ns->colors.empty()) {
+		ColorObject *colorObject = ns->colors.back();
+		ns->colors.pop_back();
+		emit_deleted(model, ns->colors.size());
+		colorObject->release();
+	}
+}
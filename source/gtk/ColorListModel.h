@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef GPICK_GTK_COLOR_LIST_MODEL_H_
+#define GPICK_GTK_COLOR_LIST_MODEL_H_
+
+#include <gtk/gtk.h>
+#include <vector>
+#include <functional>
+#include <cstddef>
+struct ColorObject;
+#define GTK_TYPE_COLOR_LIST_MODEL (gtk_color_list_model_get_type())
+#define GTK_COLOR_LIST_MODEL(obj) (G_TYPE_CHECK_INSTANCE_CAST((obj), GTK_TYPE_COLOR_LIST_MODEL, GtkColorListModel))
+#define GTK_COLOR_LIST_MODEL_CLASS(obj) (G_TYPE_CHECK_CLASS_CAST((obj), GTK_TYPE_COLOR_LIST_MODEL, GtkColorListModelClass))
+#define GTK_IS_COLOR_LIST_MODEL(obj) (G_TYPE_CHECK_INSTANCE_TYPE((obj), GTK_TYPE_COLOR_LIST_MODEL))
+#define GTK_IS_COLOR_LIST_MODEL_CLASS(obj) (G_TYPE_CHECK_CLASS_TYPE((obj), GTK_TYPE_COLOR_LIST_MODEL))
+#define GTK_COLOR_LIST_MODEL_GET_CLASS(obj) (G_TYPE_INSTANCE_GET_CLASS((obj), GTK_TYPE_COLOR_LIST_MODEL, GtkColorListModelClass))
+// Flat tree model holding referenced color object pointers.
+// Column 0 is a color object pointer, column 1 is a color name string generated when requested.
+struct GtkColorListModel
+{
+	GObject parent;
+};
+struct GtkColorListModelClass
+{
+	GObjectClass parent_class;
+};
+GtkTreeModel *gtk_color_list_model_new();
+size_t gtk_color_list_model_size(GtkColorListModel *model);
+const std::vector<ColorObject *> &gtk_color_list_model_colors(GtkColorListModel *model);
+ColorObject *gtk_color_list_model_get(GtkColorListModel *model, size_t index);
+ColorObject *gtk_color_list_model_get(GtkColorListModel *model, GtkTreeIter *iter);
+size_t gtk_color_list_model_get_index(GtkColorListModel *model, GtkTreeIter *iter);
+void gtk_color_list_model_get_iter(GtkColorListModel *model, size_t index, GtkTreeIter *iter);
+void gtk_color_list_model_insert(GtkColorListModel *model, size_t index, ColorObject *colorObject);
+void gtk_color_list_model_append(GtkColorListModel *model, ColorObject *colorObject);
+// Replaces row color object without emitting any signal, so multiple changes can be followed by a single view redraw.
+void gtk_color_list_model_set(GtkColorListModel *model, size_t index, ColorObject *colorObject);
+void gtk_color_list_model_changed(GtkColorListModel *model, size_t index);
+void gtk_color_list_model_remove(GtkColorListModel *model, size_t index);
+// Callback is called for each row starting from the last one.
+void gtk_color_list_model_remove_if(GtkColorListModel *model, std::function<bool(size_t, ColorObject *)> callback);
+void gtk_color_list_model_clear(GtkColorListModel *model);
+GType gtk_color_list_model_get_type();
+
+#endif /* GPICK_GTK_COLOR_LIST_MODEL_H_ */
@@ -21,6 +21,7 @@
 #include "math/Vector.h"
 #include <iomanip>
 #include <algorithm>
+#include <cstring>
 #include <sstream>
 #include <vector>
 enum {
@@ -43,6 +44,10 @@ struct GtkZoomedPrivate {
 	math::Vector2i pointer;
 	math::Rectangle<int> screen_rect;
 	bool fade;
+	// Source pixels of last update and mapping from widget pixels to source pixels.
+	std::vector<uint32_t> source;
+	math::Rectangle<int> source_rect;
+	std::vector<int> source_columns, source_rows;
 #if GTK_MAJOR_VERSION >= 3
 	GtkStyleContext *context;
 #endif
@@ -95,6 +100,7 @@ GtkWidget* gtk_zoomed_new()
 {
 	GtkWidget* widget = (GtkWidget*)g_object_new(GTK_TYPE_ZOOMED, nullptr);
 	GtkZoomedPrivate *ns = GET_PRIVATE(widget);
+	new (ns) GtkZoomedPrivate();
 	ns->fade = false;
 	ns->zoom = 20;
 	ns->point.x = 0;
@@ -122,6 +128,7 @@ void gtk_zoomed_set_size(GtkZoomed *zoomed, int32_t width_height)
 		}
 		ns->width_height = width_height;
 		ns->surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, ns->width_height, ns->width_height);
+		ns->source.clear();
 #if GTK_MAJOR_VERSION >= 3
 		gtk_widget_set_size_request(GTK_WIDGET(zoomed), ns->width_height, ns->width_height);
 #else
@@ -145,12 +152,20 @@ static void finalize(GObject *zoomed_obj)
 #if GTK_MAJOR_VERSION >= 3
 	g_object_unref(ns->context);
 #endif
+	ns->~GtkZoomedPrivate();
 	G_OBJECT_CLASS(g_type_class_peek_parent(G_OBJECT_CLASS(GTK_ZOOMED_GET_CLASS(zoomed_obj))))->finalize(zoomed_obj);
 }
 static double zoom_transformation(double value)
 {
 	return (1 - log(1 + value * 0.01 * 3) / log((double)(1 + 3))) / 2;
 }
+int32_t gtk_zoomed_get_area_size(GtkZoomed *zoomed)
+{
+	GtkZoomedPrivate *ns = GET_PRIVATE(zoomed);
+	gint32 area_width = uint32_t(ns->width_height * zoom_transformation(ns->zoom));
+	if (!area_width) area_width = 1;
+	return area_width;
+}
 void gtk_zoomed_get_current_screen_rect(GtkZoomed* zoomed, math::Rectangle<int> *rect)
 {
 	GtkZoomedPrivate *ns = GET_PRIVATE(zoomed);
@@ -219,6 +234,134 @@ math::Vector2i gtk_zoomed_get_screen_position(GtkZoomed *zoomed, const math::Vec
 	math::Vector2i result(static_cast<int>((xl + xh) / 2.0f), static_cast<int>((yl + yh) / 2.0f));
 	return result;
 }
+static void map_to_source(std::vector<int> &mapping, int size, int source_size)
+{
+	mapping.resize(size);
+	for (int i = 0; i < size; i++)
+		mapping[i] = static_cast<int>((int64_t(i) * 2 + 1) * source_size / (int64_t(size) * 2));
+}
+static uint32_t *surface_row(cairo_surface_t *surface, int y)
+{
+	return reinterpret_cast<uint32_t *>(cairo_image_surface_get_data(surface) + y * cairo_image_surface_get_stride(surface));
+}
+/**
+ * Nearest neighbor scale source pixels into part of zoomed surface. Widget rows mapping to the same source row are copied.
+ */
+static void scale_region(GtkZoomedPrivate *ns, const std::vector<uint32_t> &pixels, int width, int x1, int y1, int x2, int y2)
+{
+	const int *columns = ns->source_columns.data();
+	for (int y = y1; y < y2; y++){
+		uint32_t *row = surface_row(ns->surface, y);
+		if (y > y1 && ns->source_rows[y] == ns->source_rows[y - 1]){
+			const uint32_t *previous_row = surface_row(ns->surface, y - 1);
+			std::copy(previous_row + x1, previous_row + x2, row + x1);
+			continue;
+		}
+		const uint32_t *source_row = &pixels[ns->source_rows[y] * width];
+		for (int x = x1; x < x2; x++)
+			row[x] = source_row[columns[x]];
+	}
+}
+static bool same_pixels(const std::vector<uint32_t> &a, const math::Rectangle<int> &a_rect, const std::vector<uint32_t> &b, const math::Rectangle<int> &b_rect, int left, int top, int right, int bottom)
+{
+	for (int y = top; y < bottom; y++){
+		const uint32_t *a_row = &a[(y - a_rect.getY()) * a_rect.getWidth() + left - a_rect.getX()];
+		const uint32_t *b_row = &b[(y - b_rect.getY()) * b_rect.getWidth() + left - b_rect.getX()];
+		if (!std::equal(a_row, a_row + (right - left), b_row))
+			return false;
+	}
+	return true;
+}
+/**
+ * Scale screen area into zoomed surface directly, updating only parts which changed since last update.
+ * @return False if source surface can not be accessed directly.
+ */
+static bool scale_area(GtkZoomedPrivate *ns, const math::Rectangle<int> &area, const math::Vector2i &offset, cairo_surface_t *surface, math::Rectangle<int> *dirty)
+{
+	if (!ns->surface || cairo_surface_get_type(surface) != CAIRO_SURFACE_TYPE_IMAGE)
+		return false;
+	auto format = cairo_image_surface_get_format(surface);
+	if (format != CAIRO_FORMAT_RGB24 && format != CAIRO_FORMAT_ARGB32)
+		return false;
+	int width = area.getWidth(), height = area.getHeight();
+	int source_x = -offset.x, source_y = -offset.y;
+	if (width <= 0 || height <= 0 || source_x < 0 || source_y < 0 || source_x + width > cairo_image_surface_get_width(surface) || source_y + height > cairo_image_surface_get_height(surface))
+		return false;
+	cairo_surface_flush(surface);
+	std::vector<uint32_t> pixels(width * height);
+	for (int y = 0; y < height; y++){
+		const uint32_t *row = surface_row(surface, source_y + y) + source_x;
+		for (int x = 0; x < width; x++)
+			pixels[x + y * width] = row[x] | 0xff000000;
+	}
+	int size = ns->width_height;
+	bool same_size = !ns->source.empty() && ns->source_rect.getWidth() == width && ns->source_rect.getHeight() == height;
+	if (!same_size){
+		map_to_source(ns->source_columns, size, width);
+		map_to_source(ns->source_rows, size, height);
+	}
+	cairo_surface_flush(ns->surface);
+	if (same_size && area == ns->source_rect){
+		// Area did not move, so only changed pixels need to be scaled.
+		int left = width, top = height, right = 0, bottom = 0;
+		for (int y = 0; y < height; y++){
+			for (int x = 0; x < width; x++){
+				if (pixels[x + y * width] != ns->source[x + y * width]){
+					left = std::min(left, x);
+					right = std::max(right, x + 1);
+					top = std::min(top, y);
+					bottom = std::max(bottom, y + 1);
+				}
+			}
+		}
+		if (left >= right){
+			*dirty = math::Rectangle<int>();
+			return true;
+		}
+		int x1 = static_cast<int>(std::lower_bound(ns->source_columns.begin(), ns->source_columns.end(), left) - ns->source_columns.begin());
+		int x2 = static_cast<int>(std::lower_bound(ns->source_columns.begin(), ns->source_columns.end(), right) - ns->source_columns.begin());
+		int y1 = static_cast<int>(std::lower_bound(ns->source_rows.begin(), ns->source_rows.end(), top) - ns->source_rows.begin());
+		int y2 = static_cast<int>(std::lower_bound(ns->source_rows.begin(), ns->source_rows.end(), bottom) - ns->source_rows.begin());
+		scale_region(ns, pixels, width, x1, y1, x2, y2);
+		*dirty = math::Rectangle<int>(x1, y1, x2, y2);
+	}else{
+		int move_x = area.getX() - ns->source_rect.getX(), move_y = area.getY() - ns->source_rect.getY();
+		bool integer_scale = size % width == 0 && size % height == 0;
+		bool shifted = false;
+		if (same_size && integer_scale && std::abs(move_x) < width && std::abs(move_y) < height){
+			math::Rectangle<int> overlap(std::max(area.getLeft(), ns->source_rect.getLeft()), std::max(area.getTop(), ns->source_rect.getTop()), std::min(area.getRight(), ns->source_rect.getRight()), std::min(area.getBottom(), ns->source_rect.getBottom()));
+			if (same_pixels(pixels, area, ns->source, ns->source_rect, overlap.getLeft(), overlap.getTop(), overlap.getRight(), overlap.getBottom())){
+				// Pointer moved by whole pixels at integer scale: shift already scaled pixels and scale only exposed strips.
+				int shift_x = -move_x * (size / width), shift_y = -move_y * (size / height);
+				int row_length = size - std::abs(shift_x);
+				int to_x = std::max(0, shift_x), from_x = std::max(0, -shift_x);
+				if (shift_y >= 0){
+					for (int y = size - 1; y >= shift_y; y--)
+						std::memmove(surface_row(ns->surface, y) + to_x, surface_row(ns->surface, y - shift_y) + from_x, row_length * sizeof(uint32_t));
+				}else{
+					for (int y = 0; y < size + shift_y; y++)
+						std::memmove(surface_row(ns->surface, y) + to_x, surface_row(ns->surface, y - shift_y) + from_x, row_length * sizeof(uint32_t));
+				}
+				if (shift_y > 0)
+					scale_region(ns, pixels, width, 0, 0, size, shift_y);
+				else if (shift_y < 0)
+					scale_region(ns, pixels, width, 0, size + shift_y, size, size);
+				if (shift_x > 0)
+					scale_region(ns, pixels, width, 0, 0, shift_x, size);
+				else if (shift_x < 0)
+					scale_region(ns, pixels, width, size + shift_x, 0, size, size);
+				shifted = true;
+			}
+		}
+		if (!shifted)
+			scale_region(ns, pixels, width, 0, 0, size, size);
+		*dirty = math::Rectangle<int>(0, 0, size, size);
+	}
+	cairo_surface_mark_dirty(ns->surface);
+	ns->source.swap(pixels);
+	ns->source_rect = area;
+	return true;
+}
 void gtk_zoomed_update(GtkZoomed *zoomed, math::Vector2i &pointer, math::Rectangle<int>& screen_rect, math::Vector2i &offset, cairo_surface_t *surface)
 {
 	GtkZoomedPrivate *ns = GET_PRIVATE(zoomed);
@@ -252,19 +395,36 @@ void gtk_zoomed_update(GtkZoomed *zoomed, math::Vector2i &pointer, math::Rectang
 	gint32 xh = (((x + 1) - left) * ns->width_height) / area_width;
 	gint32 yl = ((y - top) * ns->width_height) / area_width;
 	gint32 yh = (((y + 1) - top) * ns->width_height) / area_width;
+	math::Vector2f previous_point = ns->point, previous_point_size = ns->pointSize;
 	ns->point.x = (xl + xh) / 2.0f;
 	ns->point.y = (yl + yh) / 2.0f;
 	ns->pointSize.x = xh - xl;
 	ns->pointSize.y = yh - yl;
-	int width = right - left;
-	int height = bottom - top;
-	cairo_t *cr = cairo_create(ns->surface);
-	cairo_scale(cr, ns->width_height / (double)width, ns->width_height / (double)height);
-	cairo_set_source_surface(cr, surface, offset.x, offset.y);
-	cairo_pattern_set_filter(cairo_get_source(cr), CAIRO_FILTER_NEAREST);
-	cairo_rectangle(cr, 0, 0, ns->width_height, ns->width_height);
-	cairo_fill(cr);
-	cairo_destroy(cr);
+	math::Rectangle<int> area(left, top, right, bottom);
+	math::Rectangle<int> dirty;
+	if (!scale_area(ns, area, offset, surface, &dirty)){
+		ns->source.clear();
+		int width = right - left;
+		int height = bottom - top;
+		cairo_t *cr = cairo_create(ns->surface);
+		cairo_scale(cr, ns->width_height / (double)width, ns->width_height / (double)height);
+		cairo_set_source_surface(cr, surface, offset.x, offset.y);
+		cairo_pattern_set_filter(cairo_get_source(cr), CAIRO_FILTER_NEAREST);
+		cairo_rectangle(cr, 0, 0, ns->width_height, ns->width_height);
+		cairo_fill(cr);
+		cairo_destroy(cr);
+		dirty = math::Rectangle<int>(0, 0, ns->width_height, ns->width_height);
+	}
+	bool overlay_changed = previous_point.x != ns->point.x || previous_point.y != ns->point.y || previous_point_size.x != ns->pointSize.x || previous_point_size.y != ns->pointSize.y;
+	if (!overlay_changed){
+		if (dirty.isEmpty())
+			return;
+#if GTK_MAJOR_VERSION >= 3
+		// Marks and pointer overlay did not move, so only changed part of the widget needs repainting.
+		gtk_widget_queue_draw_area(GTK_WIDGET(zoomed), dirty.getX(), dirty.getY(), dirty.getWidth(), dirty.getHeight());
+		return;
+#endif
+	}
 	gtk_widget_queue_draw(GTK_WIDGET(zoomed));
 }
 void gtk_zoomed_set_zoom(GtkZoomed *zoomed, gfloat zoom)
@@ -51,6 +51,7 @@ void gtk_zoomed_set_mark(GtkZoomed *zoomed, int index, math::Vector2i &position)
 void gtk_zoomed_clear_mark(GtkZoomed *zoomed, int index);
 void gtk_zoomed_update(GtkZoomed* zoomed, math::Vector2i &pointer, math::Rectangle<int>& screen_rect, math::Vector2i &offset, cairo_surface_t *surface);
 void gtk_zoomed_get_screen_rect(GtkZoomed* zoomed, math::Vector2i &pointer, math::Rectangle<int>& screen_rect, math::Rectangle<int> *rect);
+int32_t gtk_zoomed_get_area_size(GtkZoomed *zoomed);
 GType gtk_zoomed_get_type();
 
 #endif /* GPICK_GTK_ZOOMED_H_ */
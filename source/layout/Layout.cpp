@@ -38,7 +38,14 @@ const std::string &Layout::label() const {
 const int Layout::mask() const {
 	return m_mask;
 }
+const common::CallStatistics &Layout::buildCalls() const {
+	return m_buildCalls;
+}
+void Layout::resetStatistics() {
+	m_buildCalls.reset();
+}
 common::Ref<System> Layout::build() {
+	common::CallTimer timer(m_buildCalls);
 	lua_State *L = m_callback.script();
 	m_callback.get();
 	common::Ref<System> system(new System());
@@ -49,6 +56,7 @@ common::Ref<System> Layout::build() {
 	} else {
 		std::cerr << "layout.build: " << lua_tostring(L, -1) << '\n';
 	}
+	timer.error();
 	lua_pop(L, 1);
 	return common::nullRef;
 }
@@ -20,6 +20,7 @@
 #define GPICK_LAYOUT_LAYOUT_H_
 #include "lua/Ref.h"
 #include "common/Ref.h"
+#include "common/CallStatistics.h"
 #include <string>
 #include <string_view>
 namespace layout {
@@ -30,10 +31,13 @@ struct Layout {
 	const std::string &label() const;
 	const int mask() const;
 	common::Ref<System> build();
+	const common::CallStatistics &buildCalls() const;
+	void resetStatistics();
 private:
 	std::string m_name, m_label;
 	int m_mask;
 	lua::Ref m_callback;
+	common::CallStatistics m_buildCalls;
 };
 }
 #endif /* GPICK_LAYOUT_LAYOUT_H_ */
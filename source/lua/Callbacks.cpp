@@ -40,4 +40,17 @@ void Callbacks::componentToText(Ref &&ref)
 {
 	m_component_to_text = move(ref);
 }
+common::CallStatistics &Callbacks::optionChangeCalls()
+{
+	return m_option_change_calls;
+}
+common::CallStatistics &Callbacks::componentToTextCalls()
+{
+	return m_component_to_text_calls;
+}
+void Callbacks::resetStatistics()
+{
+	m_option_change_calls.reset();
+	m_component_to_text_calls.reset();
+}
 }
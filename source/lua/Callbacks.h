@@ -19,6 +19,7 @@
 #ifndef GPICK_LUA_CALLBACKS_H_
 #define GPICK_LUA_CALLBACKS_H_
 #include "Ref.h"
+#include "common/CallStatistics.h"
 namespace lua
 {
 struct Callbacks
@@ -30,9 +31,14 @@ struct Callbacks
 	void optionChange(Ref &&ref);
 	Ref &componentToText();
 	void componentToText(Ref &&ref);
+	common::CallStatistics &optionChangeCalls();
+	common::CallStatistics &componentToTextCalls();
+	void resetStatistics();
 	private:
 	Ref m_option_change;
 	Ref m_component_to_text;
+	common::CallStatistics m_option_change_calls;
+	common::CallStatistics m_component_to_text_calls;
 };
 }
 #endif /* GPICK_LUA_CALLBACKS_H_ */
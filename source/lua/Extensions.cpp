@@ -25,6 +25,7 @@
 #include "I18N.h"
 #include "GlobalState.h"
 #include "Callbacks.h"
+#include "StatePool.h"
 #include "Lua.h"
 #include "../GlobalState.h"
 #include "../layout/Layouts.h"
@@ -40,8 +41,18 @@ static void checkArgumentIsFunctionOrNil(lua_State *L, int index)
 	bool type_matches = type == LUA_TFUNCTION || type == LUA_TNIL;
 	luaL_argcheck(L, type_matches, index, "function or nil expected");
 }
+// Worker states of state pool only collect converter serialize functions and option change callback.
+static bool isWorker(lua_State *L)
+{
+	lua_getfield(L, LUA_REGISTRYINDEX, StatePool::convertersKey);
+	bool result = lua_istable(L, -1);
+	lua_pop(L, 1);
+	return result;
+}
 static int addLayout(lua_State *L)
 {
+	if (isWorker(L))
+		return 0;
 	const char *name = luaL_checkstring(L, 2);
 	const char *label = luaL_checkstring(L, 3);
 	checkArgumentIsFunctionOrNil(L, 4);
@@ -55,19 +66,55 @@ static int addConverter(lua_State *L)
 	const char *label = luaL_checkstring(L, 3);
 	checkArgumentIsFunctionOrNil(L, 4);
 	if (lua_gettop(L) >= 5) checkArgumentIsFunctionOrNil(L, 5);
+	if (lua_gettop(L) >= 6) checkArgumentIsFunctionOrNil(L, 6);
+	if (lua_gettop(L) >= 7 && !lua_isnil(L, 7)) luaL_checktype(L, 7, LUA_TTABLE);
+	if (isWorker(L)) {
+		lua_getfield(L, LUA_REGISTRYINDEX, StatePool::convertersKey);
+		lua_pushvalue(L, 4);
+		lua_setfield(L, -2, name);
+		lua_pop(L, 1);
+		return 0;
+	}
+	Converter *converter = nullptr;
 	if (lua_gettop(L) == 4)
-		getGlobalState(L).converters().add(new Converter(name, label, Ref(L, 4), Ref()));
-	else if (lua_gettop(L) >= 5)
-		getGlobalState(L).converters().add(new Converter(name, label, Ref(L, 4), Ref(L, 5)));
+		converter = new Converter(name, label, Ref(L, 4), Ref());
+	else if (lua_gettop(L) == 5)
+		converter = new Converter(name, label, Ref(L, 4), Ref(L, 5));
+	else if (lua_gettop(L) >= 6)
+		converter = new Converter(name, label, Ref(L, 4), Ref(L, 5), lua_isnil(L, 6) ? Ref() : Ref(L, 6));
+	if (!converter)
+		return 0;
+	if (lua_gettop(L) >= 7 && lua_istable(L, 7)) {
+		// Optional list of substrings which text must contain for deserialize function to be called.
+		auto classes = CharacterClass::none;
+		std::vector<std::string> substrings;
+		for (lua_Integer i = 1, count = lua_rawlen(L, 7); i <= count; i++) {
+			lua_rawgeti(L, 7, i);
+			if (lua_type(L, -1) == LUA_TSTRING) {
+				substrings.emplace_back(lua_tostring(L, -1));
+				classes = classes | ConverterSignature::classify(substrings.back());
+			}
+			lua_pop(L, 1);
+		}
+		converter->signature(ConverterSignature(classes, std::move(substrings)));
+	}
+	getGlobalState(L).converters().add(converter);
 	return 0;
 }
 static int setOptionChangeCallback(lua_State *L)
 {
+	if (isWorker(L)) {
+		lua_pushvalue(L, 2);
+		lua_setfield(L, LUA_REGISTRYINDEX, StatePool::optionChangeKey);
+		return 0;
+	}
 	getGlobalState(L).callbacks().optionChange(Ref(L, 2));
 	return 0;
 }
 static int setComponentToTextCallback(lua_State *L)
 {
+	if (isWorker(L))
+		return 0;
 	getGlobalState(L).callbacks().componentToText(Ref(L, 2));
 	return 0;
 }
@@ -19,17 +19,22 @@
 #include "Script.h"
 #include "Lua.h"
 #include <sstream>
+#include <fstream>
 #include <iostream>
+#include <filesystem>
+#include <cstdlib>
 using namespace std;
 namespace lua
 {
-Script::Script()
+Script::Script():
+	m_load_statistics()
 {
 	m_state = luaL_newstate();
 	m_state_owned = true;
 	luaL_openlibs(m_state);
 }
-Script::Script(lua_State *state)
+Script::Script(lua_State *state):
+	m_load_statistics()
 {
 	m_state = state;
 	m_state_owned = false;
@@ -83,6 +88,154 @@ void Script::setPaths(const std::vector<std::string> &include_paths)
 	lua_settable(m_state, -3);
 	lua_pop(m_state, 1);
 }
+static const char cacheMagic[] = "gpick lua bytecode 1";
+static string cacheKey(const char *path, uintmax_t size, int64_t modified)
+{
+	stringstream ss;
+	ss << cacheMagic << '\n' << LUA_RELEASE << '\n' << path << '\n' << size << '\n' << modified << '\n';
+	return ss.str();
+}
+static string cacheFilename(const string &cache_path, const char *path)
+{
+	stringstream ss;
+	ss << hex << std::hash<string>()(path) << ".luac";
+	return (filesystem::path(cache_path) / ss.str()).string();
+}
+static bool readFile(const string &filename, string &data)
+{
+	ifstream file(filename, ios::in | ios::binary);
+	if (!file.is_open())
+		return false;
+	stringstream ss;
+	ss << file.rdbuf();
+	data = ss.str();
+	return file.good() || file.eof();
+}
+static void writeFile(const string &filename, const string &data)
+{
+	// Write to temporary file first, so that concurrently starting instances never see partial cache file.
+	auto tmpFilename = filename + "." + to_string(chrono::system_clock::now().time_since_epoch().count());
+	{
+		ofstream file(tmpFilename, ios::out | ios::binary | ios::trunc);
+		if (!file.is_open())
+			return;
+		file.write(data.data(), data.size());
+		if (!file.good()) {
+			file.close();
+			error_code ec;
+			filesystem::remove(tmpFilename, ec);
+			return;
+		}
+	}
+	error_code ec;
+	filesystem::rename(tmpFilename, filename, ec);
+	if (ec)
+		filesystem::remove(tmpFilename, ec);
+}
+static int writeChunk(lua_State *, const void *data, size_t size, void *user_data)
+{
+	static_cast<string*>(user_data)->append(static_cast<const char*>(data), size);
+	return 0;
+}
+bool Script::loadCached(const char *path)
+{
+	using namespace std::chrono;
+	lua_State *L = m_state;
+	auto start = steady_clock::now();
+	error_code ec;
+	auto size = filesystem::file_size(path, ec);
+	int64_t modified = 0;
+	if (!ec)
+		modified = static_cast<int64_t>(filesystem::last_write_time(path, ec).time_since_epoch().count());
+	string key, filename;
+	if (!ec) {
+		key = cacheKey(path, size, modified);
+		filename = cacheFilename(m_cache_path, path);
+		string data;
+		if (readFile(filename, data) && data.compare(0, key.size(), key) == 0) {
+			// Key is followed by source compilation time in microseconds and bytecode.
+			auto end = data.find('\n', key.size());
+			if (end != string::npos) {
+				auto compileTime = microseconds(strtoll(data.c_str() + key.size(), nullptr, 10));
+				string chunkName = string("@") + path;
+				if (luaL_loadbufferx(L, data.data() + end + 1, data.size() - end - 1, chunkName.c_str(), "b") == 0) {
+					auto loadTime = duration_cast<microseconds>(steady_clock::now() - start);
+					m_load_statistics.cached++;
+					m_load_statistics.loadTime += loadTime;
+					if (compileTime > loadTime)
+						m_load_statistics.savedTime += compileTime - loadTime;
+					return true;
+				}
+				lua_pop(L, 1);
+			}
+		}
+	}
+	start = steady_clock::now();
+	if (luaL_loadfilex(L, path, nullptr) != 0)
+		return false;
+	auto compileTime = duration_cast<microseconds>(steady_clock::now() - start);
+	m_load_statistics.compiled++;
+	m_load_statistics.loadTime += compileTime;
+	if (key.empty())
+		return true;
+	string bytecode;
+#if LUA_VERSION_NUM >= 503
+	int status = lua_dump(L, writeChunk, &bytecode, 0);
+#else
+	int status = lua_dump(L, writeChunk, &bytecode);
+#endif
+	if (status != 0)
+		return true;
+	filesystem::create_directories(m_cache_path, ec);
+	writeFile(filename, key + to_string(compileTime.count()) + '\n' + bytecode);
+	return true;
+}
+int Script::searchCached(lua_State *L)
+{
+	auto &script = *static_cast<Script*>(lua_touserdata(L, lua_upvalueindex(1)));
+	const char *name = luaL_checkstring(L, 1);
+	if (script.m_cache_path.empty())
+		return 0;
+	lua_getglobal(L, "package");
+	lua_getfield(L, -1, "searchpath");
+	lua_pushstring(L, name);
+	lua_getfield(L, -3, "path");
+	lua_call(L, 2, 1);
+	if (lua_type(L, -1) != LUA_TSTRING)
+		return 0;
+	const char *path = lua_tostring(L, -1);
+	if (!script.loadCached(path))
+		return luaL_error(L, "error loading module '%s' from file '%s':\n\t%s", name, path, lua_tostring(L, -1));
+	lua_pushvalue(L, -2);
+	return 2;
+}
+void Script::setCachePath(const std::string &cache_path)
+{
+	lua_State *L = m_state;
+	bool installed = !m_cache_path.empty();
+	m_cache_path = cache_path;
+	if (installed || cache_path.empty())
+		return;
+	lua_getglobal(L, "package");
+	lua_getfield(L, -1, "searchers");
+	if (!lua_istable(L, -1)) {
+		lua_pop(L, 2);
+		return;
+	}
+	// Cached searcher is inserted after preload searcher, so it is used instead of source file searcher.
+	for (lua_Integer i = lua_rawlen(L, -1); i >= 2; i--) {
+		lua_rawgeti(L, -1, i);
+		lua_rawseti(L, -2, i + 1);
+	}
+	lua_pushlightuserdata(L, this);
+	lua_pushcclosure(L, searchCached, 1);
+	lua_rawseti(L, -2, 2);
+	lua_pop(L, 2);
+}
+const Script::LoadStatistics &Script::loadStatistics() const
+{
+	return m_load_statistics;
+}
 bool Script::load(const char *script_name)
 {
 	int status;
@@ -21,17 +21,27 @@
 #include <vector>
 #include <string>
 #include <functional>
+#include <chrono>
+#include <cstdint>
 struct lua_State;
 struct luaL_Reg;
 namespace lua
 {
 struct Script
 {
+	struct LoadStatistics
+	{
+		uint32_t cached, compiled;
+		// Time spent loading modules, and estimated time saved by loading bytecode instead of compiling source.
+		std::chrono::microseconds loadTime, savedTime;
+	};
 	Script();
 	Script(lua_State *L);
 	~Script();
 	operator lua_State*();
 	void setPaths(const std::vector<std::string> &include_paths);
+	// Enables bytecode cache for modules loaded with require. Cached bytecode is used only if source path, size, modification time and Lua version match.
+	void setCachePath(const std::string &cache_path);
 	bool load(const char *script_name);
 	bool loadCode(const char *script_code);
 	bool run(int arguments_on_stack, int results);
@@ -39,10 +49,15 @@ struct Script
 	void createType(const char *name, const luaL_Reg *members);
 	const std::string &getLastError();
 	std::string getString(int index);
+	const LoadStatistics &loadStatistics() const;
 	private:
 	lua_State *m_state;
 	bool m_state_owned;
 	std::string m_last_error;
+	std::string m_cache_path;
+	LoadStatistics m_load_statistics;
+	static int searchCached(lua_State *L);
+	bool loadCached(const char *path);
 };
 }
 #endif /* GPICK_LUA_SCRIPT_H_ */
@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "StatePool.h"
+#include "Script.h"
+#include "ColorObject.h"
+#include "Lua.h"
+#include "../ColorObject.h"
+#include <thread>
+#include <system_error>
+#include <algorithm>
+#include <iostream>
+namespace lua
+{
+const char *StatePool::convertersKey = "gpick.statePool.converters";
+const char *StatePool::optionChangeKey = "gpick.statePool.optionChange";
+StatePool::StatePool(size_t size, Callback initialize, Callback prepare):
+	m_size(size),
+	m_initialize(initialize),
+	m_prepare(prepare),
+	m_failed(false)
+{
+}
+StatePool::~StatePool()
+{
+}
+size_t StatePool::size() const
+{
+	return m_size;
+}
+bool StatePool::initialize()
+{
+	if (m_failed)
+		return false;
+	if (!m_workers.empty())
+		return true;
+	for (size_t i = 0; i < m_size; i++) {
+		auto script = std::make_unique<Script>();
+		lua_State *L = *script;
+		lua_newtable(L);
+		lua_setfield(L, LUA_REGISTRYINDEX, convertersKey);
+		if (!m_initialize(*script)) {
+			m_workers.clear();
+			m_failed = true;
+			return false;
+		}
+		m_workers.push_back(std::move(script));
+	}
+	return !m_workers.empty();
+}
+static bool pushConverter(lua_State *L, const std::string &converterName)
+{
+	lua_getfield(L, LUA_REGISTRYINDEX, StatePool::convertersKey);
+	lua_getfield(L, -1, converterName.c_str());
+	lua_remove(L, -2);
+	if (lua_type(L, -1) == LUA_TFUNCTION)
+		return true;
+	lua_pop(L, 1);
+	return false;
+}
+bool StatePool::serialize(const std::string &converterName, const std::vector<const ColorObject *> &colorObjects, std::vector<std::string> &result, size_t &errors)
+{
+	if (colorObjects.empty() || !initialize())
+		return false;
+	size_t workerCount = std::min(m_workers.size(), colorObjects.size());
+	for (size_t i = 0; i < workerCount; i++) {
+		if (!m_prepare(*m_workers[i]))
+			return false;
+		lua_State *L = *m_workers[i];
+		if (!pushConverter(L, converterName))
+			return false;
+		lua_pop(L, 1);
+	}
+	result.resize(colorObjects.size());
+	size_t chunkSize = (colorObjects.size() + workerCount - 1) / workerCount;
+	std::vector<std::thread> threads;
+	threads.reserve(workerCount);
+	std::vector<size_t> chunkErrors(workerCount, 0);
+	bool started = true;
+	for (size_t i = 0; i < workerCount; i++) {
+		size_t begin = i * chunkSize, end = std::min(begin + chunkSize, colorObjects.size());
+		if (begin >= end)
+			break;
+		lua_State *L = *m_workers[i];
+		try {
+			threads.emplace_back([L, begin, end, &converterName, &colorObjects, &result, &chunkError = chunkErrors[i]]() {
+				int stackTop = lua_gettop(L);
+				pushConverter(L, converterName);
+				chunkError = serializeColorObjects(L, -1, converterName, colorObjects, begin, end, &result[begin]);
+				lua_settop(L, stackTop);
+			});
+		} catch (const std::system_error &e) {
+			std::cerr << "serialize: could not start worker thread: " << e.what() << '\n';
+			started = false;
+			break;
+		}
+	}
+	for (auto &thread: threads)
+		thread.join();
+	errors = 0;
+	for (auto chunkError: chunkErrors)
+		errors += chunkError;
+	return started;
+}
+StatePool *StatePool::get(lua_State *L)
+{
+	lua_pushglobaltable(L);
+	lua_getfield(L, -1, "__state_pool");
+	auto statePool = static_cast<StatePool*>(lua_touserdata(L, -1));
+	lua_pop(L, 2);
+	return statePool;
+}
+void StatePool::set(lua_State *L, StatePool *statePool)
+{
+	lua_pushglobaltable(L);
+	lua_pushlightuserdata(L, statePool);
+	lua_setfield(L, -2, "__state_pool");
+	lua_pop(L, 1);
+}
+size_t serializeColorObjects(lua_State *L, int functionIndex, const std::string &converterName, const std::vector<const ColorObject *> &colorObjects, size_t begin, size_t end, std::string *output)
+{
+	functionIndex = lua_absindex(L, functionIndex);
+	int stackTop = lua_gettop(L);
+	size_t count = colorObjects.size();
+	ColorObject tmp;
+	pushColorObject(L, &tmp);
+	int colorObjectIndex = lua_gettop(L);
+	lua_newtable(L);
+	int positionIndex = lua_gettop(L);
+	lua_pushinteger(L, count);
+	lua_setfield(L, positionIndex, "count");
+	size_t errors = 0;
+	for (size_t i = begin; i < end; i++) {
+		tmp = *colorObjects[i];
+		lua_pushboolean(L, i == 0);
+		lua_setfield(L, positionIndex, "first");
+		lua_pushboolean(L, i + 1 >= count);
+		lua_setfield(L, positionIndex, "last");
+		lua_pushinteger(L, i);
+		lua_setfield(L, positionIndex, "index");
+		lua_pushvalue(L, functionIndex);
+		lua_pushvalue(L, colorObjectIndex);
+		lua_pushvalue(L, positionIndex);
+		auto &value = output[i - begin];
+		int status = lua_pcall(L, 2, 1, 0);
+		if (status == 0) {
+			if (lua_type(L, -1) == LUA_TSTRING) {
+				size_t length;
+				const char *string = lua_tolstring(L, -1, &length);
+				value.assign(string, length);
+			} else {
+				std::cerr << "serialize: returned not a string value \"" << converterName << "\"\n";
+				value.clear();
+				errors++;
+			}
+		} else {
+			std::cerr << "serialize: " << lua_tostring(L, -1) << '\n';
+			value.clear();
+			errors++;
+		}
+		lua_settop(L, positionIndex);
+	}
+	lua_settop(L, stackTop);
+	return errors;
+}
+}
@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef GPICK_LUA_STATE_POOL_H_
+#define GPICK_LUA_STATE_POOL_H_
+#include <vector>
+#include <string>
+#include <memory>
+#include <functional>
+#include <cstddef>
+struct lua_State;
+struct ColorObject;
+namespace lua
+{
+struct Script;
+// Worker Lua states, which load the same scripts as the main state, but keep only converter serialize functions. Used to serialize large color lists in parallel.
+struct StatePool
+{
+	// Registry keys of converter serialize function table and option change callback in worker states.
+	static const char *convertersKey;
+	static const char *optionChangeKey;
+	using Callback = std::function<bool(Script &script)>;
+	// Worker states are created on first use by calling initialize. Prepare is called for each worker before every serialization.
+	StatePool(size_t size, Callback initialize, Callback prepare);
+	~StatePool();
+	size_t size() const;
+	// Splits colors into contiguous chunks, one for each worker state, and serializes them using named converter. Returns false if worker states are not available or converter is missing.
+	bool serialize(const std::string &converterName, const std::vector<const ColorObject *> &colorObjects, std::vector<std::string> &result, size_t &errors);
+	static StatePool *get(lua_State *L);
+	static void set(lua_State *L, StatePool *statePool);
+	private:
+	size_t m_size;
+	Callback m_initialize, m_prepare;
+	std::vector<std::unique_ptr<Script>> m_workers;
+	bool m_failed;
+	bool initialize();
+};
+// Calls serialize function at functionIndex for colors in range [begin, end) and returns number of failed calls. Position is filled in using color index in the whole list. Color object userdata and position table are created once and updated before each call, so serialize function must not keep references to them.
+size_t serializeColorObjects(lua_State *L, int functionIndex, const std::string &converterName, const std::vector<const ColorObject *> &colorObjects, size_t begin, size_t end, std::string *output);
+}
+#endif /* GPICK_LUA_STATE_POOL_H_ */
@@ -24,8 +24,12 @@
 #include "version/Version.h"
 #include "dynv/Map.h"
 #include <gtk/gtk.h>
+#if defined(GPICK_XSHM) && defined(GDK_WINDOWING_X11)
+#include <X11/Xlib.h>
+#endif
 #include <string>
 #include <iostream>
+#include <algorithm>
 using namespace std;
 
 static gchar **commandline_filename = nullptr;
@@ -36,7 +40,13 @@ static gboolean output_without_newline = FALSE;
 static gboolean single_color_pick_mode = FALSE;
 static gboolean version_information = FALSE;
 static gboolean do_not_start = FALSE;
+static gboolean startup_timing = FALSE;
 static gchar *converter_name = nullptr;
+static gchar *palette_from_image = nullptr;
+static gint palette_colors = 8;
+static gint sample_budget = 0;
+static gchar *sample_image = nullptr;
+static gchar *sample_position = nullptr;
 static GOptionEntry commandline_entries[] =
 {
 	{"geometry", 'g', 0, G_OPTION_ARG_STRING, &commandline_geometry, "Window geometry", "GEOMETRY"},
@@ -46,6 +56,12 @@ static GOptionEntry commandline_entries[] =
 	{"no-newline", 0, 0, G_OPTION_ARG_NONE, &output_without_newline, "Output picked color without newline", nullptr},
 	{"no-start", 0, 0, G_OPTION_ARG_NONE, &do_not_start, "Do not start Gpick if it is not already running", nullptr},
 	{"converter-name", 'c', 0, G_OPTION_ARG_STRING, &converter_name, "Converter name used for floating picker mode", nullptr},
+	{"palette-from-image", 0, 0, G_OPTION_ARG_FILENAME, &palette_from_image, "Print palette extracted from image file", "FILE"},
+	{"colors", 0, 0, G_OPTION_ARG_INT, &palette_colors, "Number of colors extracted from image file", "N"},
+	{"sample-budget", 0, 0, G_OPTION_ARG_INT, &sample_budget, "Maximum number of pixels sampled when extracting palette from image file", "N"},
+	{"sample-image", 0, 0, G_OPTION_ARG_FILENAME, &sample_image, "Print colors sampled from image file at positions read from standard input, one per line", "FILE"},
+	{"at", 0, 0, G_OPTION_ARG_STRING, &sample_position, "Sample image file at single position instead of reading positions from standard input", "X,Y[,R]"},
+	{"startup-timing", 0, 0, G_OPTION_ARG_NONE, &startup_timing, "Print startup timing report", nullptr},
 	{"version", 'v', 0, G_OPTION_ARG_NONE, &version_information, "Print version information", nullptr},
 	{G_OPTION_REMAINING, 0, 0, G_OPTION_ARG_FILENAME_ARRAY, &commandline_filename, nullptr, "[FILE...]"},
 	{nullptr}
@@ -53,13 +69,18 @@ static GOptionEntry commandline_entries[] =
 int main(int argc, char **argv)
 {
 	setlocale(LC_ALL, "");
-	gtk_init(&argc, &argv);
+#if defined(GPICK_XSHM) && defined(GDK_WINDOWING_X11)
+	// Picker thread uses its own display connection, but Xlib global state (error handlers, connection list) is shared and has to be locked.
+	XInitThreads();
+#endif
+	// Display is not required for image file processing, so it is only checked after parsing options.
+	bool display_available = gtk_init_check(&argc, &argv);
 	initialize_i18n();
 	g_set_application_name(program_name);
 	GError *error = nullptr;
 	GOptionContext *context = g_option_context_new("- advanced color picker");
 	g_option_context_add_main_entries(context, commandline_entries, 0);
-	g_option_context_add_group(context, gtk_get_option_group(TRUE));
+	g_option_context_add_group(context, gtk_get_option_group(FALSE));
 	gchar **argv_copy;
 #ifdef WIN32
 	argv_copy = g_win32_get_command_line();
@@ -85,9 +106,34 @@ int main(int argc, char **argv)
 	options.output_without_newline = output_without_newline;
 	options.single_color_pick_mode = single_color_pick_mode;
 	options.do_not_start = do_not_start;
+	options.startup_timing = startup_timing;
 	if (converter_name != nullptr)
 		options.converter_name = converter_name;
 	int return_value = 0;
+	options.palette_colors = static_cast<uint32_t>(std::max(palette_colors, 1));
+	options.sample_budget = static_cast<uint32_t>(std::max(sample_budget, 0));
+	if (palette_from_image != nullptr){
+		options.palette_from_image = palette_from_image;
+		return_value = app_palette_from_image(options);
+		g_option_context_free(context);
+		g_strfreev(argv_copy);
+		return return_value;
+	}
+	if (sample_image != nullptr){
+		options.sample_image = sample_image;
+		if (sample_position != nullptr)
+			options.sample_position = sample_position;
+		return_value = app_sample_image(options);
+		g_option_context_free(context);
+		g_strfreev(argv_copy);
+		return return_value;
+	}
+	if (!display_available){
+		g_printerr("cannot open display: %s\n", gdk_get_display_arg_name() ? gdk_get_display_arg_name() : "");
+		g_option_context_free(context);
+		g_strfreev(argv_copy);
+		return -1;
+	}
 	app_initialize();
 	AppArgs *args = app_create_main(options, return_value);
 	if (args){
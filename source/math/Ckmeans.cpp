@@ -0,0 +1,184 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Ckmeans.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+namespace math {
+namespace {
+// Upper limit for dynamic programming tables, cluster count is reduced for inputs which would need more.
+const size_t maxTableBytes = 64 << 20;
+struct Costs {
+	Costs(const std::vector<double> &sorted):
+		m_sum(sorted.size() + 1, 0),
+		m_squareSum(sorted.size() + 1, 0) {
+		for (size_t i = 0; i < sorted.size(); ++i) {
+			m_sum[i + 1] = m_sum[i] + sorted[i];
+			m_squareSum[i + 1] = m_squareSum[i] + sorted[i] * sorted[i];
+		}
+	}
+	// Sum of squared distances to the mean for sorted values in range [from, to].
+	double operator()(size_t from, size_t to) const {
+		double sum = m_sum[to + 1] - m_sum[from];
+		double squareSum = m_squareSum[to + 1] - m_squareSum[from];
+		return std::max(0.0, squareSum - sum * sum / static_cast<double>(to - from + 1));
+	}
+private:
+	std::vector<double> m_sum, m_squareSum;
+};
+struct Solver {
+	Solver(const Costs &costs, const std::vector<double> &previous, std::vector<double> &current, uint32_t *splits, size_t cluster):
+		costs(costs),
+		previous(previous),
+		current(current),
+		splits(splits),
+		cluster(cluster) {
+	}
+	// Optimal split point is monotone in the last value index, so every row can be filled by recursive bisection.
+	void solve(size_t from, size_t to, size_t splitFrom, size_t splitTo) {
+		if (from > to)
+			return;
+		size_t middle = from + (to - from) / 2;
+		double best = std::numeric_limits<double>::infinity();
+		size_t bestSplit = std::max(splitFrom, cluster);
+		for (size_t split = std::max(splitFrom, cluster), end = std::min(middle, splitTo); split <= end; ++split) {
+			double cost = previous[split - 1] + costs(split, middle);
+			if (cost < best) {
+				best = cost;
+				bestSplit = split;
+			}
+		}
+		current[middle] = best;
+		splits[middle] = static_cast<uint32_t>(bestSplit);
+		if (middle > from)
+			solve(from, middle - 1, splitFrom, bestSplit);
+		solve(middle + 1, to, bestSplit, splitTo);
+	}
+	const Costs &costs;
+	const std::vector<double> &previous;
+	std::vector<double> &current;
+	uint32_t *splits;
+	size_t cluster;
+};
+// Cost rows are kept for every checkpoint cluster, and split rows only for one segment between checkpoints.
+size_t tableBytes(size_t count, size_t clusters, size_t interval) {
+	return ((clusters + interval - 1) / interval * sizeof(double) + interval * sizeof(uint32_t)) * count;
+}
+size_t checkpointInterval(size_t clusters) {
+	return std::max<size_t>(1, static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(clusters)))));
+}
+}
+std::vector<size_t> ckmeans(const std::vector<float> &values, size_t maxClusters) {
+	size_t count = values.size();
+	std::vector<size_t> result(count, 0);
+	if (count == 0 || maxClusters <= 1)
+		return result;
+	std::vector<size_t> order(count);
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&values](size_t a, size_t b) {
+		return values[a] < values[b];
+	});
+	std::vector<double> sorted(count);
+	size_t distinct = 0;
+	for (size_t i = 0; i < count; ++i) {
+		sorted[i] = values[order[i]];
+		if (i == 0 || sorted[i] != sorted[i - 1])
+			++distinct;
+	}
+	size_t clusters = std::min(maxClusters, distinct);
+	if (clusters <= 1)
+		return result;
+	if (count > std::numeric_limits<uint32_t>::max())
+		return result;
+	size_t interval = checkpointInterval(clusters);
+	while (clusters > 1 && tableBytes(count, clusters, interval) > maxTableBytes) {
+		--clusters;
+		interval = checkpointInterval(clusters);
+	}
+	if (clusters <= 1)
+		return result;
+	Costs costs(sorted);
+	std::vector<uint32_t> splits(interval * count, 0);
+	std::vector<std::vector<double>> checkpoints((clusters + interval - 1) / interval);
+	std::vector<double> previous(count), current(count, std::numeric_limits<double>::infinity());
+	for (size_t i = 0; i < count; ++i)
+		previous[i] = costs(0, i);
+	checkpoints[0] = previous;
+	for (size_t cluster = 1; cluster < clusters; ++cluster) {
+		Solver(costs, previous, current, splits.data(), cluster).solve(cluster, count - 1, cluster, count - 1);
+		std::swap(previous, current);
+		if (cluster % interval == 0)
+			checkpoints[cluster / interval] = previous;
+	}
+	// Backtrack one segment of clusters at a time, starting from the last one. Splits of a segment are recomputed from the preceding checkpoint.
+	size_t to = count - 1;
+	size_t cluster = clusters - 1;
+	while (cluster > 0) {
+		size_t first = (cluster - 1) / interval * interval;
+		previous = checkpoints[first / interval];
+		for (size_t row = first + 1; row <= cluster; ++row) {
+			Solver(costs, previous, current, &splits[(row - first - 1) * count], row).solve(row, count - 1, row, count - 1);
+			std::swap(previous, current);
+		}
+		for (; cluster > first; --cluster) {
+			size_t from = splits[(cluster - first - 1) * count + to];
+			for (size_t i = from; i <= to; ++i)
+				result[order[i]] = cluster;
+			to = from - 1;
+		}
+	}
+	return result;
+}
+std::vector<float> mergeClusters(const std::vector<float> &values, std::vector<size_t> &clusters, float minDistance) {
+	size_t clusterCount = 0;
+	for (auto cluster: clusters)
+		clusterCount = std::max(clusterCount, cluster + 1);
+	std::vector<double> sums(clusterCount, 0);
+	std::vector<size_t> counts(clusterCount, 0);
+	for (size_t i = 0; i < values.size(); ++i) {
+		sums[clusters[i]] += values[i];
+		counts[clusters[i]]++;
+	}
+	// Clusters are numbered in increasing value order, so merging always happens with the previous resulting cluster.
+	std::vector<size_t> mapping(clusterCount, 0);
+	std::vector<double> mergedSums;
+	std::vector<size_t> mergedCounts;
+	for (size_t cluster = 0; cluster < clusterCount; ++cluster) {
+		if (counts[cluster] == 0)
+			continue;
+		double mean = sums[cluster] / static_cast<double>(counts[cluster]);
+		if (!mergedSums.empty() && mean - mergedSums.back() / static_cast<double>(mergedCounts.back()) < minDistance) {
+			mergedSums.back() += sums[cluster];
+			mergedCounts.back() += counts[cluster];
+		} else {
+			mergedSums.push_back(sums[cluster]);
+			mergedCounts.push_back(counts[cluster]);
+		}
+		mapping[cluster] = mergedSums.size() - 1;
+	}
+	for (auto &cluster: clusters)
+		cluster = mapping[cluster];
+	std::vector<float> means(mergedSums.size());
+	for (size_t i = 0; i < means.size(); ++i)
+		means[i] = static_cast<float>(mergedSums[i] / static_cast<double>(mergedCounts[i]));
+	return means;
+}
+}
@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef GPICK_MATH_CKMEANS_H_
+#define GPICK_MATH_CKMEANS_H_
+#include <cstddef>
+#include <vector>
+namespace math {
+/**
+ * Optimal one dimensional k-means clustering (Ckmeans.1d.dp).
+ * Dynamic programming over sorted values with divide and conquer optimization, O(k n log n) time and O(sqrt(k) n) memory.
+ * Cluster count is reduced when dynamic programming tables would not fit into a fixed memory budget.
+ * @param[in] values Values in any order.
+ * @param[in] maxClusters Maximum number of clusters. Fewer clusters are used when there are not enough distinct values.
+ * @return Cluster index for each value. Clusters are numbered in increasing value order.
+ */
+std::vector<size_t> ckmeans(const std::vector<float> &values, size_t maxClusters);
+/**
+ * Merge neighbouring clusters while distance between their means is smaller than specified value.
+ * @param[in] values Values in any order.
+ * @param[in,out] clusters Cluster index for each value, as returned by ckmeans.
+ * @param[in] minDistance Minimum allowed distance between cluster means.
+ * @return Mean value of each resulting cluster.
+ */
+std::vector<float> mergeClusters(const std::vector<float> &values, std::vector<size_t> &clusters, float minDistance);
+}
+#endif /* GPICK_MATH_CKMEANS_H_ */
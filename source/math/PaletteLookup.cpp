@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "PaletteLookup.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+namespace math {
+static constexpr int32_t cellSize = 256 / PaletteLookup::cellsPerChannel;
+static constexpr uint32_t localIndexBits = 14;
+static constexpr uint32_t localIndexMask = (1 << localIndexBits) - 1;
+static uint8_t toUint8(float value) {
+	return static_cast<uint8_t>(std::max(std::min(static_cast<int>(std::round(value * 255)), 255), 0));
+}
+static int32_t axisMinDistance(int32_t value, int32_t min, int32_t max) {
+	if (value < min)
+		return min - value;
+	if (value > max)
+		return value - max;
+	return 0;
+}
+static int32_t axisMaxDistance(int32_t value, int32_t min, int32_t max) {
+	return std::max(std::abs(value - min), std::abs(value - max));
+}
+static size_t toCell(uint8_t red, uint8_t green, uint8_t blue) {
+	constexpr uint8_t shift = 8 - PaletteLookup::cellBits;
+	return (static_cast<size_t>(red >> shift) << (2 * PaletteLookup::cellBits)) | (static_cast<size_t>(green >> shift) << PaletteLookup::cellBits) | (blue >> shift);
+}
+PaletteLookup::PaletteLookup():
+	m_cellOffsets(cellCount + 1, 0) {
+}
+PaletteLookup::PaletteLookup(const std::vector<Color> &colors):
+	m_cellOffsets(cellCount + 1, 0) {
+	build(colors);
+}
+void PaletteLookup::build(const std::vector<Color> &colors) {
+	m_colors.clear();
+	m_red.clear();
+	m_green.clear();
+	m_blue.clear();
+	m_indexes.clear();
+	std::fill(m_cellOffsets.begin(), m_cellOffsets.end(), 0);
+	if (colors.empty())
+		return;
+	m_colors.reserve(colors.size());
+	for (const auto &color: colors)
+		m_colors.push_back({ toUint8(color.red), toUint8(color.green), toUint8(color.blue) });
+	std::vector<uint32_t> minDistances(m_colors.size());
+	size_t cell = 0;
+	for (int32_t red = 0; red < 256; red += cellSize) {
+		for (int32_t green = 0; green < 256; green += cellSize) {
+			for (int32_t blue = 0; blue < 256; blue += cellSize) {
+				// Any color further than the smallest maximum distance can not be the nearest color for any value inside the cell.
+				uint32_t threshold = std::numeric_limits<uint32_t>::max();
+				for (size_t i = 0; i < m_colors.size(); ++i) {
+					const auto &color = m_colors[i];
+					int32_t minRed = axisMinDistance(color[0], red, red + cellSize - 1);
+					int32_t minGreen = axisMinDistance(color[1], green, green + cellSize - 1);
+					int32_t minBlue = axisMinDistance(color[2], blue, blue + cellSize - 1);
+					int32_t maxRed = axisMaxDistance(color[0], red, red + cellSize - 1);
+					int32_t maxGreen = axisMaxDistance(color[1], green, green + cellSize - 1);
+					int32_t maxBlue = axisMaxDistance(color[2], blue, blue + cellSize - 1);
+					minDistances[i] = static_cast<uint32_t>(minRed * minRed + minGreen * minGreen + minBlue * minBlue);
+					threshold = std::min(threshold, static_cast<uint32_t>(maxRed * maxRed + maxGreen * maxGreen + maxBlue * maxBlue));
+				}
+				m_cellOffsets[cell++] = static_cast<uint32_t>(m_indexes.size());
+				for (size_t i = 0; i < m_colors.size(); ++i) {
+					if (minDistances[i] > threshold)
+						continue;
+					m_red.push_back(m_colors[i][0]);
+					m_green.push_back(m_colors[i][1]);
+					m_blue.push_back(m_colors[i][2]);
+					m_indexes.push_back(static_cast<uint32_t>(i));
+				}
+			}
+		}
+	}
+	m_cellOffsets[cellCount] = static_cast<uint32_t>(m_indexes.size());
+}
+size_t PaletteLookup::find(uint8_t red, uint8_t green, uint8_t blue) const {
+	size_t cell = toCell(red, green, blue);
+	uint32_t begin = m_cellOffsets[cell];
+	uint32_t count = m_cellOffsets[cell + 1] - begin;
+	const int32_t *reds = m_red.data() + begin, *greens = m_green.data() + begin, *blues = m_blue.data() + begin;
+	if (count > localIndexMask + 1) {
+		uint32_t bestDistance = std::numeric_limits<uint32_t>::max(), best = 0;
+		for (uint32_t i = 0; i < count; ++i) {
+			int32_t r = reds[i] - red, g = greens[i] - green, b = blues[i] - blue;
+			uint32_t distance = static_cast<uint32_t>(r * r + g * g + b * b);
+			if (distance < bestDistance) {
+				bestDistance = distance;
+				best = i;
+			}
+		}
+		return m_indexes[begin + best];
+	}
+	// Squared distance (at most 18 bits) and candidate index are packed into one value, so the loop is a plain minimum reduction.
+	uint32_t best = std::numeric_limits<uint32_t>::max();
+	for (uint32_t i = 0; i < count; ++i) {
+		int32_t r = reds[i] - red, g = greens[i] - green, b = blues[i] - blue;
+		uint32_t key = (static_cast<uint32_t>(r * r + g * g + b * b) << localIndexBits) | i;
+		best = std::min(best, key);
+	}
+	return m_indexes[begin + (best & localIndexMask)];
+}
+size_t PaletteLookup::findLinear(uint8_t red, uint8_t green, uint8_t blue) const {
+	uint32_t bestDistance = std::numeric_limits<uint32_t>::max();
+	size_t best = 0;
+	for (size_t i = 0; i < m_colors.size(); ++i) {
+		int32_t r = m_colors[i][0] - red, g = m_colors[i][1] - green, b = m_colors[i][2] - blue;
+		uint32_t distance = static_cast<uint32_t>(r * r + g * g + b * b);
+		if (distance < bestDistance) {
+			bestDistance = distance;
+			best = i;
+		}
+	}
+	return best;
+}
+const PaletteLookup::Position &PaletteLookup::operator[](size_t index) const {
+	return m_colors[index];
+}
+size_t PaletteLookup::size() const {
+	return m_colors.size();
+}
+bool PaletteLookup::empty() const {
+	return m_colors.empty();
+}
+float PaletteLookup::averageCandidates() const {
+	return static_cast<float>(m_indexes.size()) / cellCount;
+}
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef GPICK_MATH_PALETTE_LOOKUP_H_
+#define GPICK_MATH_PALETTE_LOOKUP_H_
+#include "Color.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+namespace math {
+/** \struct PaletteLookup
+ * \brief Exact nearest palette color search for 8-bit RGB values.
+ *
+ * RGB cube is split into 32x32x32 cells and every cell stores only palette colors which can be the nearest color for some value inside that cell.
+ * Candidate values are stored in separate channel arrays, so distance loop can be vectorized by compiler.
+ */
+struct PaletteLookup {
+	static constexpr uint8_t cellBits = 5;
+	static constexpr size_t cellsPerChannel = 1 << cellBits;
+	static constexpr size_t cellCount = cellsPerChannel * cellsPerChannel * cellsPerChannel;
+	using Position = std::array<uint8_t, 3>;
+	PaletteLookup();
+	/**
+	 * Build lookup from palette colors.
+	 * @param[in] colors Palette colors in RGB color space.
+	 */
+	PaletteLookup(const std::vector<Color> &colors);
+	/**
+	 * Rebuild lookup from palette colors.
+	 * @param[in] colors Palette colors in RGB color space.
+	 */
+	void build(const std::vector<Color> &colors);
+	/**
+	 * Find nearest palette color. Palette must not be empty.
+	 * @param[in] red Red component in range [0, 255].
+	 * @param[in] green Green component in range [0, 255].
+	 * @param[in] blue Blue component in range [0, 255].
+	 * @return Index of nearest palette color.
+	 */
+	size_t find(uint8_t red, uint8_t green, uint8_t blue) const;
+	/**
+	 * Find nearest palette color by brute force search. Used for verification.
+	 * @return Index of nearest palette color.
+	 */
+	size_t findLinear(uint8_t red, uint8_t green, uint8_t blue) const;
+	/**
+	 * Get palette color 8-bit RGB values.
+	 * @param[in] index Palette color index.
+	 * @return RGB values.
+	 */
+	const Position &operator[](size_t index) const;
+	size_t size() const;
+	bool empty() const;
+	/**
+	 * Get average number of candidates per cell.
+	 * @return Average candidate count.
+	 */
+	float averageCandidates() const;
+private:
+	std::vector<Position> m_colors;
+	std::vector<uint32_t> m_cellOffsets;
+	std::vector<int32_t> m_red, m_green, m_blue;
+	std::vector<uint32_t> m_indexes;
+};
+}
+#endif /* GPICK_MATH_PALETTE_LOOKUP_H_ */
@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "PaletteRemapper.h"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include <vector>
+namespace math {
+static const uint8_t bayerMatrix[8][8] = {
+	{ 0, 32, 8, 40, 2, 34, 10, 42 },
+	{ 48, 16, 56, 24, 50, 18, 58, 26 },
+	{ 12, 44, 4, 36, 14, 46, 6, 38 },
+	{ 60, 28, 52, 20, 62, 30, 54, 22 },
+	{ 3, 35, 11, 43, 1, 33, 9, 41 },
+	{ 51, 19, 59, 27, 49, 17, 57, 25 },
+	{ 15, 47, 7, 39, 13, 45, 5, 37 },
+	{ 63, 31, 55, 23, 61, 29, 53, 21 },
+};
+static uint8_t clampToUint8(int32_t value) {
+	return static_cast<uint8_t>(std::max(std::min(value, 255), 0));
+}
+uint8_t *PaletteRemapper::Image::row(int y) const {
+	return data + static_cast<size_t>(stride) * y;
+}
+PaletteRemapper::PaletteRemapper(const PaletteLookup &lookup, Dithering dithering):
+	m_lookup(lookup),
+	m_dithering(dithering) {
+	// Ordered dithering amplitude is roughly the distance between neighbouring palette colors of an uniform palette with the same size.
+	m_spread = static_cast<int32_t>(std::max(std::min(255.0f / std::cbrt(static_cast<float>(lookup.size())), 255.0f), 8.0f));
+}
+void PaletteRemapper::write(const Image &source, const Image &destination, uint32_t *indexes, int x, int y, const uint8_t *in, size_t index) const {
+	const auto &color = m_lookup[index];
+	uint8_t *out = destination.row(y) + x * destination.channels;
+	out[0] = color[0];
+	out[1] = color[1];
+	out[2] = color[2];
+	if (destination.channels == 4)
+		out[3] = source.channels == 4 ? in[3] : 255;
+	if (indexes)
+		indexes[static_cast<size_t>(y) * source.width + x] = static_cast<uint32_t>(index);
+}
+void PaletteRemapper::nearest(const Image &source, const Image &destination, uint32_t *indexes, int fromRow, int toRow) const {
+	for (int y = fromRow; y < toRow; ++y) {
+		const uint8_t *in = source.row(y);
+		for (int x = 0; x < source.width; ++x, in += source.channels)
+			write(source, destination, indexes, x, y, in, m_lookup.find(in[0], in[1], in[2]));
+	}
+}
+void PaletteRemapper::ordered(const Image &source, const Image &destination, uint32_t *indexes, int fromRow, int toRow) const {
+	for (int y = fromRow; y < toRow; ++y) {
+		const uint8_t *in = source.row(y);
+		for (int x = 0; x < source.width; ++x, in += source.channels) {
+			int32_t offset = (bayerMatrix[y & 7][x & 7] * 2 - 63) * m_spread / 128;
+			write(source, destination, indexes, x, y, in, m_lookup.find(clampToUint8(in[0] + offset), clampToUint8(in[1] + offset), clampToUint8(in[2] + offset)));
+		}
+	}
+}
+void PaletteRemapper::floydSteinberg(const Image &source, const Image &destination, uint32_t *indexes) const {
+	// Errors are stored multiplied by 16 with one padding pixel on both sides, rows are processed in serpentine order.
+	std::vector<int32_t> current((source.width + 2) * 3, 0), next((source.width + 2) * 3, 0);
+	for (int y = 0; y < source.height; ++y) {
+		std::fill(next.begin(), next.end(), 0);
+		bool reverse = (y & 1) != 0;
+		int step = reverse ? -1 : 1;
+		int x = reverse ? source.width - 1 : 0;
+		for (int i = 0; i < source.width; ++i, x += step) {
+			const uint8_t *in = source.row(y) + x * source.channels;
+			const int32_t *error = &current[(x + 1) * 3];
+			int32_t values[3];
+			for (int c = 0; c < 3; ++c)
+				values[c] = clampToUint8(in[c] + error[c] / 16);
+			size_t index = m_lookup.find(static_cast<uint8_t>(values[0]), static_cast<uint8_t>(values[1]), static_cast<uint8_t>(values[2]));
+			write(source, destination, indexes, x, y, in, index);
+			const auto &color = m_lookup[index];
+			int32_t *forward = &current[(x + 1 + step) * 3];
+			int32_t *below = &next[(x + 1) * 3];
+			int32_t *belowBackward = &next[(x + 1 - step) * 3];
+			int32_t *belowForward = &next[(x + 1 + step) * 3];
+			for (int c = 0; c < 3; ++c) {
+				int32_t difference = values[c] - color[c];
+				forward[c] += difference * 7;
+				belowBackward[c] += difference * 3;
+				below[c] += difference * 5;
+				belowForward[c] += difference;
+			}
+		}
+		std::swap(current, next);
+	}
+}
+void PaletteRemapper::remap(const Image &source, const Image &destination, uint32_t *indexes, size_t threadCount) const {
+	if (m_dithering == Dithering::floydSteinberg) {
+		// Each row depends on the error of the whole previous row, because serpentine order reverses direction on every row.
+		floydSteinberg(source, destination, indexes);
+		return;
+	}
+	if (threadCount == 0) {
+		threadCount = std::min(8u, std::max(1u, std::thread::hardware_concurrency()));
+		if (static_cast<size_t>(source.width) * source.height < (1 << 16))
+			threadCount = 1;
+	}
+	threadCount = std::max<size_t>(std::min<size_t>(threadCount, std::max(source.height, 1)), 1);
+	auto process = [&](int fromRow, int toRow) {
+		if (m_dithering == Dithering::ordered)
+			ordered(source, destination, indexes, fromRow, toRow);
+		else
+			nearest(source, destination, indexes, fromRow, toRow);
+	};
+	if (threadCount == 1) {
+		process(0, source.height);
+		return;
+	}
+	int rowsPerThread = static_cast<int>((source.height + threadCount - 1) / threadCount);
+	std::vector<std::thread> threads;
+	for (int fromRow = 0; fromRow < source.height; fromRow += rowsPerThread) {
+		int toRow = std::min(fromRow + rowsPerThread, source.height);
+		threads.emplace_back(process, fromRow, toRow);
+	}
+	for (auto &thread: threads) {
+		thread.join();
+	}
+}
+}
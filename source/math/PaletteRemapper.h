@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef GPICK_MATH_PALETTE_REMAPPER_H_
+#define GPICK_MATH_PALETTE_REMAPPER_H_
+#include "PaletteLookup.h"
+#include <cstddef>
+#include <cstdint>
+namespace math {
+/** \struct PaletteRemapper
+ * \brief Replaces every pixel of 8-bit RGB or RGBA image with nearest palette color.
+ *
+ * Nearest and ordered modes process bands of rows in parallel. Error diffusion always runs serially over the whole image,
+ * so the result does not depend on the number of threads.
+ */
+struct PaletteRemapper {
+	enum class Dithering {
+		none,
+		floydSteinberg,
+		ordered,
+	};
+	struct Image {
+		uint8_t *data;
+		int width, height, stride, channels;
+		uint8_t *row(int y) const;
+	};
+	/**
+	 * @param[in] lookup Palette lookup. Must not be empty and must outlive remapper.
+	 * @param[in] dithering Dithering mode.
+	 */
+	PaletteRemapper(const PaletteLookup &lookup, Dithering dithering);
+	/**
+	 * Remap image.
+	 * @param[in] source Source image with 3 or 4 channels.
+	 * @param[out] destination Destination image with the same size as source and 3 or 4 channels.
+	 * @param[out] indexes Optional palette index for every pixel, row by row without padding.
+	 * @param[in] threadCount Maximum number of threads, 0 to choose automatically.
+	 */
+	void remap(const Image &source, const Image &destination, uint32_t *indexes, size_t threadCount = 0) const;
+private:
+	const PaletteLookup &m_lookup;
+	Dithering m_dithering;
+	int32_t m_spread;
+	void write(const Image &source, const Image &destination, uint32_t *indexes, int x, int y, const uint8_t *in, size_t index) const;
+	void nearest(const Image &source, const Image &destination, uint32_t *indexes, int fromRow, int toRow) const;
+	void ordered(const Image &source, const Image &destination, uint32_t *indexes, int fromRow, int toRow) const;
+	void floydSteinberg(const Image &source, const Image &destination, uint32_t *indexes) const;
+};
+}
+#endif /* GPICK_MATH_PALETTE_REMAPPER_H_ */
@@ -83,6 +83,17 @@ struct Rectangle {
 		else
 			return true;
 	}
+	bool intersects(const Rectangle &r) const {
+		if (m_empty || r.m_empty) return false;
+		return m_x1 < r.m_x2 && r.m_x1 < m_x2 && m_y1 < r.m_y2 && r.m_y1 < m_y2;
+	}
+	bool operator==(const Rectangle &r) const {
+		if (m_empty || r.m_empty) return m_empty == r.m_empty;
+		return m_x1 == r.m_x1 && m_y1 == r.m_y1 && m_x2 == r.m_x2 && m_y2 == r.m_y2;
+	}
+	bool operator!=(const Rectangle &r) const {
+		return !(*this == r);
+	}
 	bool isInside(const Rectangle &r) const {
 		if (m_empty || r.m_empty) return false;
 		if (m_x1 < r.m_x1 || m_x2 > r.m_x2) return false;
@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "RegionStatistics.h"
+#include "OctreeColorQuantization.h"
+#include <algorithm>
+#include <array>
+#include <thread>
+#include <vector>
+namespace math {
+namespace {
+// Colors are counted in 15-bit bins before being added to octree, so octree work does not depend on region size.
+constexpr int binBits = 5;
+constexpr size_t binCount = 1 << (binBits * 3);
+constexpr size_t dominantColors = 16;
+struct Tile {
+	Tile():
+		histogram(),
+		sum(),
+		squareSum(),
+		bins(binCount),
+		pixels(0) {
+	}
+	void add(const uint8_t *data, int width, int stride, int from, int to) {
+		for (int y = from; y < to; y++) {
+			auto row = reinterpret_cast<const uint32_t *>(data + static_cast<ptrdiff_t>(y) * stride);
+			for (int x = 0; x < width; x++) {
+				uint32_t value = row[x];
+				uint32_t red = (value >> 16) & 0xff, green = (value >> 8) & 0xff, blue = value & 0xff;
+				histogram[0][red]++;
+				histogram[1][green]++;
+				histogram[2][blue]++;
+				sum[0] += red;
+				sum[1] += green;
+				sum[2] += blue;
+				squareSum[0] += red * red;
+				squareSum[1] += green * green;
+				squareSum[2] += blue * blue;
+				auto &bin = bins[((red >> (8 - binBits)) << (binBits * 2)) | ((green >> (8 - binBits)) << binBits) | (blue >> (8 - binBits))];
+				bin.pixels++;
+				bin.sum[0] += red;
+				bin.sum[1] += green;
+				bin.sum[2] += blue;
+			}
+		}
+		pixels += static_cast<size_t>(width) * (to - from);
+	}
+	void merge(const Tile &tile) {
+		for (int channel = 0; channel < 3; channel++) {
+			for (int value = 0; value < 256; value++)
+				histogram[channel][value] += tile.histogram[channel][value];
+			sum[channel] += tile.sum[channel];
+			squareSum[channel] += tile.squareSum[channel];
+		}
+		for (size_t i = 0; i < binCount; i++) {
+			bins[i].pixels += tile.bins[i].pixels;
+			for (int channel = 0; channel < 3; channel++)
+				bins[i].sum[channel] += tile.bins[i].sum[channel];
+		}
+		pixels += tile.pixels;
+	}
+	struct Bin {
+		uint64_t pixels;
+		uint64_t sum[3];
+	};
+	std::array<std::array<uint64_t, 256>, 3> histogram;
+	std::array<uint64_t, 3> sum, squareSum;
+	std::vector<Bin> bins;
+	size_t pixels;
+};
+float channelMedian(const std::array<uint64_t, 256> &histogram, size_t pixels) {
+	uint64_t count = 0, half = (pixels + 1) / 2;
+	for (int value = 0; value < 256; value++) {
+		count += histogram[value];
+		if (count >= half)
+			return value / 255.0f;
+	}
+	return 1.0f;
+}
+Color dominant(const Tile &tile) {
+	OctreeColorQuantization octree;
+	for (const auto &bin: tile.bins) {
+		if (!bin.pixels)
+			continue;
+		std::array<uint8_t, 3> position;
+		for (int channel = 0; channel < 3; channel++)
+			position[channel] = static_cast<uint8_t>(bin.sum[channel] / bin.pixels);
+		Color color(position[0] / 255.0f, position[1] / 255.0f, position[2] / 255.0f, 1.0f);
+		color.linearRgbInplace();
+		octree.add(color, bin.pixels, position);
+	}
+	octree.reduce(dominantColors);
+	Color result(0.0f, 0.0f, 0.0f, 1.0f);
+	size_t maxPixels = 0;
+	octree.visit([&result, &maxPixels](const float sum[3], size_t pixels) {
+		if (pixels <= maxPixels)
+			return;
+		maxPixels = pixels;
+		result = Color(sum[0] / pixels, sum[1] / pixels, sum[2] / pixels, 1.0f).nonLinearRgb();
+	});
+	return result;
+}
+}
+RegionStatistics regionStatistics(const uint8_t *data, int width, int height, int stride, unsigned int maxThreads) {
+	Tile total;
+	size_t threadCount = std::min(8u, std::max(1u, maxThreads ? maxThreads : std::thread::hardware_concurrency()));
+	if (static_cast<size_t>(width) * height < (1 << 16) || threadCount == 1 || height < 2) {
+		total.add(data, width, stride, 0, height);
+	} else {
+		threadCount = std::min(threadCount, static_cast<size_t>(height));
+		std::vector<Tile> tiles(threadCount);
+		std::vector<std::thread> threads(threadCount);
+		for (size_t index = 0; index < threadCount; index++) {
+			int from = static_cast<int>(height * index / threadCount), to = static_cast<int>(height * (index + 1) / threadCount);
+			threads[index] = std::thread([&tile = tiles[index], data, width, stride, from, to]() {
+				tile.add(data, width, stride, from, to);
+			});
+		}
+		for (size_t index = 0; index < threadCount; index++) {
+			threads[index].join();
+			total.merge(tiles[index]);
+		}
+	}
+	RegionStatistics statistics;
+	statistics.pixels = total.pixels;
+	if (!total.pixels) {
+		statistics.mean = statistics.median = statistics.dominant = Color(0.0f, 0.0f, 0.0f, 1.0f);
+		std::fill(statistics.variance, statistics.variance + 3, 0.0f);
+		return statistics;
+	}
+	double pixels = static_cast<double>(total.pixels);
+	float mean[3], median[3];
+	for (int channel = 0; channel < 3; channel++) {
+		double average = total.sum[channel] / pixels;
+		mean[channel] = static_cast<float>(average / 255.0);
+		median[channel] = channelMedian(total.histogram[channel], total.pixels);
+		statistics.variance[channel] = static_cast<float>(std::max(0.0, total.squareSum[channel] / pixels - average * average) / (255.0 * 255.0));
+	}
+	statistics.mean = Color(mean[0], mean[1], mean[2], 1.0f);
+	statistics.median = Color(median[0], median[1], median[2], 1.0f);
+	statistics.dominant = dominant(total);
+	return statistics;
+}
+}
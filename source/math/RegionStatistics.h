@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef GPICK_MATH_REGION_STATISTICS_H_
+#define GPICK_MATH_REGION_STATISTICS_H_
+#include "Color.h"
+#include <cstddef>
+#include <cstdint>
+namespace math {
+struct RegionStatistics {
+	Color mean, median, dominant;
+	// Per channel variance of RGB values in [0, 1] range.
+	float variance[3];
+	size_t pixels;
+};
+/**
+ * Compute mean, per channel median, dominant color and variance of an image region.
+ * Region is split into horizontal tiles which are processed in parallel when region is large enough.
+ * @param[in] data First pixel of region. Pixels are 32-bit native endian xRGB values, as in CAIRO_FORMAT_RGB24.
+ * @param[in] width Region width.
+ * @param[in] height Region height.
+ * @param[in] stride Distance between rows in bytes.
+ * @param[in] maxThreads Maximum number of threads, 0 to use hardware concurrency.
+ */
+RegionStatistics regionStatistics(const uint8_t *data, int width, int height, int stride, unsigned int maxThreads = 0);
+}
+#endif /* GPICK_MATH_REGION_STATISTICS_H_ */
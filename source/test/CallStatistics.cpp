@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include "common/CallStatistics.h"
+using namespace common;
+using namespace std::chrono;
+BOOST_AUTO_TEST_SUITE(callStatistics)
+BOOST_AUTO_TEST_CASE(add) {
+	CallStatistics statistics;
+	statistics.add(milliseconds(2));
+	statistics.add(milliseconds(1), 1);
+	BOOST_CHECK_EQUAL(statistics.calls(), 2);
+	BOOST_CHECK_EQUAL(statistics.errors(), 1);
+	BOOST_CHECK(statistics.total() == milliseconds(3));
+	BOOST_CHECK(statistics.max() == milliseconds(2));
+	statistics.add(milliseconds(30), 0, 10);
+	BOOST_CHECK_EQUAL(statistics.calls(), 12);
+	BOOST_CHECK(statistics.max() == milliseconds(3));
+	statistics.reset();
+	BOOST_CHECK_EQUAL(statistics.calls(), 0);
+	BOOST_CHECK(statistics.total() == CallStatistics::Duration::zero());
+}
+BOOST_AUTO_TEST_CASE(timer) {
+	CallStatistics statistics;
+	{
+		CallTimer timer(statistics);
+	}
+	{
+		CallTimer timer(statistics);
+		timer.error();
+	}
+	BOOST_CHECK_EQUAL(statistics.calls(), 2);
+	BOOST_CHECK_EQUAL(statistics.errors(), 1);
+}
+BOOST_AUTO_TEST_CASE(json) {
+	BOOST_CHECK_EQUAL(toJson({}), "[]\n");
+	std::vector<NamedCallStatistics> statistics(1);
+	statistics[0].kind = "converter";
+	statistics[0].name = "a\"b\\c\x01";
+	statistics[0].statistics.add(microseconds(1500), 1);
+	BOOST_CHECK_EQUAL(toJson(statistics), "[\n\t{\"kind\": \"converter\", \"name\": \"a\\\"b\\\\c\\u0001\", \"calls\": 1, \"errors\": 1, \"totalMs\": 1.500, \"maxMs\": 1.500}\n]\n");
+}
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include "math/Ckmeans.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+using namespace math;
+BOOST_AUTO_TEST_SUITE(ckmeans)
+template<typename T>
+constexpr bool between(T value, T min, T max) {
+	return value >= min && value <= max;
+}
+static double totalCost(const std::vector<float> &values, const std::vector<size_t> &clusters) {
+	size_t clusterCount = 0;
+	for (auto cluster: clusters)
+		clusterCount = std::max(clusterCount, cluster + 1);
+	std::vector<double> sums(clusterCount, 0), counts(clusterCount, 0);
+	for (size_t i = 0; i < values.size(); ++i) {
+		sums[clusters[i]] += values[i];
+		counts[clusters[i]]++;
+	}
+	double cost = 0;
+	for (size_t i = 0; i < values.size(); ++i) {
+		double mean = sums[clusters[i]] / counts[clusters[i]];
+		cost += (values[i] - mean) * (values[i] - mean);
+	}
+	return cost;
+}
+// Exhaustive search over all contiguous partitions of sorted values.
+static double bruteForceCost(std::vector<float> values, size_t clusters) {
+	std::sort(values.begin(), values.end());
+	size_t count = values.size();
+	std::vector<std::vector<double>> best(clusters + 1, std::vector<double>(count + 1, std::numeric_limits<double>::infinity()));
+	best[0][0] = 0;
+	for (size_t k = 1; k <= clusters; ++k) {
+		for (size_t end = 1; end <= count; ++end) {
+			for (size_t start = k - 1; start < end; ++start) {
+				double sum = 0, squareSum = 0;
+				for (size_t i = start; i < end; ++i) {
+					sum += values[i];
+					squareSum += values[i] * values[i];
+				}
+				double cost = squareSum - sum * sum / (end - start);
+				best[k][end] = std::min(best[k][end], best[k - 1][start] + cost);
+			}
+		}
+	}
+	return best[clusters][count];
+}
+BOOST_AUTO_TEST_CASE(empty) {
+	BOOST_CHECK(math::ckmeans({}, 4).empty());
+}
+BOOST_AUTO_TEST_CASE(separatedGroups) {
+	std::vector<float> values = { 0.91f, 0.10f, 0.52f, 0.11f, 0.90f, 0.50f, 0.12f, 0.51f, 0.92f };
+	auto clusters = math::ckmeans(values, 3);
+	std::vector<size_t> expected = { 2, 0, 1, 0, 2, 1, 0, 1, 2 };
+	BOOST_CHECK_EQUAL_COLLECTIONS(clusters.begin(), clusters.end(), expected.begin(), expected.end());
+}
+BOOST_AUTO_TEST_CASE(fewDistinctValues) {
+	std::vector<float> values = { 0.5f, 0.2f, 0.5f, 0.2f };
+	auto clusters = math::ckmeans(values, 8);
+	std::vector<size_t> expected = { 1, 0, 1, 0 };
+	BOOST_CHECK_EQUAL_COLLECTIONS(clusters.begin(), clusters.end(), expected.begin(), expected.end());
+}
+BOOST_AUTO_TEST_CASE(matchesBruteForce) {
+	std::mt19937 random(1);
+	std::uniform_real_distribution<float> distribution(0.0f, 1.0f);
+	for (size_t test = 0; test < 20; ++test) {
+		std::vector<float> values(40);
+		for (auto &value: values)
+			value = distribution(random);
+		for (size_t k = 2; k <= 12; ++k) {
+			auto clusters = math::ckmeans(values, k);
+			BOOST_CHECK_EQUAL(*std::max_element(clusters.begin(), clusters.end()), k - 1);
+			BOOST_CHECK_SMALL(totalCost(values, clusters) - bruteForceCost(values, k), 1e-5);
+		}
+	}
+}
+BOOST_AUTO_TEST_CASE(merging) {
+	std::vector<float> values = { 0.10f, 0.11f, 0.12f, 0.30f, 0.31f, 0.32f, 0.90f, 0.91f };
+	auto clusters = math::ckmeans(values, 3);
+	auto means = mergeClusters(values, clusters, 0.25f);
+	BOOST_REQUIRE_EQUAL(means.size(), 2);
+	BOOST_CHECK_PREDICATE(between<float>, (means[0])(0.20f)(0.22f));
+	BOOST_CHECK_PREDICATE(between<float>, (means[1])(0.90f)(0.91f));
+	std::vector<size_t> expected = { 0, 0, 0, 0, 0, 0, 1, 1 };
+	BOOST_CHECK_EQUAL_COLLECTIONS(clusters.begin(), clusters.end(), expected.begin(), expected.end());
+}
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include "ColorList.h"
+#include "ColorObject.h"
+#include "IPalette.h"
+namespace {
+struct CountingPalette: public IPalette {
+	size_t addCalls = 0, removeCalls = 0, removeSelectedCalls = 0, added = 0, removed = 0;
+	virtual void add(ColorList &, ColorObject *) override {
+		addCalls++;
+		added++;
+	}
+	virtual void add(ColorList &, const std::vector<ColorObject *> &colorObjects) override {
+		addCalls++;
+		added += colorObjects.size();
+	}
+	virtual void remove(ColorList &, const std::vector<ColorObject *> &colorObjects) override {
+		removeCalls++;
+		removed += colorObjects.size();
+	}
+	virtual void removeSelected(ColorList &) override {
+		removeSelectedCalls++;
+	}
+	virtual void clear(ColorList &) override {
+	}
+	virtual void update(ColorList &) override {
+	}
+};
+}
+BOOST_AUTO_TEST_SUITE(colorList)
+BOOST_AUTO_TEST_CASE(removeKeepsOrderAndNotifiesOnce) {
+	CountingPalette palette;
+	ColorList colorList(palette);
+	for (int i = 0; i < 10; i++)
+		colorList.add(ColorObject(std::to_string(i), Color(0.0f)));
+	colorList.remove([](ColorObject *colorObject) {
+		return std::stoi(colorObject->getName()) % 2 == 1;
+	}, false, true);
+	BOOST_CHECK_EQUAL(colorList.size(), 5u);
+	BOOST_CHECK_EQUAL(palette.removeCalls, 1u);
+	BOOST_CHECK_EQUAL(palette.removed, 5u);
+	int expected = 0;
+	for (auto *colorObject: colorList) {
+		BOOST_CHECK_EQUAL(colorObject->getName(), std::to_string(expected));
+		expected += 2;
+	}
+	colorList.remove([](ColorObject *) {
+		return true;
+	}, true, true);
+	BOOST_CHECK(colorList.empty());
+	BOOST_CHECK_EQUAL(palette.removeCalls, 1u);
+	BOOST_CHECK_EQUAL(palette.removeSelectedCalls, 1u);
+}
+BOOST_AUTO_TEST_CASE(rangeAdd) {
+	CountingPalette palette;
+	ColorList colorList(palette), source;
+	for (int i = 0; i < 4; i++)
+		colorList.add(ColorObject(std::to_string(i), Color(0.0f)));
+	for (int i = 0; i < 3; i++)
+		source.add(ColorObject("new" + std::to_string(i), Color(0.0f)));
+	std::vector<ColorObject *> colorObjects(source.begin(), source.end());
+	colorList.add(colorObjects, 2);
+	BOOST_CHECK_EQUAL(palette.addCalls, 4u);
+	const char *names[] = { "0", "1", "new0", "new1", "new2", "2", "3" };
+	BOOST_REQUIRE_EQUAL(colorList.size(), 7u);
+	size_t index = 0;
+	for (auto *colorObject: colorList)
+		BOOST_CHECK_EQUAL(colorObject->getName(), names[index++]);
+	colorList.add(source);
+	BOOST_CHECK_EQUAL(palette.addCalls, 5u);
+	BOOST_CHECK_EQUAL(palette.added, 7u);
+	BOOST_CHECK_EQUAL(colorList.size(), 10u);
+}
+BOOST_AUTO_TEST_SUITE_END()
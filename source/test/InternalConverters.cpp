@@ -534,4 +534,59 @@ BOOST_AUTO_TEST_CASE(valueRgba) {
 			BOOST_CHECK_MESSAGE(colorObject.getColor() == colors[i].color, "wrong color at index " << i << ", " << colorObject.getColor() << " != " << colors[i].color);
 	}
 }
+BOOST_AUTO_TEST_CASE(serialize) {
+	Converter::Options options = {};
+	Converters converters;
+	addInternalConverters(converters, options);
+	ColorObject colorObject("", Color(32, 64, 128, 16));
+	const struct {
+		const char *name;
+		const char *text;
+	} values[] = {
+		{ "color_web_hex", "#204080" },
+		{ "color_css_rgba", "rgba(32, 64, 128, 0.063)" },
+		{ "color_css_hsla", "hsla(220, 60%, 31%, 0.063)" },
+		{ "csv_rgb", "0.125,0.251,0.502" },
+		{ "csv_rgba_tab", "0.125\t0.251\t0.502\t0.063" },
+		{ "csv_rgba_semicolon", "0.125;0.251;0.502;0.063" },
+		{ "value_rgba", "0.125, 0.251, 0.502, 0.063" },
+	};
+	for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); ++i) {
+		auto *converter = converters.byName(values[i].name);
+		BOOST_REQUIRE(converter != nullptr);
+		BOOST_CHECK_EQUAL(converter->serialize(colorObject), values[i].text);
+	}
+}
+BOOST_AUTO_TEST_CASE(signatures) {
+	BOOST_CHECK(ConverterSignature::classify("") == CharacterClass::none);
+	BOOST_CHECK(ConverterSignature::classify("#fF") == (CharacterClass::hash | CharacterClass::hexDigit));
+	BOOST_CHECK(ConverterSignature::classify("rgb(1%, 2;\t)") == (CharacterClass::hexDigit | CharacterClass::parenthesis | CharacterClass::digit | CharacterClass::percent | CharacterClass::comma | CharacterClass::semicolon | CharacterClass::tab));
+	ConverterSignature signature(CharacterClass::digit, { "rgb(" });
+	BOOST_CHECK(signature.matches(ConverterSignature::classify("rgb(1"), "rgb(1"));
+	BOOST_CHECK(!signature.matches(ConverterSignature::classify("rgb("), "rgb("));
+	BOOST_CHECK(!signature.matches(ConverterSignature::classify("rgba(1"), "rgba(1"));
+}
+BOOST_AUTO_TEST_CASE(prefilter) {
+	Converter::Options options = {};
+	Converters converters;
+	addInternalConverters(converters, options);
+	for (auto *converter: converters.all())
+		converter->paste(converter->hasDeserialize());
+	converters.rebuildCopyPasteArrays();
+	ColorObject colorObject;
+	BOOST_REQUIRE(converters.deserialize("rgb(32, 64, 128)", colorObject));
+	BOOST_CHECK(colorObject.getColor() == Color(32, 64, 128, 255));
+	BOOST_REQUIRE(converters.deserialize("#204080", colorObject));
+	BOOST_CHECK(colorObject.getColor() == Color(32, 64, 128, 255));
+	BOOST_CHECK(!converters.deserialize("no color", colorObject));
+	auto &rgb = converters.byName("color_css_rgb")->deserializeStatistics();
+	BOOST_CHECK_EQUAL(rgb.hits, 1u);
+	BOOST_CHECK_EQUAL(rgb.misses, 0u);
+	BOOST_CHECK_EQUAL(rgb.skipped, 2u);
+	auto &hex = converters.byName("color_web_hex")->deserializeStatistics();
+	BOOST_CHECK_EQUAL(hex.hits, 1u);
+	BOOST_CHECK_EQUAL(hex.skipped, 2u);
+	auto &csv = converters.byName("csv_rgb")->deserializeStatistics();
+	BOOST_CHECK_EQUAL(csv.hits + csv.misses, 1u);
+}
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include "common/NumberFormat.h"
+#include <cstdio>
+using namespace common;
+BOOST_AUTO_TEST_SUITE(numberFormat)
+BOOST_AUTO_TEST_CASE(integer) {
+	std::string result;
+	appendInteger(result, 0);
+	result += ' ';
+	appendInteger(result, -255);
+	result += ' ';
+	appendInteger(result, 360);
+	BOOST_CHECK_EQUAL(result, "0 -255 360");
+}
+BOOST_AUTO_TEST_CASE(fixed) {
+	BOOST_CHECK_EQUAL(toFixed(0.0f, 3), "0.000");
+	BOOST_CHECK_EQUAL(toFixed(1.0f, 3), "1.000");
+	BOOST_CHECK_EQUAL(toFixed(0.5f, 1), "0.5");
+	BOOST_CHECK_EQUAL(toFixed(32 / 255.0f, 3), "0.125");
+	BOOST_CHECK_EQUAL(toFixed(-0.25f, 2), "-0.25");
+	BOOST_CHECK_EQUAL(toFixed(2.5f, 0), "2");
+}
+BOOST_AUTO_TEST_CASE(matchesPrintf) {
+	char buffer[32];
+	for (int i = 0; i <= 1000; i++) {
+		float value = i / 1000.0f;
+		std::snprintf(buffer, sizeof(buffer), "%0.3f", value);
+		BOOST_CHECK_EQUAL(toFixed(value, 3), buffer);
+	}
+}
+BOOST_AUTO_TEST_SUITE_END()
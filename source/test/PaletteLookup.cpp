@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include "math/PaletteLookup.h"
+#include <random>
+using namespace math;
+BOOST_AUTO_TEST_SUITE(paletteLookup)
+static std::vector<Color> randomPalette(size_t size, uint32_t seed) {
+	std::mt19937 generator(seed);
+	std::uniform_real_distribution<float> distribution(0.0f, 1.0f);
+	std::vector<Color> colors;
+	for (size_t i = 0; i < size; ++i)
+		colors.emplace_back(distribution(generator), distribution(generator), distribution(generator));
+	return colors;
+}
+static void checkAgainstLinear(const PaletteLookup &lookup) {
+	for (int red = 0; red < 256; red += 3) {
+		for (int green = 0; green < 256; green += 5) {
+			for (int blue = 0; blue < 256; blue += 7) {
+				auto r = static_cast<uint8_t>(red), g = static_cast<uint8_t>(green), b = static_cast<uint8_t>(blue);
+				BOOST_REQUIRE_EQUAL(lookup.find(r, g, b), lookup.findLinear(r, g, b));
+			}
+		}
+	}
+}
+BOOST_AUTO_TEST_CASE(singleColor) {
+	PaletteLookup lookup({ Color(0.5f, 0.5f, 0.5f) });
+	BOOST_CHECK_EQUAL(lookup.size(), 1);
+	BOOST_CHECK_EQUAL(lookup.find(0, 0, 0), 0);
+	BOOST_CHECK_EQUAL(lookup.find(255, 255, 255), 0);
+	BOOST_CHECK_EQUAL(lookup.averageCandidates(), 1.0f);
+}
+BOOST_AUTO_TEST_CASE(exactColors) {
+	std::vector<Color> colors = { Color(0, 0, 0), Color(255, 0, 0), Color(0, 255, 0), Color(0, 0, 255), Color(255, 255, 255) };
+	PaletteLookup lookup(colors);
+	BOOST_CHECK_EQUAL(lookup.find(0, 0, 0), 0);
+	BOOST_CHECK_EQUAL(lookup.find(250, 10, 10), 1);
+	BOOST_CHECK_EQUAL(lookup.find(10, 250, 10), 2);
+	BOOST_CHECK_EQUAL(lookup.find(10, 10, 250), 3);
+	BOOST_CHECK_EQUAL(lookup.find(200, 200, 200), 4);
+}
+BOOST_AUTO_TEST_CASE(duplicateColorsPreferFirst) {
+	std::vector<Color> colors = { Color(10, 20, 30), Color(10, 20, 30) };
+	PaletteLookup lookup(colors);
+	BOOST_CHECK_EQUAL(lookup.find(10, 20, 30), 0);
+	BOOST_CHECK_EQUAL(lookup.find(200, 100, 0), 0);
+}
+BOOST_AUTO_TEST_CASE(matchesLinearSearch) {
+	for (size_t size: { 2, 16, 256 }) {
+		PaletteLookup lookup(randomPalette(size, static_cast<uint32_t>(size)));
+		BOOST_CHECK_EQUAL(lookup.size(), size);
+		BOOST_CHECK_LT(lookup.averageCandidates(), static_cast<float>(size));
+		checkAgainstLinear(lookup);
+	}
+}
+BOOST_AUTO_TEST_CASE(rebuild) {
+	PaletteLookup lookup(randomPalette(64, 1));
+	lookup.build(randomPalette(8, 2));
+	BOOST_CHECK_EQUAL(lookup.size(), 8);
+	checkAgainstLinear(lookup);
+	lookup.build({});
+	BOOST_CHECK(lookup.empty());
+}
+BOOST_AUTO_TEST_SUITE_END()
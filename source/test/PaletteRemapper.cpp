@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include "math/PaletteRemapper.h"
+#include <random>
+using namespace math;
+BOOST_AUTO_TEST_SUITE(paletteRemapper)
+static std::vector<uint8_t> randomImage(int width, int height, int channels, uint32_t seed) {
+	std::mt19937 generator(seed);
+	std::uniform_int_distribution<int> distribution(0, 255);
+	std::vector<uint8_t> data(static_cast<size_t>(width) * height * channels);
+	for (auto &value: data)
+		value = static_cast<uint8_t>(distribution(generator));
+	return data;
+}
+static std::vector<uint32_t> remap(const PaletteLookup &lookup, PaletteRemapper::Dithering dithering, std::vector<uint8_t> &source, int width, int height, size_t threadCount, std::vector<uint8_t> &output) {
+	output.assign(source.size(), 0);
+	std::vector<uint32_t> indexes(static_cast<size_t>(width) * height);
+	PaletteRemapper::Image sourceImage{ source.data(), width, height, width * 3, 3 }, destinationImage{ output.data(), width, height, width * 3, 3 };
+	PaletteRemapper(lookup, dithering).remap(sourceImage, destinationImage, indexes.data(), threadCount);
+	return indexes;
+}
+BOOST_AUTO_TEST_CASE(threadCountDoesNotChangeResult) {
+	const int width = 97, height = 61;
+	PaletteLookup lookup({ Color(0.0f, 0.0f, 0.0f), Color(1.0f, 1.0f, 1.0f), Color(1.0f, 0.0f, 0.0f), Color(0.0f, 0.5f, 1.0f), Color(0.5f, 0.5f, 0.0f) });
+	auto source = randomImage(width, height, 3, 7);
+	for (auto dithering: { PaletteRemapper::Dithering::none, PaletteRemapper::Dithering::ordered, PaletteRemapper::Dithering::floydSteinberg }) {
+		std::vector<uint8_t> single, multiple;
+		auto singleIndexes = remap(lookup, dithering, source, width, height, 1, single);
+		auto multipleIndexes = remap(lookup, dithering, source, width, height, 7, multiple);
+		BOOST_CHECK(singleIndexes == multipleIndexes);
+		BOOST_CHECK(single == multiple);
+	}
+}
+BOOST_AUTO_TEST_CASE(errorDiffusionKeepsAverage) {
+	const int width = 64, height = 64;
+	PaletteLookup lookup({ Color(0.0f, 0.0f, 0.0f), Color(1.0f, 1.0f, 1.0f) });
+	std::vector<uint8_t> source(static_cast<size_t>(width) * height * 3, 128), output;
+	auto indexes = remap(lookup, PaletteRemapper::Dithering::floydSteinberg, source, width, height, 4, output);
+	size_t white = 0;
+	for (auto index: indexes)
+		white += index;
+	BOOST_CHECK_CLOSE(static_cast<double>(white) / indexes.size(), 128.0 / 255.0, 3.0);
+	for (int y = 0; y < height; y++) {
+		size_t rowWhite = 0;
+		for (int x = 0; x < width; x++)
+			rowWhite += indexes[static_cast<size_t>(y) * width + x];
+		BOOST_CHECK_GT(rowWhite, 16u);
+		BOOST_CHECK_LT(rowWhite, 48u);
+	}
+}
+BOOST_AUTO_TEST_SUITE_END()
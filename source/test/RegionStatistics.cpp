@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <boost/test/unit_test.hpp>
+#include "math/RegionStatistics.h"
+#include <random>
+#include <vector>
+using namespace math;
+BOOST_AUTO_TEST_SUITE(regionStatistics)
+static uint32_t pixel(int red, int green, int blue) {
+	return (static_cast<uint32_t>(red) << 16) | (static_cast<uint32_t>(green) << 8) | static_cast<uint32_t>(blue);
+}
+static void checkColor(const Color &color, int red, int green, int blue) {
+	BOOST_CHECK_CLOSE(color.red, red / 255.0f, 1e-3f);
+	BOOST_CHECK_CLOSE(color.green, green / 255.0f, 1e-3f);
+	BOOST_CHECK_CLOSE(color.blue, blue / 255.0f, 1e-3f);
+}
+BOOST_AUTO_TEST_CASE(uniform) {
+	std::vector<uint32_t> image(16 * 8, pixel(10, 20, 30));
+	auto statistics = math::regionStatistics(reinterpret_cast<const uint8_t *>(image.data()), 16, 8, 16 * 4);
+	BOOST_CHECK_EQUAL(statistics.pixels, 128);
+	checkColor(statistics.mean, 10, 20, 30);
+	checkColor(statistics.median, 10, 20, 30);
+	checkColor(statistics.dominant, 10, 20, 30);
+	for (int channel = 0; channel < 3; channel++)
+		BOOST_CHECK_SMALL(statistics.variance[channel], 1e-9f);
+}
+BOOST_AUTO_TEST_CASE(meanMedianDominant) {
+	// Three quarters of pixels are red, rest are split between two dark colors.
+	std::vector<uint32_t> image(8 * 8, pixel(255, 0, 0));
+	for (int i = 0; i < 8; i++)
+		image[i] = pixel(0, 0, 255);
+	for (int i = 8; i < 16; i++)
+		image[i] = pixel(0, 255, 0);
+	auto statistics = math::regionStatistics(reinterpret_cast<const uint8_t *>(image.data()), 8, 8, 8 * 4);
+	BOOST_CHECK_CLOSE(statistics.mean.red, 0.75f, 1e-3f);
+	BOOST_CHECK_CLOSE(statistics.mean.green, 0.125f, 1e-3f);
+	BOOST_CHECK_CLOSE(statistics.mean.blue, 0.125f, 1e-3f);
+	checkColor(statistics.median, 255, 0, 0);
+	checkColor(statistics.dominant, 255, 0, 0);
+	BOOST_CHECK_CLOSE(statistics.variance[0], 0.75f * 0.25f, 1e-2f);
+}
+BOOST_AUTO_TEST_CASE(stride) {
+	// Only first 4 pixels of each 6 pixel row belong to region.
+	std::vector<uint32_t> image(6 * 4, pixel(255, 255, 255));
+	for (int y = 0; y < 4; y++)
+		for (int x = 0; x < 4; x++)
+			image[x + y * 6] = pixel(x * 10, y * 10, 0);
+	auto statistics = math::regionStatistics(reinterpret_cast<const uint8_t *>(image.data()), 4, 4, 6 * 4);
+	BOOST_CHECK_EQUAL(statistics.pixels, 16);
+	BOOST_CHECK_CLOSE(statistics.mean.red, 15 / 255.0f, 1e-3f);
+	BOOST_CHECK_CLOSE(statistics.mean.green, 15 / 255.0f, 1e-3f);
+	BOOST_CHECK_SMALL(statistics.mean.blue, 1e-6f);
+	checkColor(statistics.median, 10, 10, 0);
+}
+BOOST_AUTO_TEST_CASE(tilesMatchSingleThread) {
+	const int width = 512, height = 300;
+	std::mt19937 random(1);
+	std::uniform_int_distribution<int> distribution(0, 255);
+	std::vector<uint32_t> image(width * height);
+	for (auto &value: image)
+		value = pixel(distribution(random), distribution(random) / 2, 100);
+	auto single = math::regionStatistics(reinterpret_cast<const uint8_t *>(image.data()), width, height, width * 4, 1);
+	auto parallel = math::regionStatistics(reinterpret_cast<const uint8_t *>(image.data()), width, height, width * 4, 4);
+	BOOST_CHECK_EQUAL(single.pixels, parallel.pixels);
+	for (int channel = 0; channel < 3; channel++) {
+		BOOST_CHECK_EQUAL(single.mean[channel], parallel.mean[channel]);
+		BOOST_CHECK_EQUAL(single.median[channel], parallel.median[channel]);
+		BOOST_CHECK_EQUAL(single.dominant[channel], parallel.dominant[channel]);
+		BOOST_CHECK_EQUAL(single.variance[channel], parallel.variance[channel]);
+	}
+}
+BOOST_AUTO_TEST_SUITE_END()
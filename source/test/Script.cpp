@@ -20,6 +20,8 @@
 #include "lua/Script.h"
 #include "lua/Lua.h"
 #include "common/Scoped.h"
+#include <filesystem>
+#include <fstream>
 using namespace lua;
 static int test(lua_State *L) {
 	lua_pushstring(L, "ok");
@@ -92,4 +94,25 @@ BOOST_AUTO_TEST_CASE(errorHandling) {
 	BOOST_CHECK(status == false);
 	BOOST_CHECK(cleanupOnError == true);
 }
+BOOST_AUTO_TEST_CASE(bytecodeCache) {
+	auto path = std::filesystem::temp_directory_path() / "gpick-test-script-cache";
+	std::filesystem::remove_all(path);
+	std::filesystem::create_directories(path);
+	std::ofstream(path / "cacheTest.lua") << "return 42";
+	auto load = [&path]() {
+		Script script;
+		script.setPaths({ path.string() });
+		script.setCachePath((path / "cache").string());
+		BOOST_REQUIRE(script.load("cacheTest"));
+		BOOST_CHECK_EQUAL(lua_tointeger(script, -1), 42);
+		return script.loadStatistics();
+	};
+	auto statistics = load();
+	BOOST_CHECK_EQUAL(statistics.compiled, 1);
+	BOOST_CHECK_EQUAL(statistics.cached, 0);
+	statistics = load();
+	BOOST_CHECK_EQUAL(statistics.compiled, 0);
+	BOOST_CHECK_EQUAL(statistics.cached, 1);
+	std::filesystem::remove_all(path);
+}
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2009-2020, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include "lua/StatePool.h"
+#include "lua/Script.h"
+#include "lua/ColorObject.h"
+#include "lua/Lua.h"
+#include "ColorObject.h"
+using namespace lua;
+static bool initialize(Script &script) {
+	script.registerExtension("colorObject", registerColorObject);
+	if (!script.loadCode("return function(colorObject, position) return colorObject:getName() .. position.index .. (position.last and '.' or '') end"))
+		return false;
+	if (!script.run(0, 1))
+		return false;
+	lua_State *L = script;
+	lua_getfield(L, LUA_REGISTRYINDEX, StatePool::convertersKey);
+	lua_pushvalue(L, -2);
+	lua_setfield(L, -2, "test");
+	lua_pop(L, 2);
+	return true;
+}
+static bool prepare(Script &) {
+	return true;
+}
+BOOST_AUTO_TEST_SUITE(statePool)
+BOOST_AUTO_TEST_CASE(serialize) {
+	StatePool statePool(3, initialize, prepare);
+	std::vector<ColorObject> colorObjects(10, ColorObject("c", Color()));
+	std::vector<const ColorObject *> pointers;
+	for (auto &colorObject: colorObjects)
+		pointers.push_back(&colorObject);
+	std::vector<std::string> result;
+	size_t errors = 1;
+	BOOST_REQUIRE(statePool.serialize("test", pointers, result, errors));
+	BOOST_CHECK_EQUAL(errors, 0);
+	BOOST_REQUIRE_EQUAL(result.size(), 10);
+	for (size_t i = 0; i < 9; i++)
+		BOOST_CHECK_EQUAL(result[i], "c" + std::to_string(i));
+	BOOST_CHECK_EQUAL(result[9], "c9.");
+}
+BOOST_AUTO_TEST_CASE(missingConverter) {
+	StatePool statePool(2, initialize, prepare);
+	ColorObject colorObject("c", Color());
+	std::vector<std::string> result;
+	size_t errors;
+	BOOST_CHECK(!statePool.serialize("missing", { &colorObject }, result, errors));
+}
+BOOST_AUTO_TEST_CASE(failedInitialization) {
+	StatePool statePool(2, [](Script &) { return false; }, prepare);
+	ColorObject colorObject("c", Color());
+	std::vector<std::string> result;
+	size_t errors;
+	BOOST_CHECK(!statePool.serialize("test", { &colorObject }, result, errors));
+}
+BOOST_AUTO_TEST_SUITE_END()
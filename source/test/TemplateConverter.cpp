@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include "TemplateConverter.h"
+#include "Converter.h"
+#include "Converters.h"
+#include "ColorObject.h"
+#include "Common.h"
+BOOST_AUTO_TEST_SUITE(templateConverter)
+BOOST_AUTO_TEST_CASE(compile) {
+	BOOST_CHECK(TemplateConverter::compile("rgb({r}, {g}, {b})"));
+	BOOST_CHECK(TemplateConverter::compile("#{r:x}{g:x}{b:x}"));
+	BOOST_CHECK(TemplateConverter::compile("{{{name}}}"));
+	BOOST_CHECK(!TemplateConverter::compile(""));
+	BOOST_CHECK(!TemplateConverter::compile("rgb({r, {g}, {b})"));
+	BOOST_CHECK(!TemplateConverter::compile("{x}"));
+	BOOST_CHECK(!TemplateConverter::compile("{r:y}"));
+	BOOST_CHECK(!TemplateConverter::compile("{name:x}"));
+	BOOST_CHECK(!TemplateConverter::compile("}"));
+	BOOST_CHECK(TemplateConverter::compile("rgb({r}, {g}, {b})")->canDeserialize());
+	BOOST_CHECK(TemplateConverter::compile("hsl({h}, {s}%, {l}%)")->canDeserialize());
+	BOOST_CHECK(!TemplateConverter::compile("{r} {g}")->canDeserialize());
+	BOOST_CHECK(!TemplateConverter::compile("{h} {s}")->canDeserialize());
+}
+BOOST_AUTO_TEST_CASE(serialize) {
+	Converter::Options options = {};
+	ColorObject colorObject("test", Color(32, 64, 128, 255));
+	const struct {
+		const char *format;
+		const char *text;
+	} formats[] = {
+		{ "rgb({r}, {g}, {b})", "rgb(32, 64, 128)" },
+		{ "#{r:x}{g:x}{b:x}{a:x}", "#204080ff" },
+		{ "{r:%} {g:%} {b:%}", "12 25 50" },
+		{ "{r:f} {a:f}", "0.125 1.000" },
+		{ "hsl({h}, {s}%, {l}%)", "hsl(220, 60%, 31%)" },
+		{ "{{{name}}}", "{test}" },
+	};
+	for (size_t i = 0; i < sizeof(formats) / sizeof(formats[0]); ++i) {
+		auto templateConverter = TemplateConverter::compile(formats[i].format);
+		BOOST_REQUIRE(templateConverter);
+		BOOST_CHECK_EQUAL(templateConverter->serialize(colorObject, options), formats[i].text);
+	}
+	options.upperCaseHex = true;
+	BOOST_CHECK_EQUAL(TemplateConverter::compile("{r:x}{g:x}{b:x}{a:x}")->serialize(colorObject, options), "204080FF");
+}
+BOOST_AUTO_TEST_CASE(deserialize) {
+	Converter::Options options = {};
+	Converters converters;
+	BOOST_REQUIRE(addTemplateConverter(converters, "rgb", "RGB", "rgb({r}, {g}, {b})", options));
+	BOOST_REQUIRE(addTemplateConverter(converters, "hex", "Hex", "0x{r:x}{g:x}{b:x}{a:x}", options));
+	BOOST_REQUIRE(addTemplateConverter(converters, "name", "Name", "{name}: {r} {g} {b}", options));
+	ColorObject colorObject;
+	float quality;
+	const struct {
+		const char *converter;
+		const char *text;
+		bool good;
+		Color color;
+	} colors[] = {
+		{ "rgb", "", false, { } },
+		{ "rgb", "rgb(32, 64)", false, { } },
+		{ "rgb", "rgb(32 64 128)", false, { } },
+		{ "rgb", "rgb(32, 64, 128)", true, { 32, 64, 128, 255 } },
+		{ "rgb", "rgb(32,64,128)", true, { 32, 64, 128, 255 } },
+		{ "rgb", " rgb(32,  64, 128) ", true, { 32, 64, 128, 255 } },
+		{ "rgb", "rgb(rgb(32, 64, 128)", true, { 32, 64, 128, 255 } },
+		{ "hex", "0x2040", false, { } },
+		{ "hex", "0x20408010", true, { 32, 64, 128, 16 } },
+		{ "hex", "x 0x20408010", true, { 32, 64, 128, 16 } },
+		{ "name", "red 32 64 128", false, { } },
+		{ "name", "red: 32 64 128", true, { 32, 64, 128, 255 } },
+	};
+	for (size_t i = 0; i < sizeof(colors) / sizeof(colors[0]); ++i) {
+		auto *converter = converters.byName(colors[i].converter);
+		BOOST_REQUIRE(converter != nullptr);
+		bool good = converter->deserialize(colors[i].text, colorObject, quality);
+		BOOST_CHECK_MESSAGE(good == colors[i].good, "wrong result at index " << i);
+		if (good && colors[i].good)
+			BOOST_CHECK_MESSAGE(colorObject.getColor() == colors[i].color, "wrong color at index " << i << ", " << colorObject.getColor() << " != " << colors[i].color);
+	}
+	BOOST_CHECK_EQUAL(colorObject.getName(), "red");
+}
+BOOST_AUTO_TEST_CASE(roundTrip) {
+	Converter::Options options = {};
+	Converters converters;
+	BOOST_REQUIRE(addTemplateConverter(converters, "hsl", "HSL", "hsl({h}, {s}%, {l}%)", options));
+	auto *converter = converters.byName("hsl");
+	BOOST_REQUIRE(converter != nullptr);
+	BOOST_REQUIRE(converter->hasSerialize() && converter->hasDeserialize());
+	ColorObject colorObject;
+	float quality;
+	auto text = converter->serialize(Color(255, 128, 0, 255));
+	BOOST_CHECK_EQUAL(text, "hsl(30, 100%, 50%)");
+	BOOST_REQUIRE(converter->deserialize(text.c_str(), colorObject, quality));
+	BOOST_CHECK_EQUAL(converter->serialize(colorObject), text);
+	BOOST_CHECK_CLOSE(quality, 1.0f, 1e-3);
+}
+BOOST_AUTO_TEST_CASE(signature) {
+	auto signature = TemplateConverter::compile("rgb({r}, {g}, {b:x})")->signature();
+	BOOST_CHECK(signature.classes() == (CharacterClass::hexDigit | CharacterClass::digit | CharacterClass::parenthesis | CharacterClass::comma));
+	BOOST_REQUIRE_EQUAL(signature.substrings().size(), 4u);
+	BOOST_CHECK_EQUAL(signature.substrings().front(), "rgb(");
+	BOOST_CHECK(signature.matches(ConverterSignature::classify("rgb(1,2,ff)"), "rgb(1,2,ff)"));
+	BOOST_CHECK(!signature.matches(ConverterSignature::classify("rgb 1, 2, ff"), "rgb 1, 2, ff"));
+}
+BOOST_AUTO_TEST_SUITE_END()
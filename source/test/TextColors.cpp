@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include "TextColors.h"
+#include "Converters.h"
+#include "InternalConverters.h"
+#include "Common.h"
+#include <string>
+#include <vector>
+namespace {
+struct WebHexConverters {
+	WebHexConverters(const char *displayConverter) {
+		Converter::Options options = {};
+		addInternalConverters(converters, options);
+		converters.display(displayConverter);
+	}
+	Converters converters;
+};
+void checkColors(const std::vector<ColorObject> &colorObjects, const std::vector<Color> &expected) {
+	BOOST_REQUIRE_EQUAL(colorObjects.size(), expected.size());
+	for (size_t i = 0; i < expected.size(); ++i)
+		BOOST_CHECK_MESSAGE(colorObjects[i].getColor() == expected[i], "wrong color at index " << i << ", " << colorObjects[i].getColor() << " != " << expected[i]);
+}
+}
+BOOST_AUTO_TEST_SUITE(textColors)
+BOOST_AUTO_TEST_CASE(cssPaste) {
+	WebHexConverters webHex("color_web_hex");
+	auto colorObjects = extractColors("body {\n\tfont-weight: 700;\n\twidth: 1024px;\n\tmargin: 0 0 0;\n\tcolor: #ff0000;\n\tbackground: rgb(0, 255, 0);\n}\n.fade { transition: add decade; }\n", webHex.converters);
+	checkColors(colorObjects, { Color(255, 0, 0), Color(0, 255, 0) });
+}
+BOOST_AUTO_TEST_CASE(bareValuesUseConverters) {
+	WebHexConverters webHexNoHash("color_web_hex_no_hash");
+	auto colorObjects = extractColors("ff0000\n#00ff00\n0000ff\n700\n", webHexNoHash.converters);
+	checkColors(colorObjects, { Color(255, 0, 0), Color(0, 255, 0), Color(0, 0, 255) });
+}
+BOOST_AUTO_TEST_CASE(colorsKeepLineOrder) {
+	WebHexConverters webHex("color_web_hex");
+	auto colorObjects = extractColors("a { border: #fff rgb(0, 0, 255) #ff000080; }\nb { color: #12345; background: #00ff00 }\n", webHex.converters);
+	checkColors(colorObjects, { Color(1.0f, 1.0f, 1.0f), Color(0, 0, 255), Color(255, 0, 0, 128), Color(0, 255, 0) });
+}
+BOOST_AUTO_TEST_CASE(textLargerThanScannerBuffer) {
+	WebHexConverters webHexNoHash("color_web_hex_no_hash");
+	std::string text;
+	std::vector<Color> expected;
+	for (int i = 0; i < 3000; ++i) {
+		text += i % 2 ? "\tcolor: #0000ff;\n" : "ff0000\n";
+		expected.push_back(i % 2 ? Color(0, 0, 255) : Color(255, 0, 0));
+	}
+	text += "rgb(0, 255, 0)";
+	expected.push_back(Color(0, 255, 0));
+	checkColors(extractColors(text, webHexNoHash.converters), expected);
+}
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include "common/TripleBuffer.h"
+#include <thread>
+using namespace common;
+BOOST_AUTO_TEST_SUITE(tripleBuffer)
+BOOST_AUTO_TEST_CASE(empty) {
+	TripleBuffer<int> buffer;
+	BOOST_CHECK(!buffer.consume());
+}
+BOOST_AUTO_TEST_CASE(latestValue) {
+	TripleBuffer<int> buffer;
+	buffer.writeBuffer() = 1;
+	buffer.publish();
+	buffer.writeBuffer() = 2;
+	buffer.publish();
+	BOOST_REQUIRE(buffer.consume());
+	BOOST_CHECK_EQUAL(buffer.readBuffer(), 2);
+	BOOST_CHECK(!buffer.consume());
+	BOOST_CHECK_EQUAL(buffer.readBuffer(), 2);
+	buffer.writeBuffer() = 3;
+	buffer.publish();
+	BOOST_REQUIRE(buffer.consume());
+	BOOST_CHECK_EQUAL(buffer.readBuffer(), 3);
+}
+BOOST_AUTO_TEST_CASE(concurrent) {
+	struct Value {
+		uint32_t first, second;
+	};
+	TripleBuffer<Value> buffer;
+	const uint32_t count = 100000;
+	std::thread producer([&buffer]() {
+		for (uint32_t i = 1; i <= count; ++i) {
+			auto &value = buffer.writeBuffer();
+			value.first = i;
+			value.second = i * 2;
+			buffer.publish();
+		}
+	});
+	uint32_t last = 0;
+	bool consistent = true, ordered = true;
+	while (last < count) {
+		if (!buffer.consume())
+			continue;
+		const auto &value = buffer.readBuffer();
+		if (value.second != value.first * 2)
+			consistent = false;
+		if (value.first <= last)
+			ordered = false;
+		last = value.first;
+	}
+	producer.join();
+	BOOST_CHECK(consistent);
+	BOOST_CHECK(ordered);
+}
+BOOST_AUTO_TEST_SUITE_END()
@@ -27,12 +27,19 @@
 #include "dynv/Map.h"
 #include "math/OctreeColorQuantization.h"
 #include "common/Guard.h"
+#include "common/Format.h"
 #include <iostream>
 #include <sstream>
 #include <string>
 #include <thread>
 #include <mutex>
+#include <atomic>
+#include <memory>
+#include <random>
+#include <cmath>
+#include <iomanip>
 
+namespace {
 struct PaletteColorNameAssigner: public ToolColorNameAssigner {
 	PaletteColorNameAssigner(GlobalState &gs):
 		ToolColorNameAssigner(gs) {
@@ -53,115 +60,258 @@ protected:
 	std::string_view m_fileName;
 	int m_index;
 };
+uint8_t toUint8(float value) {
+	return static_cast<uint8_t>(std::max(std::min(static_cast<int>(value * 256), 255), 0));
+}
+void addPixel(math::OctreeColorQuantization &octree, const guchar *dataPointer, int channels, size_t pixels) {
+	Color color;
+	if (channels == 1) {
+		color.xyz.x = color.xyz.y = color.xyz.z = dataPointer[0] / 255.0f;
+	} else {
+		color.xyz.x = dataPointer[0] / 255.0f;
+		color.xyz.y = dataPointer[1] / 255.0f;
+		color.xyz.z = dataPointer[2] / 255.0f;
+	}
+	color.alpha = 1.0f;
+	color.linearRgbInplace();
+	std::array<uint8_t, 3> position = { dataPointer[0], dataPointer[channels == 1 ? 0 : 1], dataPointer[channels == 1 ? 0 : 2] };
+	if (pixels == 1)
+		octree.add(color, position);
+	else
+		octree.add(color, pixels, position);
+}
+bool processAllPixels(GdkPixbuf *pixbuf, math::OctreeColorQuantization &octree, const std::atomic_bool &cancel) {
+	int channels = gdk_pixbuf_get_n_channels(pixbuf);
+	int width = gdk_pixbuf_get_width(pixbuf);
+	int height = gdk_pixbuf_get_height(pixbuf);
+	int stride = gdk_pixbuf_get_rowstride(pixbuf);
+	guchar *imageData = gdk_pixbuf_get_pixels(pixbuf);
+	if (width * height < (1 << 16) || std::max(1u, std::thread::hardware_concurrency()) == 1) {
+		for (int y = 0; y < height; y++) {
+			if (cancel)
+				return false;
+			guchar *dataPointer = imageData + stride * y;
+			for (int x = 0; x < width; x++) {
+				addPixel(octree, dataPointer, channels, 1);
+				dataPointer += channels;
+			}
+		}
+	} else {
+		size_t threadCount = std::min(8u, std::thread::hardware_concurrency());
+		std::mutex octreeMutex;
+		std::vector<std::thread> threads(threadCount);
+		size_t index = 0;
+		for (auto &thread: threads) {
+			thread = std::thread([&octree, &octreeMutex, &cancel, index, threadCount, imageData, channels, width, height, stride]() {
+				math::OctreeColorQuantization threadOctree;
+				for (int y = static_cast<int>(index); y < height; y += threadCount) {
+					if (cancel)
+						return;
+					guchar *dataPointer = imageData + stride * y;
+					for (int x = 0; x < width; x++) {
+						addPixel(threadOctree, dataPointer, channels, 1);
+						dataPointer += channels;
+					}
+				}
+				threadOctree.reduce(1000);
+				std::scoped_lock<std::mutex> lock(octreeMutex);
+				threadOctree.visit([&octree](const float sum[3], size_t pixels) {
+					Color color(sum[0] / pixels, sum[1] / pixels, sum[2] / pixels, 1.0f);
+					Color nonLinearColor = color.nonLinearRgb();
+					std::array<uint8_t, 3> position = { toUint8(nonLinearColor.red), toUint8(nonLinearColor.green), toUint8(nonLinearColor.blue) };
+					octree.add(color, pixels, position);
+				});
+			});
+			++index;
+		}
+		for (auto &thread: threads) {
+			thread.join();
+		}
+		if (cancel)
+			return false;
+	}
+	octree.reduce(1000);
+	return true;
+}
+// Stratified sampling: image is split into equal square tiles and a single random pixel from each tile is added with a weight equal to the tile area.
+size_t processSampledPixels(GdkPixbuf *pixbuf, size_t sampleBudget, math::OctreeColorQuantization &octree) {
+	int channels = gdk_pixbuf_get_n_channels(pixbuf);
+	int width = gdk_pixbuf_get_width(pixbuf);
+	int height = gdk_pixbuf_get_height(pixbuf);
+	int stride = gdk_pixbuf_get_rowstride(pixbuf);
+	guchar *imageData = gdk_pixbuf_get_pixels(pixbuf);
+	auto tileCount = [width, height](int tileSize) {
+		return static_cast<size_t>((width + tileSize - 1) / tileSize) * ((height + tileSize - 1) / tileSize);
+	};
+	int tileSize = std::max(1, static_cast<int>(std::sqrt(static_cast<double>(width) * height / sampleBudget)));
+	while (tileCount(tileSize) > sampleBudget)
+		++tileSize;
+	std::mt19937 generator(static_cast<uint32_t>(width * 31 + height));
+	size_t samples = 0;
+	for (int tileY = 0; tileY < height; tileY += tileSize) {
+		int tileHeight = std::min(tileSize, height - tileY);
+		for (int tileX = 0; tileX < width; tileX += tileSize) {
+			int tileWidth = std::min(tileSize, width - tileX);
+			int x = tileX + static_cast<int>(generator() % static_cast<uint32_t>(tileWidth));
+			int y = tileY + static_cast<int>(generator() % static_cast<uint32_t>(tileHeight));
+			addPixel(octree, imageData + stride * y + x * channels, channels, static_cast<size_t>(tileWidth) * tileHeight);
+			++samples;
+		}
+	}
+	octree.reduce(1000);
+	return samples;
+}
+// Largest standard error of a single color weight, expressed as a fraction of all pixels. Binomial estimate is used as stratification can only reduce the error.
+float estimateWeightError(const std::vector<size_t> &weights, size_t samples) {
+	size_t totalPixels = 0;
+	for (auto pixels: weights)
+		totalPixels += pixels;
+	float result = 0;
+	if (totalPixels == 0 || samples == 0)
+		return result;
+	for (auto pixels: weights) {
+		double ratio = static_cast<double>(pixels) / totalPixels;
+		result = std::max(result, static_cast<float>(std::sqrt(ratio * (1 - ratio) / samples)));
+	}
+	return result;
+}
+GdkPixbuf *loadImage(const std::string &filename) {
+	GError *error = nullptr;
+	GdkPixbuf *pixbuf = gdk_pixbuf_new_from_file(filename.c_str(), &error);
+	if (error) {
+		std::cerr << error->message << '\n';
+		g_error_free(error);
+		return nullptr;
+	}
+	return pixbuf;
+}
+void collectColors(const math::OctreeColorQuantization &octree, uint32_t numberOfColors, std::vector<Color> &colors, std::vector<size_t> &weights) {
+	math::OctreeColorQuantization reducedOctree(octree);
+	reducedOctree.reduce(numberOfColors);
+	reducedOctree.visit([&colors, &weights](const float sum[3], size_t pixels) {
+		Color color(sum[0] / pixels, sum[1] / pixels, sum[2] / pixels, 1.0f);
+		color.nonLinearRgbInplace();
+		colors.push_back(color);
+		weights.push_back(pixels);
+	});
+}
+std::string describeSampling(size_t processedPixels, size_t totalPixels, float weightError) {
+	if (processedPixels >= totalPixels)
+		return common::format(_("Processed all {} pixels"), totalPixels);
+	std::stringstream error;
+	error << std::fixed << std::setprecision(2) << weightError * 100;
+	return common::format(_("Processed {} of {} pixels, color weight error ±{}%"), processedPixels, totalPixels, error.str());
+}
+}
 struct PaletteFromImageArgs {
-	GtkWidget *fileBrowser, *rangeColors, *previewExpander;
+	GtkWidget *fileBrowser, *rangeColors, *rangeSampleBudget, *previewExpander, *samplingLabel;
 	std::string filename, previousFilename;
-	uint32_t numberOfColors;
-	math::OctreeColorQuantization octree;
+	uint32_t numberOfColors, sampleBudget, previousSampleBudget;
+	std::unique_ptr<math::OctreeColorQuantization> octree, fullOctree;
+	GdkPixbuf *pixbuf;
+	std::thread fullPassThread;
+	std::atomic_bool cancelFullPass, fullPassDone;
+	guint fullPassTimeout;
+	size_t processedPixels, totalPixels;
 	common::Ref<ColorList> previewColorList;
 	dynv::Ref options;
 	GlobalState *gs;
-	static uint8_t toUint8(float value) {
-		return static_cast<uint8_t>(std::max(std::min(static_cast<int>(value * 256), 255), 0));
+	PaletteFromImageArgs():
+		previousSampleBudget(0),
+		octree(std::make_unique<math::OctreeColorQuantization>()),
+		pixbuf(nullptr),
+		cancelFullPass(false),
+		fullPassDone(false),
+		fullPassTimeout(0),
+		processedPixels(0),
+		totalPixels(0) {
+	}
+	~PaletteFromImageArgs() {
+		stopFullPass();
+		if (pixbuf)
+			g_object_unref(pixbuf);
+	}
+	void stopFullPass() {
+		if (fullPassTimeout) {
+			g_source_remove(fullPassTimeout);
+			fullPassTimeout = 0;
+		}
+		if (fullPassThread.joinable()) {
+			cancelFullPass = true;
+			fullPassThread.join();
+		}
+		cancelFullPass = false;
+		fullPassDone = false;
+		fullOctree.reset();
+	}
+	bool finishFullPass(bool wait) {
+		if (!fullPassThread.joinable() || (!wait && !fullPassDone))
+			return false;
+		fullPassThread.join();
+		if (fullPassTimeout) {
+			g_source_remove(fullPassTimeout);
+			fullPassTimeout = 0;
+		}
+		octree = std::move(fullOctree);
+		processedPixels = totalPixels;
+		fullPassDone = false;
+		return true;
+	}
+	static gboolean onFullPassPoll(PaletteFromImageArgs *args) {
+		if (!args->fullPassDone)
+			return true;
+		args->fullPassTimeout = 0;
+		args->finishFullPass(false);
+		args->previewColorList->removeAll();
+		args->update(true);
+		return false;
 	}
 	void processImage() {
+		stopFullPass();
 		previousFilename = filename;
-		octree.clear();
-		GError *error = nullptr;
-		GdkPixbuf *pixbuf = gdk_pixbuf_new_from_file(filename.c_str(), &error);
-		if (error) {
-			std::cout << error->message << '\n';
-			g_error_free(error);
+		previousSampleBudget = sampleBudget;
+		octree->clear();
+		processedPixels = totalPixels = 0;
+		if (pixbuf)
+			g_object_unref(pixbuf);
+		pixbuf = loadImage(filename);
+		if (!pixbuf)
+			return;
+		totalPixels = static_cast<size_t>(gdk_pixbuf_get_width(pixbuf)) * gdk_pixbuf_get_height(pixbuf);
+		if (sampleBudget == 0 || sampleBudget >= totalPixels) {
+			processAllPixels(pixbuf, *octree, cancelFullPass);
+			processedPixels = totalPixels;
 			return;
 		}
-		int channels = gdk_pixbuf_get_n_channels(pixbuf);
-		int width = gdk_pixbuf_get_width(pixbuf);
-		int height = gdk_pixbuf_get_height(pixbuf);
-		int stride = gdk_pixbuf_get_rowstride(pixbuf);
-		guchar *imageData = gdk_pixbuf_get_pixels(pixbuf);
-		if (width * height < (1 << 16) || std::max(1u, std::thread::hardware_concurrency()) == 1) {
-			guchar *dataPointer = imageData;
-			Color color;
-			for (int y = 0; y < height; y++) {
-				dataPointer = imageData + stride * y;
-				for (int x = 0; x < width; x++) {
-					if (channels == 1) {
-						color.xyz.x = color.xyz.y = color.xyz.z = dataPointer[0] / 255.0f;
-					} else {
-						color.xyz.x = dataPointer[0] / 255.0f;
-						color.xyz.y = dataPointer[1] / 255.0f;
-						color.xyz.z = dataPointer[2] / 255.0f;
-					}
-					color.alpha = 1.0f;
-					color.linearRgbInplace();
-					std::array<uint8_t, 3> position = { dataPointer[0], dataPointer[1], dataPointer[2] };
-					octree.add(color, position);
-					dataPointer += channels;
-				}
-			}
-		} else {
-			size_t threadCount = std::min(8u, std::thread::hardware_concurrency());
-			std::mutex octreeMutex;
-			std::vector<std::thread> threads(threadCount);
-			size_t index = 0;
-			for (auto &thread: threads) {
-				thread = std::thread([this, &octreeMutex, index, threadCount, imageData, channels, width, height, stride]() {
-					math::OctreeColorQuantization threadOctree;
-					guchar *dataPointer = imageData + stride * index;
-					Color color;
-					for (int y = 0; y < height; y += threadCount) {
-						dataPointer = imageData + stride * y;
-						for (int x = 0; x < width; x++) {
-							if (channels == 1) {
-								color.xyz.x = color.xyz.y = color.xyz.z = dataPointer[0] / 255.0f;
-							} else {
-								color.xyz.x = dataPointer[0] / 255.0f;
-								color.xyz.y = dataPointer[1] / 255.0f;
-								color.xyz.z = dataPointer[2] / 255.0f;
-							}
-							color.alpha = 1.0f;
-							color.linearRgbInplace();
-							std::array<uint8_t, 3> position = { dataPointer[0], dataPointer[1], dataPointer[2] };
-							threadOctree.add(color, position);
-							dataPointer += channels;
-						}
-					}
-					threadOctree.reduce(1000);
-					std::scoped_lock<std::mutex> lock(octreeMutex);
-					threadOctree.visit([this](const float sum[3], size_t pixels) {
-						Color color(sum[0] / pixels, sum[1] / pixels, sum[2] / pixels, 1.0f);
-						Color nonLinearColor = color.nonLinearRgb();
-						std::array<uint8_t, 3> position = { toUint8(nonLinearColor.red), toUint8(nonLinearColor.green), toUint8(nonLinearColor.blue) };
-						octree.add(color, pixels, position);
-					});
-				});
-				++index;
-			}
-			for (auto &thread: threads) {
-				thread.join();
-			}
-		}
-		g_object_unref(pixbuf);
-		octree.reduce(1000);
+		processedPixels = processSampledPixels(pixbuf, sampleBudget, *octree);
+		fullOctree = std::make_unique<math::OctreeColorQuantization>();
+		fullPassThread = std::thread([this]() {
+			if (processAllPixels(pixbuf, *fullOctree, cancelFullPass))
+				fullPassDone = true;
+		});
+		fullPassTimeout = g_timeout_add(100, GSourceFunc(onFullPassPoll), this);
 	}
 	void update(bool preview) {
 		int index = 0;
 		gchar *name = g_path_get_basename(filename.c_str());
 		PaletteColorNameAssigner nameAssigner(*gs);
-		if (!filename.empty() && previousFilename != filename)
+		if (!filename.empty() && (previousFilename != filename || previousSampleBudget != sampleBudget))
 			processImage();
+		if (!preview)
+			finishFullPass(true);
 		ColorList &colorList = preview ? *previewColorList : gs->colorList();
-		math::OctreeColorQuantization reducedOctree(octree);
-		reducedOctree.reduce(numberOfColors);
+		std::vector<Color> colors;
+		std::vector<size_t> weights;
+		collectColors(*octree, numberOfColors, colors, weights);
+		gtk_label_set_text(GTK_LABEL(samplingLabel), totalPixels > 0 ? describeSampling(processedPixels, totalPixels, estimateWeightError(weights, processedPixels)).c_str() : "");
 		common::Guard colorListGuard = colorList.changeGuard();
-		reducedOctree.visit([&](const float sum[3], size_t pixels) {
-			Color color(sum[0] / pixels, sum[1] / pixels, sum[2] / pixels, 1.0f);
-			color.nonLinearRgbInplace();
+		for (const auto &color: colors) {
 			ColorObject colorObject(color);
 			nameAssigner.assign(colorObject, name, index);
 			colorList.add(colorObject);
 			index++;
-		});
+		}
+		g_free(name);
 	}
 	void getSettings() {
 		gchar *filename = gtk_file_chooser_get_filename(GTK_FILE_CHOOSER(fileBrowser));
@@ -172,9 +322,11 @@ struct PaletteFromImageArgs {
 			this->filename.clear();
 		}
 		numberOfColors = static_cast<int>(gtk_spin_button_get_value(GTK_SPIN_BUTTON(rangeColors)));
+		sampleBudget = static_cast<int>(gtk_spin_button_get_value(GTK_SPIN_BUTTON(rangeSampleBudget)));
 	}
 	void saveSettings() {
 		options->set("colors", static_cast<int32_t>(numberOfColors));
+		options->set("sample_budget", static_cast<int32_t>(sampleBudget));
 		gchar *currentFolder = gtk_file_chooser_get_current_folder(GTK_FILE_CHOOSER(fileBrowser));
 		if (currentFolder) {
 			options->set("current_folder", currentFolder);
@@ -214,6 +366,26 @@ struct PaletteFromImageArgs {
 		}
 	}
 };
+bool tools_palette_from_image_extract(const std::string &filename, uint32_t numberOfColors, uint32_t sampleBudget, ImagePalette &result) {
+	GdkPixbuf *pixbuf = loadImage(filename);
+	if (!pixbuf)
+		return false;
+	result.totalPixels = static_cast<size_t>(gdk_pixbuf_get_width(pixbuf)) * gdk_pixbuf_get_height(pixbuf);
+	auto octree = std::make_unique<math::OctreeColorQuantization>();
+	if (sampleBudget == 0 || sampleBudget >= result.totalPixels) {
+		std::atomic_bool cancel(false);
+		processAllPixels(pixbuf, *octree, cancel);
+		result.processedPixels = result.totalPixels;
+	} else {
+		result.processedPixels = processSampledPixels(pixbuf, sampleBudget, *octree);
+	}
+	g_object_unref(pixbuf);
+	std::vector<size_t> weights;
+	result.colors.clear();
+	collectColors(*octree, numberOfColors, result.colors, weights);
+	result.weightError = result.processedPixels < result.totalPixels ? estimateWeightError(weights, result.processedPixels) : 0;
+	return true;
+}
 void tools_palette_from_image_show(GtkWindow *parent, GlobalState *gs) {
 	PaletteFromImageArgs *args = new PaletteFromImageArgs;
 	args->previousFilename = "";
@@ -224,7 +396,7 @@ void tools_palette_from_image_show(GtkWindow *parent, GlobalState *gs) {
 		args->options->getInt32("window.height", -1));
 	gtk_dialog_set_alternative_button_order(GTK_DIALOG(dialog), GTK_RESPONSE_APPLY, GTK_RESPONSE_CLOSE, -1);
 
-	Grid grid(2, 3);
+	Grid grid(2, 5);
 	grid.addLabel(_("Image:"));
 	GtkWidget *widget;
 	args->fileBrowser = widget = grid.add(gtk_file_chooser_button_new(_("Image file"), GTK_FILE_CHOOSER_ACTION_OPEN), true);
@@ -274,6 +446,12 @@ void tools_palette_from_image_show(GtkWindow *parent, GlobalState *gs) {
 	args->rangeColors = widget = grid.add(gtk_spin_button_new_with_range(1, 1000, 1), true);
 	gtk_spin_button_set_value(GTK_SPIN_BUTTON(widget), args->options->getInt32("colors", 3));
 	g_signal_connect(G_OBJECT(widget), "value-changed", G_CALLBACK(PaletteFromImageArgs::onUpdate), args);
+	grid.addLabel(_("Sample budget:"));
+	args->rangeSampleBudget = widget = grid.add(gtk_spin_button_new_with_range(0, 100000000, 10000), true);
+	gtk_spin_button_set_value(GTK_SPIN_BUTTON(widget), args->options->getInt32("sample_budget", 0));
+	gtk_widget_set_tooltip_text(widget, _("Maximum number of pixels used for preview. Zero processes all pixels."));
+	g_signal_connect(G_OBJECT(widget), "value-changed", G_CALLBACK(PaletteFromImageArgs::onUpdate), args);
+	args->samplingLabel = grid.add(gtk_label_aligned_new("", 0, 0.5, 0, 0), true, 2);
 	args->previewExpander = grid.add(palette_list_preview_new(*gs, true, args->options->getBool("show_preview", true), args->previewColorList), true, 2, true);
 	gtk_widget_show_all(grid);
 	setDialogContent(dialog, grid);
@@ -18,7 +18,29 @@
 
 #ifndef GPICK_TOOLS_PALETTE_FROM_IMAGE_H_
 #define GPICK_TOOLS_PALETTE_FROM_IMAGE_H_
+#include "Color.h"
 #include <gtk/gtk.h>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
 struct GlobalState;
+struct ImagePalette {
+	std::vector<Color> colors;
+	size_t processedPixels, totalPixels;
+	/**
+	 * Largest estimated standard error of a single color weight, as a fraction of all image pixels. Zero when all pixels were processed.
+	 */
+	float weightError;
+};
 void tools_palette_from_image_show(GtkWindow* parent, GlobalState* gs);
+/**
+ * Extract palette from image file.
+ * @param[in] filename Image file name.
+ * @param[in] numberOfColors Maximum number of colors in resulting palette.
+ * @param[in] sampleBudget Maximum number of pixels to process using stratified sampling. Zero processes all pixels.
+ * @param[out] result Extracted palette.
+ * @return True on success.
+ */
+bool tools_palette_from_image_extract(const std::string &filename, uint32_t numberOfColors, uint32_t sampleBudget, ImagePalette &result);
 #endif /* GPICK_TOOLS_PALETTE_FROM_IMAGE_H_ */
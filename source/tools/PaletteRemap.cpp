@@ -0,0 +1,313 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "PaletteRemap.h"
+#include "ColorList.h"
+#include "ColorObject.h"
+#include "uiUtilities.h"
+#include "uiListPalette.h"
+#include "GlobalState.h"
+#include "I18N.h"
+#include "dynv/Map.h"
+#include "math/PaletteLookup.h"
+#include "math/PaletteRemapper.h"
+#include "common/Match.h"
+#include "common/Format.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+namespace {
+using Dithering = math::PaletteRemapper::Dithering;
+struct DitheringDescription {
+	const char *id;
+	const char *name;
+	Dithering dithering;
+};
+const DitheringDescription ditheringTypes[] = {
+	{ "none", N_("None"), Dithering::none },
+	{ "floyd_steinberg", N_("Floyd-Steinberg"), Dithering::floydSteinberg },
+	{ "ordered", N_("Ordered"), Dithering::ordered },
+};
+const int previewWidth = 400, previewHeight = 300;
+struct PaletteRemapArgs {
+	GtkWidget *dialog, *fileBrowser, *sourceComboBox, *ditheringComboBox, *previewImage, *statusLabel;
+	GtkWidget *paletteWidget;
+	std::string filename, loadedFilename;
+	GdkPixbuf *image, *previewSource;
+	std::vector<Color> colors;
+	math::PaletteLookup lookup;
+	dynv::Ref options;
+	GlobalState *gs;
+	PaletteRemapArgs():
+		image(nullptr),
+		previewSource(nullptr) {
+	}
+	~PaletteRemapArgs() {
+		if (image)
+			g_object_unref(image);
+		if (previewSource)
+			g_object_unref(previewSource);
+	}
+	bool useSelection() const {
+		return gtk_combo_box_get_active(GTK_COMBO_BOX(sourceComboBox)) == 1;
+	}
+	const DitheringDescription &dithering() const {
+		int index = gtk_combo_box_get_active(GTK_COMBO_BOX(ditheringComboBox));
+		if (index < 0 || index >= static_cast<int>(sizeof(ditheringTypes) / sizeof(ditheringTypes[0])))
+			return ditheringTypes[0];
+		return ditheringTypes[index];
+	}
+	void updatePalette() {
+		std::vector<Color> newColors;
+		if (useSelection()) {
+			ColorList colorList;
+			palette_list_get_selected(paletteWidget, colorList);
+			for (auto *colorObject: colorList)
+				newColors.push_back(colorObject->getColor());
+		} else {
+			for (auto *colorObject: gs->colorList())
+				newColors.push_back(colorObject->getColor());
+		}
+		if (newColors == colors && !lookup.empty())
+			return;
+		colors = std::move(newColors);
+		lookup.build(colors);
+	}
+	bool loadImage() {
+		if (loadedFilename == filename && image)
+			return true;
+		if (image)
+			g_object_unref(image);
+		if (previewSource)
+			g_object_unref(previewSource);
+		image = previewSource = nullptr;
+		loadedFilename = filename;
+		if (filename.empty())
+			return false;
+		GError *error = nullptr;
+		GdkPixbuf *pixbuf = gdk_pixbuf_new_from_file(filename.c_str(), &error);
+		if (error) {
+			std::cerr << error->message << '\n';
+			g_error_free(error);
+			return false;
+		}
+		if (gdk_pixbuf_get_n_channels(pixbuf) < 3 || gdk_pixbuf_get_bits_per_sample(pixbuf) != 8) {
+			g_object_unref(pixbuf);
+			return false;
+		}
+		image = pixbuf;
+		int width = gdk_pixbuf_get_width(image), height = gdk_pixbuf_get_height(image);
+		double scale = std::min(1.0, std::min(static_cast<double>(previewWidth) / width, static_cast<double>(previewHeight) / height));
+		previewSource = gdk_pixbuf_scale_simple(image, std::max(1, static_cast<int>(width * scale)), std::max(1, static_cast<int>(height * scale)), GDK_INTERP_BILINEAR);
+		return true;
+	}
+	static math::PaletteRemapper::Image toImage(GdkPixbuf *pixbuf) {
+		return { gdk_pixbuf_get_pixels(pixbuf), gdk_pixbuf_get_width(pixbuf), gdk_pixbuf_get_height(pixbuf), gdk_pixbuf_get_rowstride(pixbuf), gdk_pixbuf_get_n_channels(pixbuf) };
+	}
+	GdkPixbuf *remap(GdkPixbuf *source, std::vector<uint32_t> *indexes) {
+		GdkPixbuf *result = gdk_pixbuf_new(GDK_COLORSPACE_RGB, gdk_pixbuf_get_has_alpha(source), 8, gdk_pixbuf_get_width(source), gdk_pixbuf_get_height(source));
+		if (indexes)
+			indexes->resize(static_cast<size_t>(gdk_pixbuf_get_width(source)) * gdk_pixbuf_get_height(source));
+		math::PaletteRemapper(lookup, dithering().dithering).remap(toImage(source), toImage(result), indexes ? indexes->data() : nullptr);
+		return result;
+	}
+	void update() {
+		getSettings();
+		updatePalette();
+		if (!loadImage() || lookup.empty()) {
+			gtk_image_clear(GTK_IMAGE(previewImage));
+			gtk_label_set_text(GTK_LABEL(statusLabel), lookup.empty() ? _("Palette is empty") : "");
+			gtk_dialog_set_response_sensitive(GTK_DIALOG(dialog), GTK_RESPONSE_APPLY, false);
+			return;
+		}
+		GdkPixbuf *preview = remap(previewSource, nullptr);
+		gtk_image_set_from_pixbuf(GTK_IMAGE(previewImage), preview);
+		g_object_unref(preview);
+		auto status = common::format(_("{}x{} pixels, {} colors"), gdk_pixbuf_get_width(image), gdk_pixbuf_get_height(image), lookup.size());
+		gtk_label_set_text(GTK_LABEL(statusLabel), status.c_str());
+		gtk_dialog_set_response_sensitive(GTK_DIALOG(dialog), GTK_RESPONSE_APPLY, true);
+	}
+	bool saveIndexed(const std::string &outputFilename, const std::vector<uint32_t> &indexes) {
+		if (lookup.size() > (1 << 16))
+			return false;
+		std::ofstream file(outputFilename, std::ios::out | std::ios::trunc | std::ios::binary);
+		if (!file.is_open())
+			return false;
+		uint32_t maxValue = std::max<uint32_t>(static_cast<uint32_t>(lookup.size() - 1), 1);
+		file << "P5\n" << gdk_pixbuf_get_width(image) << ' ' << gdk_pixbuf_get_height(image) << '\n' << maxValue << '\n';
+		std::vector<char> buffer;
+		buffer.reserve(indexes.size() * (maxValue > 255 ? 2 : 1));
+		for (auto index: indexes) {
+			if (maxValue > 255)
+				buffer.push_back(static_cast<char>(index >> 8));
+			buffer.push_back(static_cast<char>(index & 0xff));
+		}
+		file.write(buffer.data(), buffer.size());
+		return file.good();
+	}
+	bool save(const std::string &outputFilename) {
+		bool indexed = g_str_has_suffix(outputFilename.c_str(), ".pgm");
+		std::vector<uint32_t> indexes;
+		GdkPixbuf *result = remap(image, indexed ? &indexes : nullptr);
+		bool success;
+		if (indexed) {
+			success = saveIndexed(outputFilename, indexes);
+		} else {
+			GError *error = nullptr;
+			success = gdk_pixbuf_save(result, outputFilename.c_str(), "png", &error, nullptr);
+			if (error) {
+				std::cerr << error->message << '\n';
+				g_error_free(error);
+			}
+		}
+		g_object_unref(result);
+		return success;
+	}
+	void showSaveDialog() {
+		GtkWidget *saveDialog = gtk_file_chooser_dialog_new(_("Save remapped image"), GTK_WINDOW(dialog), GTK_FILE_CHOOSER_ACTION_SAVE, GTK_STOCK_CANCEL, GTK_RESPONSE_CANCEL, GTK_STOCK_SAVE, GTK_RESPONSE_OK, nullptr);
+		gtk_dialog_set_alternative_button_order(GTK_DIALOG(saveDialog), GTK_RESPONSE_OK, GTK_RESPONSE_CANCEL, -1);
+		gtk_file_chooser_set_do_overwrite_confirmation(GTK_FILE_CHOOSER(saveDialog), true);
+		gtk_file_chooser_set_current_folder(GTK_FILE_CHOOSER(saveDialog), options->getString("save_folder", "").c_str());
+		GtkFileFilter *filter = gtk_file_filter_new();
+		gtk_file_filter_set_name(filter, _("PNG image (*.png)"));
+		gtk_file_filter_add_pattern(filter, "*.png");
+		gtk_file_chooser_add_filter(GTK_FILE_CHOOSER(saveDialog), filter);
+		filter = gtk_file_filter_new();
+		gtk_file_filter_set_name(filter, _("Indexed image (*.pgm)"));
+		gtk_file_filter_add_pattern(filter, "*.pgm");
+		gtk_file_chooser_add_filter(GTK_FILE_CHOOSER(saveDialog), filter);
+		bool finished = false;
+		while (!finished) {
+			if (gtk_dialog_run(GTK_DIALOG(saveDialog)) != GTK_RESPONSE_OK)
+				break;
+			gchar *outputFilename = gtk_file_chooser_get_filename(GTK_FILE_CHOOSER(saveDialog));
+			gchar *path = gtk_file_chooser_get_current_folder(GTK_FILE_CHOOSER(saveDialog));
+			if (path) {
+				options->set("save_folder", path);
+				g_free(path);
+			}
+			if (outputFilename && save(outputFilename)) {
+				finished = true;
+			} else {
+				GtkWidget *message = gtk_message_dialog_new(GTK_WINDOW(saveDialog), GTK_DIALOG_MODAL, GTK_MESSAGE_ERROR, GTK_BUTTONS_OK, _("File could not be saved"));
+				gtk_dialog_run(GTK_DIALOG(message));
+				gtk_widget_destroy(message);
+			}
+			g_free(outputFilename);
+		}
+		gtk_widget_destroy(saveDialog);
+	}
+	void getSettings() {
+		gchar *filename = gtk_file_chooser_get_filename(GTK_FILE_CHOOSER(fileBrowser));
+		if (filename) {
+			this->filename = filename;
+			g_free(filename);
+		} else {
+			this->filename.clear();
+		}
+	}
+	void saveSettings() {
+		options->set("dithering", dithering().id);
+		options->set<bool>("selected_colors", useSelection());
+		gchar *currentFolder = gtk_file_chooser_get_current_folder(GTK_FILE_CHOOSER(fileBrowser));
+		if (currentFolder) {
+			options->set("current_folder", currentFolder);
+			g_free(currentFolder);
+		}
+	}
+	static void onUpdate(GtkWidget *widget, PaletteRemapArgs *args) {
+		args->update();
+	}
+	static void onDestroy(GtkWidget *widget, PaletteRemapArgs *args) {
+		delete args;
+	}
+	static void onResponse(GtkWidget *widget, gint responseId, PaletteRemapArgs *args) {
+		args->getSettings();
+		args->saveSettings();
+		gint width, height;
+		gtk_window_get_size(GTK_WINDOW(widget), &width, &height);
+		args->options->set("window.width", width);
+		args->options->set("window.height", height);
+		switch (responseId) {
+		case GTK_RESPONSE_APPLY:
+			args->update();
+			if (args->image && !args->lookup.empty())
+				args->showSaveDialog();
+			break;
+		case GTK_RESPONSE_DELETE_EVENT:
+			break;
+		case GTK_RESPONSE_CLOSE:
+			gtk_widget_destroy(widget);
+			break;
+		}
+	}
+};
+}
+void tools_palette_remap_show(GtkWindow *parent, GtkWidget *paletteWidget, GlobalState &gs) {
+	PaletteRemapArgs *args = new PaletteRemapArgs;
+	args->gs = &gs;
+	args->paletteWidget = paletteWidget;
+	args->options = gs.settings().getOrCreateMap("gpick.tools.palette_remap");
+	GtkWidget *dialog = args->dialog = gtk_dialog_new_with_buttons(_("Remap image to palette"), parent, GtkDialogFlags(GTK_DIALOG_DESTROY_WITH_PARENT), GTK_STOCK_CLOSE, GTK_RESPONSE_CLOSE, GTK_STOCK_SAVE_AS, GTK_RESPONSE_APPLY, nullptr);
+	gtk_window_set_default_size(GTK_WINDOW(dialog), args->options->getInt32("window.width", -1), args->options->getInt32("window.height", -1));
+	gtk_dialog_set_alternative_button_order(GTK_DIALOG(dialog), GTK_RESPONSE_APPLY, GTK_RESPONSE_CLOSE, -1);
+
+	Grid grid(2, 6);
+	GtkWidget *widget;
+	grid.addLabel(_("Image:"));
+	args->fileBrowser = widget = grid.add(gtk_file_chooser_button_new(_("Image file"), GTK_FILE_CHOOSER_ACTION_OPEN), true);
+	gtk_file_chooser_set_current_folder(GTK_FILE_CHOOSER(widget), args->options->getString("current_folder", "").c_str());
+	GtkFileFilter *filter = gtk_file_filter_new();
+	gtk_file_filter_set_name(filter, _("All images"));
+	gtk_file_filter_add_pixbuf_formats(filter);
+	gtk_file_chooser_add_filter(GTK_FILE_CHOOSER(widget), filter);
+	filter = gtk_file_filter_new();
+	gtk_file_filter_set_name(filter, _("All files"));
+	gtk_file_filter_add_pattern(filter, "*");
+	gtk_file_chooser_add_filter(GTK_FILE_CHOOSER(widget), filter);
+	g_signal_connect(G_OBJECT(widget), "file-set", G_CALLBACK(PaletteRemapArgs::onUpdate), args);
+
+	grid.addLabel(_("Colors:"));
+	args->sourceComboBox = widget = grid.add(gtk_combo_box_text_new(), true);
+	gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(widget), _("All colors"));
+	gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(widget), _("Selected colors"));
+	gtk_combo_box_set_active(GTK_COMBO_BOX(widget), args->options->getBool("selected_colors", false) ? 1 : 0);
+	g_signal_connect(G_OBJECT(widget), "changed", G_CALLBACK(PaletteRemapArgs::onUpdate), args);
+
+	grid.addLabel(_("Dithering:"));
+	args->ditheringComboBox = widget = grid.add(gtk_combo_box_text_new(), true);
+	const auto &selectedDithering = common::matchById(ditheringTypes, args->options->getString("dithering", "floyd_steinberg"));
+	for (const auto &dithering: ditheringTypes) {
+		gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(widget), _(dithering.name));
+		if (&dithering == &selectedDithering)
+			gtk_combo_box_set_active(GTK_COMBO_BOX(widget), &dithering - ditheringTypes);
+	}
+	g_signal_connect(G_OBJECT(widget), "changed", G_CALLBACK(PaletteRemapArgs::onUpdate), args);
+
+	args->previewImage = grid.add(gtk_image_new(), true, 2, true);
+	gtk_widget_set_size_request(args->previewImage, previewWidth, previewHeight);
+	args->statusLabel = grid.add(gtk_label_aligned_new("", 0, 0.5, 0, 0), true, 2);
+	gtk_widget_show_all(grid);
+	setDialogContent(dialog, grid);
+	gtk_dialog_set_response_sensitive(GTK_DIALOG(dialog), GTK_RESPONSE_APPLY, false);
+	g_signal_connect(G_OBJECT(dialog), "destroy", G_CALLBACK(PaletteRemapArgs::onDestroy), args);
+	g_signal_connect(G_OBJECT(dialog), "response", G_CALLBACK(PaletteRemapArgs::onResponse), args);
+	gtk_widget_show(dialog);
+}
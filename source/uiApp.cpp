@@ -30,6 +30,7 @@
 #include "RegisterSources.h"
 #include "GenerateScheme.h"
 #include "ColorPicker.h"
+#include "Sampler.h"
 #include "LayoutPreview.h"
 #include "ImportExport.h"
 #include "uiAbout.h"
@@ -47,15 +48,18 @@
 #include "uiColorDictionaries.h"
 #include "uiTransformations.h"
 #include "uiDialogOptions.h"
+#include "uiDialogDiagnostics.h"
 #include "uiConverter.h"
 #include "uiStatusIcon.h"
 #include "uiColorInput.h"
 #include "tools/PaletteFromImage.h"
+#include "tools/PaletteRemap.h"
 #include "tools/ColorSpaceSampler.h"
 #include "tools/TextParser.h"
 #include "tools/BackgroundColorPicker.h"
 #include "dbus/Control.h"
 #include "dynv/Map.h"
+#include "lua/Script.h"
 #include "common/Guard.h"
 #include "FileFormat.h"
 #include "Clipboard.h"
@@ -73,6 +77,7 @@
 #include <iostream>
 #include <filesystem>
 #include <unordered_set>
+#include <chrono>
 using namespace std;
 
 struct AppArgs
@@ -307,6 +312,11 @@ static void show_dialog_color_dictionaries(GtkWidget *widget, AppArgs *args)
 	return;
 }
 
+static void show_dialog_diagnostics(GtkWidget *widget, AppArgs *args)
+{
+	dialog_diagnostics_show(GTK_WINDOW(args->window), *args->gs);
+}
+
 static void menu_file_new(GtkWidget *widget, AppArgs *args)
 {
 	args->current_filename_set = false;
@@ -659,6 +669,11 @@ static void floating_picker_show_cb(GtkWidget *widget, AppArgs* args)
 	floating_picker_activate(args->floatingPicker, false, false, nullptr);
 }
 
+static void floating_picker_region_cb(GtkWidget *widget, AppArgs* args)
+{
+	floating_picker_activate_region(args->floatingPicker);
+}
+
 static void show_about_box_cb(GtkWidget *widget, AppArgs* args)
 {
 	show_about_box(args->window);
@@ -819,6 +834,10 @@ static void palette_from_image_cb(GtkWidget *widget, AppArgs* args)
 {
 	tools_palette_from_image_show(GTK_WINDOW(args->window), args->gs);
 }
+static void palette_remap_cb(GtkWidget *widget, AppArgs* args)
+{
+	tools_palette_remap_show(GTK_WINDOW(args->window), args->paletteWidget, *args->gs);
+}
 static void color_space_sampler_cb(GtkWidget *widget, AppArgs* args)
 {
 	tools_color_space_sampler_show(GTK_WINDOW(args->window), args->gs);
@@ -1091,10 +1110,16 @@ static void create_menu(GtkMenuBar *menu_bar, AppArgs *args, GtkAccelGroup *acce
 	gtk_menu_shell_append(GTK_MENU_SHELL(menu), item);
 	gtk_widget_add_accelerator(item, "activate", accel_group, GDK_KEY_p, GdkModifierType(GDK_CONTROL_MASK), GTK_ACCEL_VISIBLE);
 	g_signal_connect(G_OBJECT(item), "activate", G_CALLBACK(floating_picker_show_cb), args);
+	item = gtk_menu_item_new_with_mnemonic(_("Pick _region..."));
+	gtk_menu_shell_append(GTK_MENU_SHELL(menu), item);
+	g_signal_connect(G_OBJECT(item), "activate", G_CALLBACK(floating_picker_region_cb), args);
 	gtk_menu_shell_append(GTK_MENU_SHELL(menu), gtk_separator_menu_item_new());
 	item = gtk_menu_item_new_with_mnemonic(_("Palette From _Image..."));
 	gtk_menu_shell_append(GTK_MENU_SHELL(menu), item);
 	g_signal_connect(G_OBJECT(item), "activate", G_CALLBACK(palette_from_image_cb), args);
+	item = gtk_menu_item_new_with_mnemonic(_("_Remap Image to Palette..."));
+	gtk_menu_shell_append(GTK_MENU_SHELL(menu), item);
+	g_signal_connect(G_OBJECT(item), "activate", G_CALLBACK(palette_remap_cb), args);
 	item = gtk_menu_item_new_with_mnemonic(_("Color Space _Sampler..."));
 	gtk_menu_shell_append(GTK_MENU_SHELL(menu), item);
 	g_signal_connect(G_OBJECT(item), "activate", G_CALLBACK(color_space_sampler_cb), args);
@@ -1108,6 +1133,9 @@ static void create_menu(GtkMenuBar *menu_bar, AppArgs *args, GtkAccelGroup *acce
 	gtk_menu_item_set_submenu(GTK_MENU_ITEM(file_item), GTK_WIDGET(menu));
 	gtk_menu_shell_append(GTK_MENU_SHELL(menu_bar), file_item);
 	menu = GTK_MENU(gtk_menu_new());
+	item = gtk_menu_item_new_with_mnemonic(_("_Diagnostics..."));
+	gtk_menu_shell_append(GTK_MENU_SHELL(menu), item);
+	g_signal_connect(G_OBJECT(item), "activate", G_CALLBACK(show_dialog_diagnostics), args);
 	if (gtk_stock_lookup(GTK_STOCK_ABOUT, &stock_item)){
 		item = newMenuItem(stock_item.label, stock_item.stock_id);
 		gtk_menu_shell_append (GTK_MENU_SHELL (menu), item);
@@ -1502,6 +1530,16 @@ bool app_is_autoload_enabled(AppArgs *args)
 	return args->options->getBool("main.save_restore_palette", true);
 }
 
+static void app_print_startup_timing(AppArgs *args, std::chrono::steady_clock::duration duration)
+{
+	using namespace std::chrono;
+	const auto &statistics = args->gs->script().loadStatistics();
+	auto milliseconds = [](microseconds value) {
+		return value.count() / 1000.0;
+	};
+	std::cerr << "startup: " << milliseconds(duration_cast<microseconds>(duration)) << " ms" << '\n';
+	std::cerr << "lua: " << statistics.cached << " modules from bytecode cache, " << statistics.compiled << " compiled, " << milliseconds(statistics.loadTime) << " ms loading, " << milliseconds(statistics.savedTime) << " ms saved by cache" << '\n';
+}
 static void app_initialize_variables(AppArgs *args)
 {
 	args->current_filename_set = false;
@@ -1510,8 +1548,11 @@ static void app_initialize_variables(AppArgs *args)
 	args->current_color_source = nullptr;
 	args->secondary_source_widget = 0;
 	args->secondary_source_scrolled_viewpoint = 0;
+	auto start = std::chrono::steady_clock::now();
 	args->gs->loadAll();
 	dialog_options_update(args->gs);
+	if (args->startupOptions.startup_timing)
+		app_print_startup_timing(args, std::chrono::steady_clock::now() - start);
 	args->options = args->gs->settings().getOrCreateMap("gpick.main");
 	registerSources(args->csm);
 }
@@ -1848,3 +1889,123 @@ int app_run(AppArgs *args)
 	delete args;
 	return 0;
 }
+int app_palette_from_image(const StartupOptions &startupOptions)
+{
+	Color::initialize();
+	GlobalState gs;
+	gs.loadSettings();
+	gs.loadAll();
+	ImagePalette palette;
+	if (!tools_palette_from_image_extract(startupOptions.palette_from_image, startupOptions.palette_colors, startupOptions.sample_budget, palette))
+		return 1;
+	auto converter = gs.converters().byNameOrFirstCopy(startupOptions.converter_name.c_str());
+	if (converter == nullptr)
+		return 1;
+	for (const auto &color: palette.colors) {
+		cout << converter->serialize(color) << '\n';
+	}
+	if (palette.processedPixels < palette.totalPixels)
+		cerr << "processed " << palette.processedPixels << " of " << palette.totalPixels << " pixels, color weight error " << palette.weightError * 100 << "%\n";
+	return 0;
+}
+// Parse "X,Y" or "X,Y,R" sample position. Spaces can be used instead of commas.
+static bool parse_sample_position(const std::string &text, math::Vector2i &position, int &radius)
+{
+	long values[3];
+	int count = 0;
+	const char *p = text.c_str();
+	for (;;){
+		while (*p == ' ' || *p == '\t' || *p == '\r')
+			p++;
+		if (!*p)
+			break;
+		if (count == 3)
+			return false;
+		char *end;
+		values[count] = strtol(p, &end, 10);
+		if (end == p)
+			return false;
+		count++;
+		p = end;
+		while (*p == ' ' || *p == '\t' || *p == '\r')
+			p++;
+		if (*p == ',')
+			p++;
+	}
+	if (count < 2 || (count == 3 && (values[2] < 0 || values[2] > sampler_max_oversample)))
+		return false;
+	position = math::Vector2i(static_cast<int>(values[0]), static_cast<int>(values[1]));
+	if (count == 3)
+		radius = static_cast<int>(values[2]);
+	return true;
+}
+int app_sample_image(const StartupOptions &startupOptions)
+{
+	Color::initialize();
+	GlobalState gs;
+	gs.loadSettings();
+	gs.loadAll();
+	auto converter = gs.converters().byNameOrFirstCopy(startupOptions.converter_name.c_str());
+	if (converter == nullptr)
+		return 1;
+	GError *error = nullptr;
+	GdkPixbuf *pixbuf = gdk_pixbuf_new_from_file(startupOptions.sample_image.c_str(), &error);
+	if (error){
+		cerr << error->message << '\n';
+		g_error_free(error);
+		return 1;
+	}
+	// Convert to 32-bit native endian xRGB pixels used by sampler.
+	int width = gdk_pixbuf_get_width(pixbuf), height = gdk_pixbuf_get_height(pixbuf);
+	int channels = gdk_pixbuf_get_n_channels(pixbuf), stride = gdk_pixbuf_get_rowstride(pixbuf);
+	const guchar *pixels = gdk_pixbuf_get_pixels(pixbuf);
+	std::vector<uint32_t> image(static_cast<size_t>(width) * height);
+	for (int y = 0; y < height; y++){
+		const guchar *p = pixels + static_cast<size_t>(y) * stride;
+		for (int x = 0; x < width; x++, p += channels)
+			image[x + static_cast<size_t>(y) * width] = (static_cast<uint32_t>(p[0]) << 16) | (static_cast<uint32_t>(p[1]) << 8) | p[2];
+	}
+	g_object_unref(pixbuf);
+	auto options = gs.settings().getOrCreateMap("gpick.picker");
+	Sampler *sampler = sampler_new(nullptr);
+	sampler_set_falloff(sampler, static_cast<SamplerFalloff>(options->getInt32("sampler.falloff", static_cast<int>(SamplerFalloff::none))));
+	sampler_set_linear_light(sampler, options->getBool("sampler.linear_light", false));
+	int defaultRadius = options->getInt32("sampler.oversample", 0);
+	math::Rectangle<int> imageRect(0, 0, width, height);
+	auto sample = [&](const std::string &text) {
+		math::Vector2i position;
+		int radius = defaultRadius;
+		if (!parse_sample_position(text, position, radius)){
+			cerr << "invalid sample position \"" << text << "\", expected X,Y or X,Y,R with R from 0 to " << sampler_max_oversample << "\n";
+			return false;
+		}
+		if (position.x < 0 || position.y < 0 || position.x >= width || position.y >= height){
+			cerr << "sample position " << position.x << "," << position.y << " is outside of " << width << "x" << height << " image\n";
+			return false;
+		}
+		sampler_set_oversample(sampler, radius);
+		math::Rectangle<int> sampleRect;
+		sampler_get_screen_rect(sampler, position, imageRect, &sampleRect);
+		math::Vector2i offset = sampleRect.position();
+		Color color;
+		sampler_get_color_sample_from_data(sampler, reinterpret_cast<const unsigned char *>(image.data()), width * 4, position, imageRect, offset, &color);
+		cout << converter->serialize(color) << '\n';
+		return true;
+	};
+	int result = 0;
+	if (!startupOptions.sample_position.empty()){
+		if (!sample(startupOptions.sample_position))
+			result = 1;
+	}else{
+		// Batch mode: one position per line. Output stays aligned with input, invalid positions produce empty lines.
+		std::string line;
+		while (std::getline(cin, line)){
+			if (!sample(line)){
+				cout << '\n';
+				result = 1;
+			}
+		}
+	}
+	sampler_destroy(sampler);
+	return result;
+}
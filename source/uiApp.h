@@ -20,6 +20,7 @@
 #define GPICK_UI_APP_H_
 #include "dynv/Map.h"
 #include <string>
+#include <cstdint>
 #include <gtk/gtk.h>
 struct GlobalState;
 struct ColorObject;
@@ -34,6 +35,12 @@ struct StartupOptions {
 	bool output_without_newline;
 	bool single_color_pick_mode;
 	bool do_not_start;
+	bool startup_timing;
+	std::string palette_from_image;
+	uint32_t palette_colors;
+	uint32_t sample_budget;
+	std::string sample_image;
+	std::string sample_position;
 };
 void app_initialize();
 AppArgs* app_create_main(const StartupOptions &options, int &return_value);
@@ -41,4 +48,9 @@ int app_load_file(AppArgs *args, const std::string &filename, bool autoload = fa
 int app_run(AppArgs *args);
 int app_parse_geometry(AppArgs *args, const char *geometry);
 bool app_is_autoload_enabled(AppArgs *args);
+int app_palette_from_image(const StartupOptions &options);
+/**
+ * Print colors sampled from image file at position given in options, or at positions read from standard input.
+ */
+int app_sample_image(const StartupOptions &options);
 #endif /* GPICK_UI_APP_H_ */
@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2009-2022, Albertas Vyšniauskas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the software author nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "uiDialogDiagnostics.h"
+#include "uiDialogBase.h"
+#include "uiUtilities.h"
+#include "GlobalState.h"
+#include "Converters.h"
+#include "Converter.h"
+#include "Clipboard.h"
+#include "I18N.h"
+#include "layout/Layouts.h"
+#include "layout/Layout.h"
+#include "lua/Callbacks.h"
+#include "common/CallStatistics.h"
+#include "common/NumberFormat.h"
+#include <vector>
+#include <string>
+#include <algorithm>
+namespace {
+enum struct Column : int {
+	kind = 0,
+	name,
+	calls,
+	errors,
+	total,
+	max,
+	nColumns
+};
+std::vector<common::NamedCallStatistics> collectStatistics(GlobalState &gs) {
+	std::vector<common::NamedCallStatistics> result;
+	auto add = [&result](const char *kind, const std::string &name, const common::CallStatistics &statistics) {
+		if (statistics.calls() == 0)
+			return;
+		result.push_back({ kind, name, statistics });
+	};
+	for (auto *converter: gs.converters().all()) {
+		add("serialize", converter->name(), converter->serializeCalls());
+		add("deserialize", converter->name(), converter->deserializeCalls());
+	}
+	add("callback", "componentToText", gs.callbacks().componentToTextCalls());
+	add("callback", "optionChange", gs.callbacks().optionChangeCalls());
+	for (auto *layout: gs.layouts().all())
+		add("layout", layout->name(), layout->buildCalls());
+	std::stable_sort(result.begin(), result.end(), [](const common::NamedCallStatistics &a, const common::NamedCallStatistics &b) {
+		return a.statistics.total() > b.statistics.total();
+	});
+	return result;
+}
+void resetStatistics(GlobalState &gs) {
+	for (auto *converter: gs.converters().all())
+		converter->resetStatistics();
+	gs.callbacks().resetStatistics();
+	for (auto *layout: gs.layouts().all())
+		layout->resetStatistics();
+}
+std::string toMilliseconds(common::CallStatistics::Duration duration) {
+	return common::toFixed(std::chrono::duration<float, std::milli>(duration).count(), 3);
+}
+struct DiagnosticsDialog: public DialogBase {
+	GtkWidget *statisticsList;
+	DiagnosticsDialog(GlobalState &gs, GtkWindow *parent):
+		DialogBase(gs, "gpick.diagnostics", _("Diagnostics"), parent) {
+		Grid grid(2, 2);
+		statisticsList = newList();
+		GtkWidget *scrolled = gtk_scrolled_window_new(0, 0);
+		gtk_container_add(GTK_CONTAINER(scrolled), statisticsList);
+		gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(scrolled), GTK_POLICY_AUTOMATIC, GTK_POLICY_AUTOMATIC);
+		grid.add(scrolled, true, 2, true);
+		GtkWidget *button = gtk_button_new_with_mnemonic(_("_Reset"));
+		g_signal_connect(G_OBJECT(button), "clicked", G_CALLBACK(onReset), this);
+		grid.add(button);
+		button = gtk_button_new_with_mnemonic(_("_Copy as JSON"));
+		g_signal_connect(G_OBJECT(button), "clicked", G_CALLBACK(onCopy), this);
+		grid.add(button);
+		update();
+		setContent(grid);
+	}
+	virtual void apply(bool) override {
+	}
+	GtkWidget *newList() {
+		GtkWidget *view = gtk_tree_view_new();
+		gtk_tree_view_set_headers_visible(GTK_TREE_VIEW(view), true);
+		GtkListStore *store = gtk_list_store_new(static_cast<int>(Column::nColumns), G_TYPE_STRING, G_TYPE_STRING, G_TYPE_STRING, G_TYPE_STRING, G_TYPE_STRING, G_TYPE_STRING);
+		const char *titles[] = {
+			_("Type"),
+			_("Name"),
+			_("Calls"),
+			_("Errors"),
+			_("Total, ms"),
+			_("Maximum, ms"),
+		};
+		for (int i = 0; i < static_cast<int>(Column::nColumns); i++) {
+			GtkTreeViewColumn *col = gtk_tree_view_column_new();
+			gtk_tree_view_column_set_sizing(col, GTK_TREE_VIEW_COLUMN_AUTOSIZE);
+			gtk_tree_view_column_set_resizable(col, true);
+			gtk_tree_view_column_set_title(col, titles[i]);
+			GtkCellRenderer *renderer = gtk_cell_renderer_text_new();
+			if (i >= static_cast<int>(Column::calls))
+				g_object_set(renderer, "xalign", 1.0f, nullptr);
+			gtk_tree_view_column_pack_start(col, renderer, true);
+			gtk_tree_view_append_column(GTK_TREE_VIEW(view), col);
+			gtk_tree_view_column_add_attribute(col, renderer, "text", i);
+		}
+		gtk_tree_view_set_model(GTK_TREE_VIEW(view), GTK_TREE_MODEL(store));
+		g_object_unref(GTK_TREE_MODEL(store));
+		return view;
+	}
+	void update() {
+		GtkListStore *store = GTK_LIST_STORE(gtk_tree_view_get_model(GTK_TREE_VIEW(statisticsList)));
+		gtk_list_store_clear(store);
+		for (const auto &entry: collectStatistics(gs)) {
+			GtkTreeIter iter;
+			gtk_list_store_append(store, &iter);
+			gtk_list_store_set(store, &iter,
+				Column::kind, entry.kind.c_str(),
+				Column::name, entry.name.c_str(),
+				Column::calls, std::to_string(entry.statistics.calls()).c_str(),
+				Column::errors, std::to_string(entry.statistics.errors()).c_str(),
+				Column::total, toMilliseconds(entry.statistics.total()).c_str(),
+				Column::max, toMilliseconds(entry.statistics.max()).c_str(),
+				-1);
+		}
+	}
+	static void onReset(GtkWidget *, DiagnosticsDialog *args) {
+		resetStatistics(args->gs);
+		args->update();
+	}
+	static void onCopy(GtkWidget *, DiagnosticsDialog *args) {
+		clipboard::set(common::toJson(collectStatistics(args->gs)));
+	}
+};
+}
+void dialog_diagnostics_show(GtkWindow *parent, GlobalState &gs) {
+	DiagnosticsDialog(gs, parent).run();
+}
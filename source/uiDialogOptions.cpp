@@ -48,6 +48,7 @@ typedef struct DialogOptionsArgs{
 	GtkWidget *close_to_tray;
 	GtkWidget *start_in_tray;
 	GtkWidget *refresh_rate;
+	GtkWidget *max_staleness;
 	GtkWidget *single_instance;
 	GtkWidget *default_drag_action[2];
 	GtkWidget *hex_case[2];
@@ -77,6 +78,7 @@ typedef struct DialogOptionsArgs{
 bool dialog_options_update(GlobalState *gs) {
 	if (!gs->callbacks().optionChange().valid())
 		return false;
+	common::CallTimer timer(gs->callbacks().optionChangeCalls());
 	lua_State* L = gs->script();
 	int stack_top = lua_gettop(L);
 	gs->callbacks().optionChange().get();
@@ -88,6 +90,7 @@ bool dialog_options_update(GlobalState *gs) {
 	}else{
 		cerr << "optionsUpdate: " << lua_tostring(L, -1) << endl;
 	}
+	timer.error();
 	lua_settop(L, stack_top);
 	return false;
 }
@@ -112,6 +115,7 @@ static void calc( DialogOptionsArgs *args, bool preview, int limit)
 	options->set<bool>("options.css_percentages", gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(args->css_percentages)));
 	options->set<bool>("options.css_alpha_percentage", gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(args->css_alpha_percentage)));
 	options->set<int32_t>("picker.refresh_rate", static_cast<int32_t>(gtk_spin_button_get_value(GTK_SPIN_BUTTON(args->refresh_rate))));
+	options->set<int32_t>("picker.max_staleness", static_cast<int32_t>(gtk_spin_button_get_value(GTK_SPIN_BUTTON(args->max_staleness))));
 	options->set<int32_t>("picker.zoom_size", static_cast<int32_t>(gtk_spin_button_get_value(GTK_SPIN_BUTTON(args->zoom_size))));
 	options->set<bool>("picker.always_use_floating_picker", gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(args->always_use_floating_picker)));
 	options->set<bool>("picker.hide_cursor", gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(args->hide_cursor)));
@@ -262,6 +266,12 @@ void dialog_options_show(GtkWindow* parent, GlobalState* gs)
 	gtk_table_attach(GTK_TABLE(table), widget,1,2,table_y,table_y+1,GtkAttachOptions(GTK_FILL | GTK_EXPAND),GTK_FILL,5,5);
 	gtk_table_attach(GTK_TABLE(table), gtk_label_aligned_new("Hz",0,0.5,0,0),2,3,table_y,table_y+1,GTK_FILL,GTK_FILL,5,5);
 	table_y++;
+	gtk_table_attach(GTK_TABLE(table), gtk_label_mnemonic_aligned_new(_("Maximum _capture age:"),0,0.5,0,0),0,1,table_y,table_y+1,GtkAttachOptions(GTK_FILL | GTK_EXPAND),GTK_FILL,3,3);
+	args->max_staleness = widget = gtk_spin_button_new_with_range(0, 10000, 100);
+	gtk_spin_button_set_value(GTK_SPIN_BUTTON(args->max_staleness), args->options->getInt32("picker.max_staleness", 500));
+	gtk_table_attach(GTK_TABLE(table), widget,1,2,table_y,table_y+1,GtkAttachOptions(GTK_FILL | GTK_EXPAND),GTK_FILL,5,5);
+	gtk_table_attach(GTK_TABLE(table), gtk_label_aligned_new("ms",0,0.5,0,0),2,3,table_y,table_y+1,GTK_FILL,GTK_FILL,5,5);
+	table_y++;
 	gtk_table_attach(GTK_TABLE(table), gtk_label_mnemonic_aligned_new(_("_Magnified area size:"),0,0.5,0,0),0,1,table_y,table_y+1,GtkAttachOptions(GTK_FILL | GTK_EXPAND),GTK_FILL,3,3);
 	args->zoom_size = widget = gtk_spin_button_new_with_range(75, 300, 15);
 	gtk_spin_button_set_value(GTK_SPIN_BUTTON(args->zoom_size), args->options->getInt32("picker.zoom_size", 150));
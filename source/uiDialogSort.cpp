@@ -31,6 +31,7 @@
 #include "common/Format.h"
 #include "common/Unused.h"
 #include "math/BinaryTreeQuantization.h"
+#include "math/Ckmeans.h"
 #include <tuple>
 #include <algorithm>
 namespace {
@@ -42,8 +43,33 @@ static const ChannelDescription channelNone = { "none" };
 static const ChannelDescription virtualChannels[] = {
 	{ "rgb_grayscale", N_("RGB Grayscale"), ColorSpace::rgb, Channel::userDefined, ChannelFlags::useConvertTo, { .convertTo = toGrayscale }, 0, 1 },
 };
+enum struct GroupingMethod {
+	tree,
+	optimal,
+};
+static const struct {
+	GroupingMethod method;
+	const char *id;
+	const char *name;
+} groupingMethods[] = {
+	{ GroupingMethod::tree, "tree", N_("Fast") },
+	{ GroupingMethod::optimal, "optimal", N_("Optimal") },
+};
+static std::vector<float> channelValues(const ChannelDescription &channel, const ColorList &colorList) {
+	std::vector<float> values;
+	values.reserve(colorList.size());
+	if (channel.useConvertTo()) {
+		for (auto *colorObject: colorList)
+			values.push_back(channel.convertTo(colorObject->getColor()));
+	} else {
+		auto convertTo = colorSpace(channel.colorSpace).convertTo;
+		for (auto *colorObject: colorList)
+			values.push_back((std::invoke(convertTo, colorObject->getColor()).data[channel.index] - channel.min) / (channel.max - channel.min));
+	}
+	return values;
+}
 struct SortDialog: public DialogBase {
-	GtkWidget *groupComboBox, *groupSensitivitySpin, *maxGroupsSpin, *sortComboBox, *reverseCheck, *reverseGroupsCheck, *previewExpander;
+	GtkWidget *groupComboBox, *groupMethodComboBox, *groupSensitivitySpin, *maxGroupsSpin, *sortComboBox, *reverseCheck, *reverseGroupsCheck, *previewExpander;
 	ColorList &selectedColors, &sortedColors;
 	std::vector<const ChannelDescription *> sortChannelsInComboBox, groupChannelsInComboBox;
 	const ChannelDescription *groupChannel, *sortChannel;
@@ -103,6 +129,16 @@ struct SortDialog: public DialogBase {
 		}
 		g_signal_connect(G_OBJECT(groupComboBox), "changed", G_CALLBACK(onUpdate), this);
 
+		grid.addLabel(_("Grouping:"));
+		grid.add(groupMethodComboBox = gtk_combo_box_text_new(), true);
+		auto groupMethod = options->getString("group_method", "tree");
+		for (size_t i = 0; i < sizeof(groupingMethods) / sizeof(groupingMethods[0]); ++i) {
+			gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(groupMethodComboBox), _(groupingMethods[i].name));
+			if (i == 0 || groupMethod == groupingMethods[i].id)
+				gtk_combo_box_set_active(GTK_COMBO_BOX(groupMethodComboBox), i);
+		}
+		g_signal_connect(G_OBJECT(groupMethodComboBox), "changed", G_CALLBACK(onUpdate), this);
+
 		grid.addLabel(_("Maximum number of groups:"));
 		grid.add(maxGroupsSpin = gtk_spin_button_new_with_range(1, 255, 1), true);
 		gtk_spin_button_set_value(GTK_SPIN_BUTTON(maxGroupsSpin), options->getInt32("max_groups", 10));
@@ -126,6 +162,7 @@ struct SortDialog: public DialogBase {
 		options->set<bool>("show_preview", gtk_expander_get_expanded(GTK_EXPANDER(previewExpander)));
 	}
 	void enableGroupInputs(bool enable) {
+		gtk_widget_set_sensitive(groupMethodComboBox, enable);
 		gtk_widget_set_sensitive(maxGroupsSpin, enable);
 		gtk_widget_set_sensitive(groupSensitivitySpin, enable);
 		gtk_widget_set_sensitive(reverseGroupsCheck, enable);
@@ -133,12 +170,14 @@ struct SortDialog: public DialogBase {
 	virtual void apply(bool preview) override {
 		groupChannel = groupChannelsInComboBox[gtk_combo_box_get_active(GTK_COMBO_BOX(groupComboBox))];
 		sortChannel = sortChannelsInComboBox[gtk_combo_box_get_active(GTK_COMBO_BOX(sortComboBox))];
+		const auto &groupMethod = groupingMethods[gtk_combo_box_get_active(GTK_COMBO_BOX(groupMethodComboBox))];
 		float groupSensitivity = static_cast<float>(gtk_spin_button_get_value(GTK_SPIN_BUTTON(groupSensitivitySpin)));
 		int maxGroups = static_cast<int>(gtk_spin_button_get_value(GTK_SPIN_BUTTON(maxGroupsSpin)));
 		bool reverse = gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(reverseCheck));
 		bool reverseGroups = gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(reverseGroupsCheck));
 		if (!preview) {
 			options->set("group_type", groupChannel->id);
+			options->set("group_method", groupMethod.id);
 			options->set("group_sensitivity", groupSensitivity);
 			options->set("max_groups", maxGroups);
 			options->set("sort_type", sortChannel->id);
@@ -152,13 +191,11 @@ struct SortDialog: public DialogBase {
 		using ColorWithProperties = std::tuple<float, float, ColorObject *>;
 		std::vector<ColorWithProperties> colors;
 		colors.reserve(selectedColors.size());
+		auto sortValues = channelValues(*sortChannel, selectedColors);
 		if (maxGroups == 1 || groupChannel == &channelNone) {
-			auto sortConvertTo = sortChannel->useConvertTo() ? nullptr : colorSpace(sortChannel->colorSpace).convertTo;
-			for (auto *colorObject: selectedColors) {
-				Color color = colorObject->getColor();
-				float sortValue = sortConvertTo ? (std::invoke(sortConvertTo, color).data[sortChannel->index] - sortChannel->min) / (sortChannel->max - sortChannel->min) : sortChannel->convertTo(color);
-				colors.emplace_back(0, sortValue, colorObject);
-			}
+			size_t index = 0;
+			for (auto *colorObject: selectedColors)
+				colors.emplace_back(0, sortValues[index++], colorObject);
 			std::stable_sort(colors.begin(), colors.end(), [reverse](const ColorWithProperties &a, const ColorWithProperties &b) -> bool {
 				float aSort, bSort;
 				std::tie(std::ignore, aSort, std::ignore) = a;
@@ -166,21 +203,25 @@ struct SortDialog: public DialogBase {
 				return (aSort < bSort) ^ reverse;
 			});
 		} else {
-			math::BinaryTreeQuantization<float> tree;
-			auto groupConvertTo = groupChannel->useConvertTo() ? nullptr : colorSpace(groupChannel->colorSpace).convertTo;
-			for (auto *colorObject: selectedColors) {
-				Color color = colorObject->getColor();
-				float value = groupConvertTo ? (std::invoke(groupConvertTo, color).data[groupChannel->index] - groupChannel->min) / (groupChannel->max - groupChannel->min) : groupChannel->convertTo(color);
-				tree.add(value);
+			auto groupValues = channelValues(*groupChannel, selectedColors);
+			if (groupMethod.method == GroupingMethod::optimal) {
+				auto clusters = math::ckmeans(groupValues, maxGroups);
+				auto means = math::mergeClusters(groupValues, clusters, groupSensitivity / 100.0f);
+				for (size_t i = 0; i < groupValues.size(); ++i)
+					groupValues[i] = means[clusters[i]];
+			} else {
+				math::BinaryTreeQuantization<float> tree;
+				for (auto value: groupValues)
+					tree.add(value);
+				tree.reduce(maxGroups);
+				tree.reduceByMinDistance(groupSensitivity / 100.0f);
+				for (auto &value: groupValues)
+					value = tree.find(value);
 			}
-			tree.reduce(maxGroups);
-			tree.reduceByMinDistance(groupSensitivity / 100.0f);
-			auto sortConvertTo = sortChannel->useConvertTo() ? nullptr : colorSpace(sortChannel->colorSpace).convertTo;
+			size_t index = 0;
 			for (auto *colorObject: selectedColors) {
-				Color color = colorObject->getColor();
-				float groupValue = tree.find(groupConvertTo ? (std::invoke(groupConvertTo, color).data[groupChannel->index] - groupChannel->min) / (groupChannel->max - groupChannel->min) : groupChannel->convertTo(color));
-				float sortValue = sortConvertTo ? (std::invoke(sortConvertTo, color).data[sortChannel->index] - sortChannel->min) / (sortChannel->max - sortChannel->min) : sortChannel->convertTo(color);
-				colors.emplace_back(groupValue, sortValue, colorObject);
+				colors.emplace_back(groupValues[index], sortValues[index], colorObject);
+				++index;
 			}
 			std::stable_sort(colors.begin(), colors.end(), [reverse, reverseGroups](const ColorWithProperties &a, const ColorWithProperties &b) -> bool {
 				float aGroup, aSort, bGroup, bSort;
@@ -19,6 +19,7 @@
 #include "uiListPalette.h"
 #include "uiUtilities.h"
 #include "gtk/ColorCell.h"
+#include "gtk/ColorListModel.h"
 #include "ColorObject.h"
 #include "ColorList.h"
 #include "IColorSource.h"
@@ -41,6 +42,7 @@
 #include "IPalette.h"
 #include <boost/algorithm/string/find.hpp>
 #include <unordered_set>
+#include <unordered_map>
 #include <sstream>
 #include <iomanip>
 #include <string_view>
@@ -54,9 +56,43 @@ enum struct Type {
 struct ListPaletteArgs;
 static void foreachSelectedItem(GtkTreeView *treeView, std::function<bool(ColorObject *)> callback);
 static void foreachItem(GtkTreeView *treeView, std::function<bool(ColorObject *)> callback);
-static void updateAll(GtkTreeView *treeView, GlobalState &gs);
-static void set(GtkListStore* store, GtkTreeIter *iter, ColorObject* colorObject, ListPaletteArgs* args);
 const int scrollEdgeSize = 15; //SCROLL_EDGE_SIZE from gtktreeview.c
+// Color texts are serialized only when rows are drawn or searched, and are kept until converter, options, color or name changes.
+struct DisplayCache {
+	DisplayCache():
+		m_generation(0) {
+	}
+	const std::string &get(const ColorObject &colorObject, GlobalState &gs) {
+		auto converter = gs.converters().colorList();
+		auto &entry = m_entries[&colorObject];
+		if (entry.generation == m_generation && entry.converter == converter && entry.color == colorObject.getColor() && entry.name == colorObject.getName() && !entry.text.empty())
+			return entry.text;
+		entry.generation = m_generation;
+		entry.converter = converter;
+		entry.color = colorObject.getColor();
+		entry.name = colorObject.getName();
+		entry.text = gs.converters().serialize(colorObject, Converters::Type::colorList);
+		return entry.text;
+	}
+	void invalidate() {
+		m_generation++;
+	}
+	void remove(const ColorObject *colorObject) {
+		m_entries.erase(colorObject);
+	}
+	void clear() {
+		m_entries.clear();
+	}
+private:
+	struct Entry {
+		uint64_t generation;
+		Converter *converter;
+		Color color;
+		std::string name, text;
+	};
+	uint64_t m_generation;
+	std::unordered_map<const ColorObject *, Entry> m_entries;
+};
 struct ListPaletteArgs : public IEditableColorsUI, public IContainerUI, public IDroppableColorsUI, public IDraggableColorUI, public IEventHandler, public IPalette {
 	GtkWidget *treeview;
 	gint scrollTimeout;
@@ -66,6 +102,7 @@ struct ListPaletteArgs : public IEditableColorsUI, public IContainerUI, public I
 	bool countUpdateBlocked;
 	Type type;
 	ColorList &colorList;
+	DisplayCache displayCache;
 	ListPaletteArgs(GlobalState &gs, GtkWidget *countLabel, Type type, ColorList &colorList):
 		scrollTimeout(0),
 		countLabel(countLabel),
@@ -103,7 +140,7 @@ struct ListPaletteArgs : public IEditableColorsUI, public IContainerUI, public I
 		treeview = gtk_tree_view_new();
 		gtk_tree_view_set_headers_visible(GTK_TREE_VIEW(treeview), true);
 		gtk_tree_view_set_fixed_height_mode(GTK_TREE_VIEW(treeview), true);
-		auto store = gtk_list_store_new (3, G_TYPE_POINTER, G_TYPE_STRING, G_TYPE_STRING);
+		auto store = gtk_color_list_model_new();
 		g_object_set_data_full(G_OBJECT(store), "arguments", this, nullptr);
 		auto col = gtk_tree_view_column_new();
 		gtk_tree_view_column_set_sizing(col, GTK_TREE_VIEW_COLUMN_FIXED);
@@ -120,7 +157,7 @@ struct ListPaletteArgs : public IEditableColorsUI, public IContainerUI, public I
 		gtk_tree_view_column_set_title(col, _("Color"));
 		renderer = gtk_cell_renderer_text_new();
 		gtk_tree_view_column_pack_start(col, renderer, true);
-		gtk_tree_view_column_add_attribute(col, renderer, "text", 1);
+		gtk_tree_view_column_set_cell_data_func(col, renderer, reinterpret_cast<GtkTreeCellDataFunc>(colorTextDataFunction), this, nullptr);
 		gtk_tree_view_append_column(GTK_TREE_VIEW(treeview), col);
 
 		col = gtk_tree_view_column_new();
@@ -129,14 +166,14 @@ struct ListPaletteArgs : public IEditableColorsUI, public IContainerUI, public I
 		gtk_tree_view_column_set_title(col, _("Name"));
 		renderer = gtk_cell_renderer_text_new();
 		gtk_tree_view_column_pack_start(col, renderer, true);
-		gtk_tree_view_column_add_attribute(col, renderer, "text", 2);
+		gtk_tree_view_column_add_attribute(col, renderer, "text", 1);
 		gtk_tree_view_append_column(GTK_TREE_VIEW(treeview), col);
 		g_object_set(renderer, "editable", TRUE, nullptr);
 		g_signal_connect(renderer, "edited", G_CALLBACK(onCellEdited), store);
 		gtk_tree_view_set_model(GTK_TREE_VIEW(treeview), GTK_TREE_MODEL(store));
 		g_object_unref(GTK_TREE_MODEL(store));
 		gtk_tree_view_set_enable_search(GTK_TREE_VIEW(treeview), false);
-		gtk_tree_view_set_search_equal_func(GTK_TREE_VIEW(treeview), onSearchEqual, nullptr, nullptr);
+		gtk_tree_view_set_search_equal_func(GTK_TREE_VIEW(treeview), reinterpret_cast<GtkTreeViewSearchEqualFunc>(onSearchEqual), this, nullptr);
 		GtkTreeSelection *selection = gtk_tree_view_get_selection(GTK_TREE_VIEW(treeview));
 		gtk_tree_selection_set_mode(selection, GTK_SELECTION_MULTIPLE);
 		g_signal_connect(G_OBJECT(treeview), "row-activated", G_CALLBACK(onRowActivated), this);
@@ -160,7 +197,7 @@ struct ListPaletteArgs : public IEditableColorsUI, public IContainerUI, public I
 		treeview = gtk_tree_view_new();
 		gtk_tree_view_set_headers_visible(GTK_TREE_VIEW(treeview), 0);
 		gtk_tree_view_set_fixed_height_mode(GTK_TREE_VIEW(treeview), true);
-		auto store = gtk_list_store_new(3, G_TYPE_POINTER, G_TYPE_STRING, G_TYPE_STRING);
+		auto store = gtk_color_list_model_new();
 		auto col = gtk_tree_view_column_new();
 		gtk_tree_view_column_set_sizing(col, GTK_TREE_VIEW_COLUMN_FIXED);
 		gtk_tree_view_column_set_resizable(col, 0);
@@ -285,44 +322,27 @@ struct ListPaletteArgs : public IEditableColorsUI, public IContainerUI, public I
 		droppedColors.clear();
 		removeScrollTimeout();
 		auto model = gtk_tree_view_get_model(GTK_TREE_VIEW(treeview));
-		std::optional<GtkTreeIter> insertIterator;
 		GtkTreePath* path;
 		GtkTreeViewDropPosition pos;
 		size_t position;
-		bool before = false;
 		if (getPathAt(GTK_TREE_VIEW(treeview), x, y, path, pos)) {
-			GtkTreeIter iter;
-			gtk_tree_model_get_iter(model, &iter, path);
 			position = gtk_tree_path_get_indices(path)[0];
 			gtk_tree_path_free(path);
-			insertIterator = iter;
-			if (pos == GTK_TREE_VIEW_DROP_AFTER || pos == GTK_TREE_VIEW_DROP_INTO_OR_AFTER) {
+			if (pos == GTK_TREE_VIEW_DROP_AFTER || pos == GTK_TREE_VIEW_DROP_INTO_OR_AFTER)
 				position += 1;
-			} else {
-				before = true;
-			}
 		} else {
-			position = gtk_tree_model_iter_n_children(model, nullptr);
+			position = gtk_color_list_model_size(GTK_COLOR_LIST_MODEL(model));
 		}
 		dropGuard.emplace(std::move(colorList.changeGuard()));
-		for (auto &colorObject: colorObjects) {
-			GtkTreeIter iter;
-			if (insertIterator) {
-				if (before) {
-					gtk_list_store_insert_before(GTK_LIST_STORE(model), &iter, &*insertIterator);
-				} else {
-					gtk_list_store_insert_after(GTK_LIST_STORE(model), &iter, &*insertIterator);
-					insertIterator = iter;
-				}
-			} else {
-				gtk_list_store_append(GTK_LIST_STORE(model), &iter);
-			}
-			auto newColorObject = colorObject.copy();
-			set(GTK_LIST_STORE(model), &iter, newColorObject.pointer(), this);
+		std::vector<ColorObject *> newColorObjects;
+		newColorObjects.reserve(colorObjects.size());
+		for (size_t i = 0; i < colorObjects.size(); i++) {
+			auto newColorObject = colorObjects[i].copy();
+			gtk_color_list_model_insert(GTK_COLOR_LIST_MODEL(model), position + i, newColorObject.pointer());
 			droppedColors.emplace(newColorObject.pointer());
-			colorList.add(newColorObject.pointer(), position);
-			++position;
+			newColorObjects.push_back(newColorObject.pointer());
 		}
+		colorList.add(newColorObjects, position);
 	}
 	std::unordered_set<ColorObject *> draggingColors;
 	virtual std::vector<ColorObject> getColors(bool selected) override {
@@ -379,22 +399,18 @@ struct ListPaletteArgs : public IEditableColorsUI, public IContainerUI, public I
 		}else{
 			int tx, ty;
 			gtk_tree_view_convert_widget_to_tree_coords(treeView, x, y, &tx, &ty);
-			GtkTreeModel *model = gtk_tree_view_get_model(treeView);
-			GtkTreeIter last, iter;
-			if (!gtk_tree_model_get_iter_first(model, &iter)) {
+			auto count = gtk_color_list_model_size(GTK_COLOR_LIST_MODEL(gtk_tree_view_get_model(treeView)));
+			if (count == 0) {
 				position = GTK_TREE_VIEW_DROP_AFTER;
 				return false;
 			}
 			if (ty >= 0) {
-				do {
-					last = iter;
-				} while (gtk_tree_model_iter_next(model, &iter));
 				position = GTK_TREE_VIEW_DROP_AFTER;
-				iter = last;
+				path = gtk_tree_path_new_from_indices(static_cast<gint>(count - 1), -1);
 			} else {
 				position = GTK_TREE_VIEW_DROP_BEFORE;
+				path = gtk_tree_path_new_from_indices(0, -1);
 			}
-			path = gtk_tree_model_get_path(model, &iter);
 			return true;
 		}
 	}
@@ -424,23 +440,21 @@ struct ListPaletteArgs : public IEditableColorsUI, public IContainerUI, public I
 		auto *selection = gtk_tree_view_get_selection(GTK_TREE_VIEW(treeview));
 		gtk_tree_selection_set_select_function(selection, nullptr, nullptr, nullptr);
 		gtk_tree_selection_unselect_all(selection);
-		auto model = gtk_tree_view_get_model(GTK_TREE_VIEW(treeview));
-		GtkTreeIter iter;
-		bool valid = gtk_tree_model_get_iter_first(GTK_TREE_MODEL(model), &iter);
+		auto model = GTK_COLOR_LIST_MODEL(gtk_tree_view_get_model(GTK_TREE_VIEW(treeview)));
+		const auto &colors = gtk_color_list_model_colors(model);
 		bool first = true;
-		while (valid) {
-			ColorObject *colorObject;
-			gtk_tree_model_get(model, &iter, 0, &colorObject, -1);
-			if (droppedColors.count(colorObject) != 0) {
-				gtk_tree_selection_select_iter(selection, &iter);
-				if (first) {
-					first = false;
-					auto path = gtk_tree_model_get_path(model, &iter);
-					gtk_tree_view_set_cursor(GTK_TREE_VIEW(treeview), path, nullptr, false);
-					gtk_tree_path_free(path);
-				}
+		for (size_t i = 0; i < colors.size(); i++) {
+			if (droppedColors.count(colors[i]) == 0)
+				continue;
+			GtkTreeIter iter;
+			gtk_color_list_model_get_iter(model, i, &iter);
+			gtk_tree_selection_select_iter(selection, &iter);
+			if (first) {
+				first = false;
+				auto path = gtk_tree_path_new_from_indices(static_cast<gint>(i), -1);
+				gtk_tree_view_set_cursor(GTK_TREE_VIEW(treeview), path, nullptr, false);
+				gtk_tree_path_free(path);
 			}
-			valid = gtk_tree_model_iter_next(GTK_TREE_MODEL(model), &iter);
 		}
 		droppedColors.clear();
 		if (self) {
@@ -463,19 +477,13 @@ struct ListPaletteArgs : public IEditableColorsUI, public IContainerUI, public I
 			return;
 		}
 		if (move) {
-			GtkListStore *store = GTK_LIST_STORE(gtk_tree_view_get_model(GTK_TREE_VIEW(treeview)));;
-			GtkTreeIter iter;
-			gboolean valid = gtk_tree_model_get_iter_first(GTK_TREE_MODEL(store), &iter);
-			ColorObject *colorObject;
-			while (valid) {
-				gtk_tree_model_get(GTK_TREE_MODEL(store), &iter, 0, &colorObject, -1);
-				if (draggingColors.count(colorObject) != 0) {
-					valid = gtk_list_store_remove(GTK_LIST_STORE(store), &iter);
-					colorObject->release();
-				}else{
-					valid = gtk_tree_model_iter_next(GTK_TREE_MODEL(store), &iter);
-				}
-			}
+			auto model = GTK_COLOR_LIST_MODEL(gtk_tree_view_get_model(GTK_TREE_VIEW(treeview)));
+			gtk_color_list_model_remove_if(model, [this](size_t, ColorObject *colorObject) {
+				if (draggingColors.count(colorObject) == 0)
+					return false;
+				displayCache.remove(colorObject);
+				return true;
+			});
 			colorList.remove([&](ColorObject *colorObject) {
 				return draggingColors.count(colorObject) != 0;
 			}, false, false);
@@ -565,7 +573,8 @@ struct ListPaletteArgs : public IEditableColorsUI, public IContainerUI, public I
 		switch (eventType) {
 		case EventType::optionsUpdate:
 		case EventType::convertersUpdate:
-			updateAll(GTK_TREE_VIEW(treeview), gs);
+			displayCache.invalidate();
+			gtk_widget_queue_draw(treeview);
 			break;
 		case EventType::displayFiltersUpdate:
 		case EventType::colorDictionaryUpdate:
@@ -604,8 +613,11 @@ struct ListPaletteArgs : public IEditableColorsUI, public IContainerUI, public I
 	virtual void add(ColorList &colorList, ColorObject *colorObject) override {
 		palette_list_add_entry(treeview, colorObject, !colorList.blocked());
 	}
-	virtual void remove(ColorList &colorList, ColorObject *colorObject) override {
-		palette_list_remove_entry(treeview, colorObject, !colorList.blocked());
+	virtual void add(ColorList &colorList, const std::vector<ColorObject *> &colorObjects) override {
+		palette_list_add_entries(treeview, colorObjects, !colorList.blocked());
+	}
+	virtual void remove(ColorList &colorList, const std::vector<ColorObject *> &colorObjects) override {
+		palette_list_remove_entries(treeview, colorObjects, !colorList.blocked());
 	}
 	virtual void removeSelected(ColorList &colorList) override {
 		palette_list_remove_selected_entries(treeview, !colorList.blocked());
@@ -638,13 +650,11 @@ struct ListPaletteArgs : public IEditableColorsUI, public IContainerUI, public I
 		GtkTreeIter iter;
 		GtkTreeModel *model = GTK_TREE_MODEL(userData);
 		ListPaletteArgs *args = reinterpret_cast<ListPaletteArgs *>(g_object_get_data(G_OBJECT(model), "arguments"));
-		gtk_tree_model_get_iter_from_string(model, &iter, path);
-		gtk_list_store_set(GTK_LIST_STORE(model), &iter,
-				2, new_text,
-				-1);
-		ColorObject *colorObject;
-		gtk_tree_model_get(model, &iter, 0, &colorObject, -1);
+		if (!gtk_tree_model_get_iter_from_string(model, &iter, path))
+			return;
+		auto colorObject = gtk_color_list_model_get(GTK_COLOR_LIST_MODEL(model), &iter);
 		colorObject->setName(new_text);
+		gtk_color_list_model_changed(GTK_COLOR_LIST_MODEL(model), gtk_color_list_model_get_index(GTK_COLOR_LIST_MODEL(model), &iter));
 		args->onChange();
 	}
 	static void onPreviewActivate(GtkTreeView *treeView, GtkTreePath *path, GtkTreeViewColumn *column, ListPaletteArgs *args) {
@@ -706,64 +716,42 @@ struct ListPaletteArgs : public IEditableColorsUI, public IContainerUI, public I
 			return false;
 		return boost::ifind_first(value, start);
 	}
-	static gboolean onSearchEqual(GtkTreeModel *model, gint, const gchar *key, GtkTreeIter *iter, gpointer) {
-		gchar *code, *name;
-		gtk_tree_model_get(model, iter, 1, &code, 2, &name, -1);
-		return !(contains(code, key) || contains(name, key));
+	static gboolean onSearchEqual(GtkTreeModel *model, gint, const gchar *key, GtkTreeIter *iter, ListPaletteArgs *args) {
+		auto colorObject = gtk_color_list_model_get(GTK_COLOR_LIST_MODEL(model), iter);
+		if (!colorObject)
+			return true;
+		return !(contains(args->displayCache.get(*colorObject, args->gs), key) || contains(colorObject->getName(), key));
+	}
+	static void colorTextDataFunction(GtkTreeViewColumn *, GtkCellRenderer *renderer, GtkTreeModel *model, GtkTreeIter *iter, ListPaletteArgs *args) {
+		auto colorObject = gtk_color_list_model_get(GTK_COLOR_LIST_MODEL(model), iter);
+		g_object_set(renderer, "text", colorObject ? args->displayCache.get(*colorObject, args->gs).c_str() : "", nullptr);
 	}
 	ColorObject colorObject;
 };
-static void set(GtkListStore *store, GtkTreeIter *iter, ColorObject *colorObject, ListPaletteArgs *args) {
-	std::string text = args->gs.converters().serialize(*colorObject, Converters::Type::colorList);
-	gtk_list_store_set(store, iter, 0, colorObject->reference(), 1, text.c_str(), 2, colorObject->getName().c_str(), -1);
-}
-static void setName(GtkListStore *store, GtkTreeIter *iter, ColorObject *colorObject) {
-	gtk_list_store_set(store, iter, 2, colorObject->getName().c_str(), -1);
-}
-static void setAll(GtkListStore *store, GtkTreeIter *iter, ColorObject *colorObject, ListPaletteArgs *args) {
-	std::string text = args->gs.converters().serialize(*colorObject, Converters::Type::colorList);
-	gtk_list_store_set(store, iter, 1, text.c_str(), 2, colorObject->getName().c_str(), -1);
+static std::vector<size_t> getSelectedIndices(GtkTreeView *treeView) {
+	std::vector<size_t> result;
+	auto selection = gtk_tree_view_get_selection(treeView);
+	GList *list = gtk_tree_selection_get_selected_rows(selection, nullptr);
+	for (GList *i = list; i; i = g_list_next(i)) {
+		result.push_back(gtk_tree_path_get_indices(reinterpret_cast<GtkTreePath *>(i->data))[0]);
+	}
+	g_list_foreach(list, (GFunc)gtk_tree_path_free, nullptr);
+	g_list_free(list);
+	return result;
 }
 static void foreachItem(GtkTreeView *treeView, std::function<bool(ColorObject *)> callback) {
-	auto model = gtk_tree_view_get_model(treeView);
-	GtkTreeIter iter;
-	auto valid = gtk_tree_model_get_iter_first(model, &iter);
-	while (valid) {
-		ColorObject *colorObject;
-		gtk_tree_model_get(model, &iter, 0, &colorObject, -1);
+	auto model = GTK_COLOR_LIST_MODEL(gtk_tree_view_get_model(treeView));
+	for (auto *colorObject: gtk_color_list_model_colors(model)) {
 		if (!callback(colorObject))
 			break;
-		valid = gtk_tree_model_iter_next(model, &iter);
-	}
-}
-static void updateAll(GtkTreeView *treeView, GlobalState &gs) {
-	auto model = gtk_tree_view_get_model(treeView);
-	GtkTreeIter iter;
-	auto valid = gtk_tree_model_get_iter_first(model, &iter);
-	while (valid) {
-		ColorObject *colorObject;
-		gtk_tree_model_get(model, &iter, 0, &colorObject, -1);
-		std::string text = gs.converters().serialize(*colorObject, Converters::Type::colorList);
-		gtk_list_store_set(GTK_LIST_STORE(model), &iter, 1, text.c_str(), -1);
-		valid = gtk_tree_model_iter_next(model, &iter);
 	}
 }
 static void foreachSelectedItem(GtkTreeView *treeView, std::function<bool(ColorObject *)> callback) {
-	auto model = gtk_tree_view_get_model(treeView);
-	auto selection = gtk_tree_view_get_selection(treeView);
-	GList *list = gtk_tree_selection_get_selected_rows(selection, nullptr);
-	GList *i = list;
-	while (i) {
-		GtkTreeIter iter;
-		gtk_tree_model_get_iter(model, &iter, reinterpret_cast<GtkTreePath *>(i->data));
-		ColorObject *colorObject;
-		gtk_tree_model_get(model, &iter, 0, &colorObject, -1);
-		if (!callback(colorObject))
+	auto model = GTK_COLOR_LIST_MODEL(gtk_tree_view_get_model(treeView));
+	for (auto index: getSelectedIndices(treeView)) {
+		if (!callback(gtk_color_list_model_get(model, index)))
 			break;
-		i = g_list_next(i);
 	}
-	g_list_foreach(list, (GFunc)gtk_tree_path_free, nullptr);
-	g_list_free(list);
 }
 #if GTK_MAJOR_VERSION >= 3
 static void onExpanderStateChange(GtkExpander *expander, GParamSpec *, ListPaletteArgs *args) {
@@ -803,16 +791,8 @@ GtkWidget* palette_list_preview_new(GlobalState &gs, bool expander, bool expande
 
 void palette_list_remove_all_entries(GtkWidget* widget, bool allowUpdate) {
 	ListPaletteArgs* args = (ListPaletteArgs*)g_object_get_data(G_OBJECT(widget), "arguments");
-	GtkListStore *store = GTK_LIST_STORE(gtk_tree_view_get_model(GTK_TREE_VIEW(widget)));
-	GtkTreeIter iter;
-	gboolean valid = gtk_tree_model_get_iter_first(GTK_TREE_MODEL(store), &iter);
-	while (valid) {
-		ColorObject *colorObject;
-		gtk_tree_model_get(GTK_TREE_MODEL(store), &iter, 0, &colorObject, -1);
-		colorObject->release();
-		valid = gtk_tree_model_iter_next(GTK_TREE_MODEL(store), &iter);
-	}
-	gtk_list_store_clear(GTK_LIST_STORE(store));
+	gtk_color_list_model_clear(GTK_COLOR_LIST_MODEL(gtk_tree_view_get_model(GTK_TREE_VIEW(widget))));
+	args->displayCache.clear();
 	if (allowUpdate) {
 		args->updateCounts();
 		args->onChange();
@@ -822,36 +802,20 @@ int palette_list_get_selected_count(GtkWidget* widget) {
 	return gtk_tree_selection_count_selected_rows(gtk_tree_view_get_selection(GTK_TREE_VIEW(widget)));
 }
 int palette_list_get_count(GtkWidget* widget) {
-	return gtk_tree_model_iter_n_children(gtk_tree_view_get_model(GTK_TREE_VIEW(widget)), nullptr);
+	return gtk_color_list_model_size(GTK_COLOR_LIST_MODEL(gtk_tree_view_get_model(GTK_TREE_VIEW(widget))));
 }
 void palette_list_remove_selected_entries(GtkWidget* widget, bool allowUpdate) {
 	auto *args = reinterpret_cast<ListPaletteArgs *>(g_object_get_data(G_OBJECT(widget), "arguments"));
-	auto model = gtk_tree_view_get_model(GTK_TREE_VIEW(widget));
-	auto selection = gtk_tree_view_get_selection(GTK_TREE_VIEW(widget));
-	GList *list = gtk_tree_selection_get_selected_rows(selection, nullptr), *referenceList = nullptr;
-	GList *i = list;
-	while (i) {
-		referenceList = g_list_prepend(referenceList, gtk_tree_row_reference_new(model, reinterpret_cast<GtkTreePath *>(i->data)));
-		i = g_list_next(i);
-	}
-	i = referenceList;
-	while (i) {
-		GtkTreePath *path = gtk_tree_row_reference_get_path(reinterpret_cast<GtkTreeRowReference *>(i->data));
-		if (path) {
-			GtkTreeIter iter;
-			gtk_tree_model_get_iter(model, &iter, path);
-			gtk_tree_path_free(path);
-			ColorObject *colorObject;
-			gtk_tree_model_get(model, &iter, 0, &colorObject, -1);
-			colorObject->release();
-			gtk_list_store_remove(GTK_LIST_STORE(model), &iter);
-		}
-		i = g_list_next(i);
-	}
-	g_list_foreach(referenceList, (GFunc)gtk_tree_row_reference_free, nullptr);
-	g_list_free(referenceList);
-	g_list_foreach(list, (GFunc)gtk_tree_path_free, nullptr);
-	g_list_free(list);
+	auto model = GTK_COLOR_LIST_MODEL(gtk_tree_view_get_model(GTK_TREE_VIEW(widget)));
+	std::vector<bool> selected(gtk_color_list_model_size(model), false);
+	for (auto index: getSelectedIndices(GTK_TREE_VIEW(widget)))
+		selected[index] = true;
+	gtk_color_list_model_remove_if(model, [args, &selected](size_t index, ColorObject *colorObject) {
+		if (!selected[index])
+			return false;
+		args->displayCache.remove(colorObject);
+		return true;
+	});
 	if (allowUpdate) {
 		args->updateCounts();
 		args->onChange();
@@ -860,76 +824,55 @@ void palette_list_remove_selected_entries(GtkWidget* widget, bool allowUpdate) {
 void palette_list_add_entry(GtkWidget* widget, ColorObject* colorObject, bool allowUpdate)
 {
 	ListPaletteArgs* args = (ListPaletteArgs*)g_object_get_data(G_OBJECT(widget), "arguments");
-	GtkTreeIter iter1;
-	GtkListStore *store;
-	store = GTK_LIST_STORE(gtk_tree_view_get_model(GTK_TREE_VIEW(widget)));
-	gtk_list_store_append(store, &iter1);
-	set(store, &iter1, colorObject, args);
+	gtk_color_list_model_append(GTK_COLOR_LIST_MODEL(gtk_tree_view_get_model(GTK_TREE_VIEW(widget))), colorObject);
 	if (allowUpdate) {
 		args->updateCounts();
 		args->onChange();
 	}
 }
-int palette_list_remove_entry(GtkWidget* widget, ColorObject* r_color_object, bool allowUpdate)
+void palette_list_add_entries(GtkWidget* widget, const std::vector<ColorObject *> &colorObjects, bool allowUpdate)
 {
 	ListPaletteArgs* args = (ListPaletteArgs*)g_object_get_data(G_OBJECT(widget), "arguments");
-	GtkTreeIter iter;
-	GtkListStore *store;
-	gboolean valid;
-	store = GTK_LIST_STORE(gtk_tree_view_get_model(GTK_TREE_VIEW(widget)));
-	valid = gtk_tree_model_get_iter_first(GTK_TREE_MODEL(store), &iter);
-	ColorObject* colorObject;
-	while (valid){
-		gtk_tree_model_get(GTK_TREE_MODEL(store), &iter, 0, &colorObject, -1);
-		if (colorObject == r_color_object){
-			valid = gtk_list_store_remove(GTK_LIST_STORE(store), &iter);
-			colorObject->release();
-			if (allowUpdate) {
-				args->updateCounts();
-				args->onChange();
-			}
-			return 0;
-		}
-		valid = gtk_tree_model_iter_next(GTK_TREE_MODEL(store), &iter);
+	auto model = GTK_COLOR_LIST_MODEL(gtk_tree_view_get_model(GTK_TREE_VIEW(widget)));
+	for (auto *colorObject: colorObjects)
+		gtk_color_list_model_append(model, colorObject);
+	if (allowUpdate) {
+		args->updateCounts();
+		args->onChange();
 	}
-	return -1;
 }
-ColorObject *palette_list_get_first_selected(GtkWidget *widget) {
-	GtkTreeSelection *selection = gtk_tree_view_get_selection(GTK_TREE_VIEW(widget));
-	GtkTreeModel *model = gtk_tree_view_get_model(GTK_TREE_VIEW(widget));
-	GList *list = gtk_tree_selection_get_selected_rows(selection, nullptr);
-	GList *i = list;
-	ColorObject *colorObject = nullptr;
-	if (i) {
-		GtkTreeIter iter;
-		gtk_tree_model_get_iter(model, &iter, reinterpret_cast<GtkTreePath*>(i->data));
-		gtk_tree_model_get(model, &iter, 0, &colorObject, -1);
+void palette_list_remove_entries(GtkWidget* widget, const std::vector<ColorObject *> &colorObjects, bool allowUpdate)
+{
+	ListPaletteArgs* args = (ListPaletteArgs*)g_object_get_data(G_OBJECT(widget), "arguments");
+	auto model = GTK_COLOR_LIST_MODEL(gtk_tree_view_get_model(GTK_TREE_VIEW(widget)));
+	std::unordered_set<ColorObject *> removed(colorObjects.begin(), colorObjects.end());
+	gtk_color_list_model_remove_if(model, [args, &removed](size_t, ColorObject *colorObject) {
+		if (removed.count(colorObject) == 0)
+			return false;
+		args->displayCache.remove(colorObject);
+		return true;
+	});
+	if (allowUpdate) {
+		args->updateCounts();
+		args->onChange();
 	}
-	g_list_foreach(list, (GFunc)gtk_tree_path_free, nullptr);
-	g_list_free(list);
-	return colorObject;
+}
+ColorObject *palette_list_get_first_selected(GtkWidget *widget) {
+	auto model = GTK_COLOR_LIST_MODEL(gtk_tree_view_get_model(GTK_TREE_VIEW(widget)));
+	auto indices = getSelectedIndices(GTK_TREE_VIEW(widget));
+	if (indices.empty())
+		return nullptr;
+	return gtk_color_list_model_get(model, indices.front());
 }
 void palette_list_update_first_selected(GtkWidget *widget, bool onlyName, bool allowUpdate) {
 	ListPaletteArgs* args = (ListPaletteArgs*)g_object_get_data(G_OBJECT(widget), "arguments");
-	GtkTreeSelection *selection = gtk_tree_view_get_selection(GTK_TREE_VIEW(widget));
-	GtkTreeModel *model = gtk_tree_view_get_model(GTK_TREE_VIEW(widget));
-	GList *list = gtk_tree_selection_get_selected_rows(selection, nullptr);
-	GList *i = list;
-	ColorObject *colorObject = nullptr;
-	bool changed = false;
-	if (i) {
-		GtkTreeIter iter;
-		gtk_tree_model_get_iter(model, &iter, reinterpret_cast<GtkTreePath*>(i->data));
-		gtk_tree_model_get(model, &iter, 0, &colorObject, -1);
-		if (onlyName)
-			setName(GTK_LIST_STORE(model), &iter, colorObject);
-		else
-			setAll(GTK_LIST_STORE(model), &iter, colorObject, args);
-		changed = true;
-	}
-	g_list_foreach(list, (GFunc)gtk_tree_path_free, nullptr);
-	g_list_free(list);
-	if (changed && allowUpdate)
+	auto model = GTK_COLOR_LIST_MODEL(gtk_tree_view_get_model(GTK_TREE_VIEW(widget)));
+	auto indices = getSelectedIndices(GTK_TREE_VIEW(widget));
+	if (indices.empty())
+		return;
+	// Name and color texts are read from the color object when the row is drawn, so a row change is enough for both update kinds.
+	gtk_color_list_model_changed(model, indices.front());
+	if (allowUpdate)
 		args->onChange();
 }
 void palette_list_append_copy_menu(GtkWidget* widget, GtkWidget *menu) {
@@ -944,78 +887,37 @@ void palette_list_after_update(GtkWidget* widget) {
 template<bool Replace, typename Callback>
 void forEach(GtkWidget *widget, bool selected, Callback &&callback, bool allowUpdate) {
 	auto args = reinterpret_cast<ListPaletteArgs *>(g_object_get_data(G_OBJECT(widget), "arguments"));
-	auto model = gtk_tree_view_get_model(GTK_TREE_VIEW(widget));
-	GtkTreeIter iter;
+	auto model = GTK_COLOR_LIST_MODEL(gtk_tree_view_get_model(GTK_TREE_VIEW(widget)));
 	bool changed = false;
-	if (selected) {
-		auto selection = gtk_tree_view_get_selection(GTK_TREE_VIEW(widget));
-		GList *list = gtk_tree_selection_get_selected_rows(selection, nullptr);
-		GList *i = list;
-		while (i) {
-			gtk_tree_model_get_iter(model, &iter, reinterpret_cast<GtkTreePath *>(i->data));
-			ColorObject *colorObject;
-			gtk_tree_model_get(model, &iter, 0, &colorObject, -1);
-			if constexpr (Replace) {
-				ColorObject *newColorObject = colorObject;
-				auto result = callback(&newColorObject);
-				if (newColorObject != colorObject) {
-					set(GTK_LIST_STORE(model), &iter, newColorObject, args);
-					changed = true;
-					colorObject->release();
-				} else if (result == Update::name) {
-					setName(GTK_LIST_STORE(model), &iter, colorObject);
-					changed = true;
-				} else if (result == Update::row) {
-					setAll(GTK_LIST_STORE(model), &iter, colorObject, args);
-					changed = true;
-				}
-			} else {
-				auto result = callback(colorObject);
-				if (result == Update::name) {
-					setName(GTK_LIST_STORE(model), &iter, colorObject);
-					changed = true;
-				} else if (result == Update::row) {
-					setAll(GTK_LIST_STORE(model), &iter, colorObject, args);
-					changed = true;
-				}
+	auto visit = [&](size_t index) {
+		auto colorObject = gtk_color_list_model_get(model, index);
+		Update result;
+		if constexpr (Replace) {
+			ColorObject *newColorObject = colorObject;
+			colorObject->reference();
+			result = callback(&newColorObject);
+			if (newColorObject != colorObject) {
+				gtk_color_list_model_set(model, index, newColorObject);
+				args->displayCache.remove(colorObject);
+				result = Update::row;
 			}
-			i = g_list_next(i);
+			colorObject->release();
+		} else {
+			result = callback(colorObject);
 		}
-		g_list_foreach(list, (GFunc)gtk_tree_path_free, nullptr);
-		g_list_free(list);
+		if (result != Update::none)
+			changed = true;
+	};
+	if (selected) {
+		for (auto index: getSelectedIndices(GTK_TREE_VIEW(widget)))
+			visit(index);
 	} else {
-		auto valid = gtk_tree_model_get_iter_first(model, &iter);
-		while (valid) {
-			ColorObject *colorObject;
-			gtk_tree_model_get(model, &iter, 0, &colorObject, -1);
-			if constexpr (Replace) {
-				ColorObject *newColorObject = colorObject;
-				colorObject->reference();
-				auto result = callback(&newColorObject);
-				if (newColorObject != colorObject) {
-					set(GTK_LIST_STORE(model), &iter, newColorObject, args);
-					changed = true;
-				} else if (result == Update::name) {
-					setName(GTK_LIST_STORE(model), &iter, colorObject);
-					changed = true;
-				} else if (result == Update::row) {
-					setAll(GTK_LIST_STORE(model), &iter, colorObject, args);
-					changed = true;
-				}
-				colorObject->release();
-			} else {
-				auto result = callback(colorObject);
-				if (result == Update::name) {
-					setName(GTK_LIST_STORE(model), &iter, colorObject);
-					changed = true;
-				} else if (result == Update::row) {
-					setAll(GTK_LIST_STORE(model), &iter, colorObject, args);
-					changed = true;
-				}
-			}
-			valid = gtk_tree_model_iter_next(model, &iter);
-		}
+		for (size_t i = 0, count = gtk_color_list_model_size(model); i < count; i++)
+			visit(i);
 	}
+	// Rows are drawn from color objects directly, so one redraw replaces a row change signal per updated row.
+	if (changed)
+		gtk_widget_queue_draw(widget);
 	if (changed && allowUpdate)
 		args->onChange();
 }
@@ -21,16 +21,18 @@
 #include <gtk/gtk.h>
 #include <unordered_set>
 #include <functional>
+#include <vector>
 struct GlobalState;
 struct ColorObject;
 struct ColorList;
 GtkWidget* palette_list_new(GlobalState &gs, GtkWidget *countLabel);
 GtkWidget* palette_list_temporary_new(GlobalState &gs, GtkWidget* countLabel, ColorList &colorList);
 void palette_list_add_entry(GtkWidget* widget, ColorObject *color_object, bool allowUpdate);
+void palette_list_add_entries(GtkWidget* widget, const std::vector<ColorObject *> &colorObjects, bool allowUpdate);
 GtkWidget* palette_list_preview_new(GlobalState &gs, bool expander, bool expanded, common::Ref<ColorList> &outColorList);
 void palette_list_remove_all_entries(GtkWidget* widget, bool allowUpdate);
 void palette_list_remove_selected_entries(GtkWidget* widget, bool allowUpdate);
-int palette_list_remove_entry(GtkWidget* widget, ColorObject *color_object, bool allowUpdate);
+void palette_list_remove_entries(GtkWidget* widget, const std::vector<ColorObject *> &colorObjects, bool allowUpdate);
 int palette_list_get_selected_count(GtkWidget* widget);
 int palette_list_get_count(GtkWidget* widget);
 ColorObject *palette_list_get_first_selected(GtkWidget* widget);
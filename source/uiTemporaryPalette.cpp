@@ -99,8 +99,11 @@ struct TemporaryPalette: public IPalette {
 	virtual void add(ColorList &colorList, ColorObject *colorObject) override {
 		palette_list_add_entry(palette, colorObject, !colorList.blocked());
 	}
-	virtual void remove(ColorList &colorList, ColorObject *colorObject) override {
-		palette_list_remove_entry(palette, colorObject, !colorList.blocked());
+	virtual void add(ColorList &colorList, const std::vector<ColorObject *> &colorObjects) override {
+		palette_list_add_entries(palette, colorObjects, !colorList.blocked());
+	}
+	virtual void remove(ColorList &colorList, const std::vector<ColorObject *> &colorObjects) override {
+		palette_list_remove_entries(palette, colorObjects, !colorList.blocked());
 	}
 	virtual void removeSelected(ColorList &colorList) override {
 		palette_list_remove_selected_entries(palette, !colorList.blocked());